@@ -0,0 +1,596 @@
+// Benchmark da biblioteca CLoRa no host (Linux).
+//
+// Mede cada estágio (ppkg, uppkg, fastlz, cifra, codecs de imagem,
+// exportadores do gateway) sobre
+// corpora sintéticos e, opcionalmente, gravados. Imprime uma linha JSON por
+// medida, para acompanhar a evolução entre versões:
+//
+//   {"stage":"ppkg","corpus":"sine","profile":"standard","ops":..,
+//    "ns_per_op":..,"mb_per_s":..,"ratio":..}
+//
+// A última linha ("stage":"memory") traz a RAM estática da biblioteca no
+// perfil e o pico de RSS do processo. mb_per_s é sempre sobre os bytes
+// originais (floats ou pixels), tanto na compressão quanto na
+// descompressão; ratio = bytes originais / bytes codificados.
+//
+// Uso: extras/bench/bench.sh [-m ms] [-t telemetria.csv] [-i imagem.pgm]
+//   -m ms   Tempo mínimo por medida (padrão 200)
+//   -t csv  Telemetria gravada: uma linha por pacote, floats separados por vírgula
+//   -i pgm  Imagem gravada (PGM binário P5, recortada para MAX_IMAGE_SIDE)
+
+#include <stdio.h>
+#include <sys/resource.h>
+#include "cosmic_payload.h"
+#include "cosmic_export.h"
+
+#define BENCH_PACKETS 256                  // Pacotes por corpus de telemetria
+#define BENCH_IMAGES  16                   // Imagens por corpus (variações de ruído)
+
+// Floats por pacote: o máximo que cabe no modo COSMIC do perfil, até 32
+#define BENCH_FLOATS_MAX ((MAX_COSMIC_BUFFER - HEADER_MAX_SIZE) / 2)
+#define BENCH_FLOATS (BENCH_FLOATS_MAX < 32 ? BENCH_FLOATS_MAX : 32)
+
+struct TelemetryCorpus {
+    const char* name;
+    int packets;
+    int n[BENCH_PACKETS];
+    float values[BENCH_PACKETS][BENCH_FLOATS];
+};
+
+struct ImageCorpus {
+    const char* name;
+    int images;
+    uint8_t side;
+    uint8_t pixels[BENCH_IMAGES][MAX_IMAGE_SIZE];
+};
+
+static TelemetryCorpus _telemetry[4];
+static int _telemetry_count = 0;
+static ImageCorpus _images[3];
+static int _image_count = 0;
+
+// Pacotes prontos para os estágios de decodificação
+static uint8_t _packets[BENCH_PACKETS][MAX_COSMIC_BUFFER];
+static uint8_t _packet_sizes[BENCH_PACKETS];
+
+static volatile uint32_t _sink;            // Impede o compilador de descartar resultados
+static unsigned long _min_ms = 200;
+static uint32_t _rng = 0x12345678;
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+static const char* profile_name() {
+#if COSMIC_PROFILE == COSMIC_PROFILE_TINY
+    return "tiny";
+#elif COSMIC_PROFILE == COSMIC_PROFILE_STANDARD
+    return "standard";
+#else
+    return "gateway";
+#endif
+}
+
+static uint32_t rng_next() {
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+}
+
+/**
+ * @brief Uniforme em [-1, 1)
+ */
+static float rng_unit() {
+    return (float)(rng_next() & 0xFFFF) / 32768.0f - 1.0f;
+}
+
+static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/**
+ * @brief Resultado de uma medida: ops e bytes originais/codificados por passada
+ */
+struct Measure {
+    uint64_t ops;
+    uint64_t elapsed_ns;
+    uint64_t raw_bytes;
+    uint64_t coded_bytes;
+};
+
+static void report(const char* stage, const char* corpus, const Measure* m) {
+    double ns = m->ops ? (double)m->elapsed_ns / m->ops : 0.0;
+    double mbs = m->elapsed_ns ? (double)m->raw_bytes * 1000.0 / m->elapsed_ns : 0.0;
+    double ratio = m->coded_bytes ? (double)m->raw_bytes / m->coded_bytes : 0.0;
+    printf("{\"stage\":\"%s\",\"corpus\":\"%s\",\"profile\":\"%s\",\"ops\":%llu,"
+           "\"ns_per_op\":%.1f,\"mb_per_s\":%.2f,\"ratio\":%.3f}\n",
+           stage, corpus, profile_name(), (unsigned long long)m->ops, ns, mbs, ratio);
+}
+
+/**
+ * @brief Repete uma passada sobre o corpus até somar _min_ms
+ *
+ * pass() executa o estágio em todo o corpus e devolve o número de
+ * operações; raw/coded são acumulados só na primeira passada (iguais nas demais).
+ */
+template <typename Pass>
+static Measure run(Pass pass) {
+    Measure m = {0, 0, 0, 0};
+    uint64_t raw = 0, coded = 0;
+    uint64_t passes = 0;
+    uint64_t start = now_ns();
+    uint64_t limit = (uint64_t)_min_ms * 1000000ULL;
+    do {
+        uint64_t r = 0, c = 0;
+        m.ops += pass(&r, &c);
+        if (passes++ == 0) { raw = r; coded = c; }
+        m.elapsed_ns = now_ns() - start;
+    } while (m.elapsed_ns < limit);
+
+    m.raw_bytes = raw * passes;
+    m.coded_bytes = coded * passes;
+    return m;
+}
+
+// =================================================================================
+// CORPORA
+// =================================================================================
+
+static TelemetryCorpus* new_telemetry(const char* name) {
+    TelemetryCorpus* c = &_telemetry[_telemetry_count++];
+    c->name = name;
+    c->packets = BENCH_PACKETS;
+    for (int p = 0; p < BENCH_PACKETS; p++) c->n[p] = BENCH_FLOATS;
+    return c;
+}
+
+static void build_telemetry() {
+    // Senoide lenta (temperatura ao longo do dia)
+    TelemetryCorpus* c = new_telemetry("sine");
+    for (int p = 0; p < BENCH_PACKETS; p++) {
+        for (int i = 0; i < BENCH_FLOATS; i++) {
+            float t = (float)(p * BENCH_FLOATS + i);
+            c->values[p][i] = 22.0f + 6.0f * sinf(t * 6.2831853f / 512.0f);
+        }
+    }
+
+    // Passeio aleatório (pressão, nível de bateria)
+    c = new_telemetry("walk");
+    float v = 1000.0f;
+    for (int p = 0; p < BENCH_PACKETS; p++) {
+        for (int i = 0; i < BENCH_FLOATS; i++) {
+            v += 0.05f * rng_unit();
+            c->values[p][i] = v / 10.0f;
+        }
+    }
+
+    // Sensor ruidoso (acelerômetro, ADC sem filtro): ~gaussiana, desvio ~1.0
+    c = new_telemetry("noisy");
+    for (int p = 0; p < BENCH_PACKETS; p++) {
+        for (int i = 0; i < BENCH_FLOATS; i++) {
+            float g = rng_unit() + rng_unit() + rng_unit();
+            c->values[p][i] = 25.0f + g;
+        }
+    }
+}
+
+/**
+ * @brief Lê telemetria gravada: uma linha por pacote, floats separados por vírgula
+ */
+static int load_telemetry(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+
+    TelemetryCorpus* c = &_telemetry[_telemetry_count];
+    c->name = "recorded";
+    c->packets = 0;
+    char line[4096];
+    while (c->packets < BENCH_PACKETS && fgets(line, sizeof(line), f)) {
+        int n = 0;
+        char* s = line;
+        while (n < BENCH_FLOATS) {
+            char* end;
+            float x = strtof(s, &end);
+            if (end == s) break;
+            c->values[c->packets][n++] = x;
+            s = end;
+            while (*s == ',' || *s == ' ' || *s == '\t') s++;
+        }
+        if (n > 0) c->n[c->packets++] = n;
+    }
+    fclose(f);
+    if (c->packets == 0) return 0;
+    _telemetry_count++;
+    return 1;
+}
+
+static ImageCorpus* new_images(const char* name) {
+    ImageCorpus* c = &_images[_image_count++];
+    c->name = name;
+    c->images = BENCH_IMAGES;
+    c->side = MAX_IMAGE_SIDE;
+    return c;
+}
+
+static void build_images() {
+    // Padrão de teste (cruz da biblioteca), com poucos pixels alterados por imagem
+    ImageCorpus* c = new_images("pattern");
+    for (int k = 0; k < BENCH_IMAGES; k++) {
+        create_test_image(c->side, c->side, c->pixels[k]);
+        c->pixels[k][rng_next() % MAX_IMAGE_SIZE] ^= 0x80;
+    }
+
+    // "Câmera": gradiente suave + mancha clara + ruído de sensor (±4)
+    c = new_images("camera");
+    for (int k = 0; k < BENCH_IMAGES; k++) {
+        int cx = rng_next() % c->side, cy = rng_next() % c->side;
+        for (int y = 0; y < c->side; y++) {
+            for (int x = 0; x < c->side; x++) {
+                int v = 60 + (x + y) * 100 / (2 * c->side);
+                int d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+                if (d2 < c->side * c->side / 16) v += 80;
+                v += (int)(rng_next() % 9) - 4;
+                c->pixels[k][y * c->side + x] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Lê imagem PGM binária (P5, 8 bits), recortada no canto superior esquerdo
+ */
+static int load_image(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+
+    int w, h, maxval;
+    if (fscanf(f, "P5 %d %d %d", &w, &h, &maxval) != 3 || maxval > 255 || w <= 0 || h <= 0) {
+        fclose(f);
+        return 0;
+    }
+    fgetc(f);                              // Separador após o cabeçalho
+
+    ImageCorpus* c = &_images[_image_count];
+    c->name = "recorded";
+    c->images = 1;
+    c->side = (uint8_t)(w < h ? (w < MAX_IMAGE_SIDE ? w : MAX_IMAGE_SIDE)
+                              : (h < MAX_IMAGE_SIDE ? h : MAX_IMAGE_SIDE));
+    for (int y = 0; y < c->side; y++) {
+        for (int x = 0; x < w; x++) {
+            int px = fgetc(f);
+            if (px == EOF) { fclose(f); return 0; }
+            if (x < c->side) c->pixels[0][y * c->side + x] = (uint8_t)px;
+        }
+    }
+    fclose(f);
+    _image_count++;
+    return 1;
+}
+
+// =================================================================================
+// ESTÁGIOS
+// =================================================================================
+
+/**
+ * @brief Quantização + delta em centésimos, como no modo COSMIC (para medir o LZ isolado)
+ */
+static int quantize_packet(const float* v, int n, int16_t* out) {
+    int32_t prev = 0;
+    for (int i = 0; i < n; i++) {
+        int32_t q = (int32_t)lroundf(v[i] * COSMIC_QUANT_SCALE);
+        out[i] = (int16_t)(q - prev);
+        prev = q;
+    }
+    return n * (int)sizeof(int16_t);
+}
+
+static void bench_telemetry(const TelemetryCorpus* c) {
+    uint64_t raw_total = 0;
+    for (int p = 0; p < c->packets; p++) raw_total += c->n[p] * sizeof(float);
+
+    // ppkg (quantização + delta + LZ), sem e com cifra
+    for (int enc = 0; enc < 2; enc++) {
+        if (enc) enableEncryption(); else disableEncryption();
+        Measure m = run([&](uint64_t* raw, uint64_t* coded) {
+            for (int p = 0; p < c->packets; p++) {
+                CosmicPacket pkg = ppkg(true, 1, 7, PKG_TYPE_TELEMETRY, COMPRESS_COSMIC,
+                                        (float*)c->values[p], c->n[p]);
+                *coded += pkg.size;
+                _sink += pkg.size;
+            }
+            *raw = raw_total;
+            return (uint64_t)c->packets;
+        });
+        report(enc ? "ppkg_encrypted" : "ppkg", c->name, &m);
+    }
+    disableEncryption();
+
+    // uppkg sobre os pacotes montados acima
+    uint64_t coded_total = 0;
+    for (int p = 0; p < c->packets; p++) {
+        CosmicPacket pkg = ppkg(true, 1, 7, PKG_TYPE_TELEMETRY, COMPRESS_COSMIC,
+                                (float*)c->values[p], c->n[p]);
+        memcpy(_packets[p], pkg.data, pkg.size);
+        _packet_sizes[p] = pkg.size;
+        coded_total += pkg.size;
+    }
+    Measure m = run([&](uint64_t* raw, uint64_t* coded) {
+        float out[BENCH_FLOATS];
+        for (int p = 0; p < c->packets; p++) {
+            _sink += uppkg(_packets[p], _packet_sizes[p], out, BENCH_FLOATS);
+        }
+        *raw = raw_total;
+        *coded = coded_total;
+        return (uint64_t)c->packets;
+    });
+    report("uppkg", c->name, &m);
+
+    // Exportadores sobre a saída de uppkg (valores já quantizados, como no
+    // gateway); raw = floats, coded = bytes de texto/MessagePack gerados
+    static float decoded[BENCH_PACKETS][BENCH_FLOATS];
+    static const char* formats[] = { "export_json", "export_msgpack", "export_influx" };
+    static uint8_t text[BENCH_PACKETS * (BENCH_FLOATS * 18 + 64)];
+    for (int p = 0; p < c->packets; p++) uppkg(_packets[p], _packet_sizes[p], decoded[p], BENCH_FLOATS);
+    for (int f = 0; f < 3; f++) {
+        m = run([&](uint64_t* raw, uint64_t* coded) {
+            CosmicExportBuffer out;
+            cosmic_export_init(&out, text, sizeof(text));
+            for (int p = 0; p < c->packets; p++) {
+                uint64_t ts = 1700000000000ULL + p * 1000ULL;
+                if (f == 0) _sink += cosmic_export_json(&out, 7, ts, decoded[p], c->n[p]);
+                else if (f == 1) _sink += cosmic_export_msgpack(&out, 7, ts, decoded[p], c->n[p]);
+                else _sink += cosmic_export_influx(&out, 7, ts, decoded[p], c->n[p]);
+            }
+            *raw = raw_total;
+            *coded = out.len;
+            return (uint64_t)c->packets;
+        });
+        report(formats[f], c->name, &m);
+    }
+
+    // fastlz isolado sobre os resíduos int16
+    static int16_t ints[BENCH_PACKETS][BENCH_FLOATS];
+    static uint8_t lz[BENCH_PACKETS][BENCH_FLOATS * 2 + 64];
+    static int lz_sizes[BENCH_PACKETS];
+    int int_sizes[BENCH_PACKETS];
+    uint64_t int_total = 0, lz_total = 0;
+    for (int p = 0; p < c->packets; p++) {
+        int_sizes[p] = quantize_packet(c->values[p], c->n[p], ints[p]);
+        lz_sizes[p] = fastlz_compress(ints[p], int_sizes[p], lz[p]);
+        int_total += int_sizes[p];
+        lz_total += lz_sizes[p];
+    }
+    m = run([&](uint64_t* raw, uint64_t* coded) {
+        uint8_t out[BENCH_FLOATS * 2 + 64];
+        for (int p = 0; p < c->packets; p++) {
+            _sink += fastlz_compress(ints[p], int_sizes[p], out);
+        }
+        *raw = int_total;
+        *coded = lz_total;
+        return (uint64_t)c->packets;
+    });
+    report("fastlz_compress", c->name, &m);
+
+    m = run([&](uint64_t* raw, uint64_t* coded) {
+        uint8_t out[BENCH_FLOATS * 2];
+        for (int p = 0; p < c->packets; p++) {
+            _sink += fastlz_decompress(lz[p], lz_sizes[p], out, sizeof(out));
+        }
+        *raw = int_total;
+        *coded = lz_total;
+        return (uint64_t)c->packets;
+    });
+    report("fastlz_decompress", c->name, &m);
+}
+
+static void bench_cipher() {
+    static const int sizes[] = { 16, 64, MAX_COSMIC_BUFFER < 255 ? MAX_COSMIC_BUFFER : 255 };
+    uint8_t key[16], iv[16], buf[255];
+    for (int i = 0; i < 16; i++) { key[i] = (uint8_t)rng_next(); iv[i] = (uint8_t)rng_next(); }
+    memset(buf, 0x5A, sizeof(buf));
+
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int len = sizes[s];
+        Measure m = run([&](uint64_t* raw, uint64_t* coded) {
+            for (int k = 0; k < 64; k++) {
+                iv[15] = (uint8_t)k;
+                maes_ctr_process(buf, len, iv, key);
+            }
+            _sink += buf[0];
+            *raw = *coded = 64ULL * len;
+            return (uint64_t)64;
+        });
+        char corpus[16];
+        snprintf(corpus, sizeof(corpus), "bytes%d", len);
+        report("maes_ctr_process", corpus, &m);
+    }
+}
+
+/**
+ * @brief BLOCK4 anterior (float por pixel, duas leituras por bloco)
+ *
+ * Referência para o estágio block4_float e para conferir que
+ * _img_compress_block4 gera os mesmos bytes.
+ */
+static uint16_t block4_float(const uint8_t* pixels, uint8_t width, uint8_t height, uint8_t* output) {
+    uint16_t out_idx = 0;
+    for (uint8_t y = 0; y < height; y += 4) {
+        for (uint8_t x = 0; x < width; x += 4) {
+            uint8_t min_val = 255, max_val = 0, count = 0;
+            uint16_t sum = 0;
+            for (uint8_t dy = 0; dy < 4 && y + dy < height; dy++) {
+                for (uint8_t dx = 0; dx < 4 && x + dx < width; dx++) {
+                    uint8_t val = pixels[(y + dy) * width + (x + dx)];
+                    sum += val;
+                    count++;
+                    if (val < min_val) min_val = val;
+                    if (val > max_val) max_val = val;
+                }
+            }
+            uint8_t range = max_val - min_val;
+            if (range <= 32) {
+                output[out_idx++] = count > 0 ? sum / count : 0;
+                output[out_idx++] = range;
+                uint8_t delta_byte = 0, bit_pos = 0;
+                for (uint8_t dy = 0; dy < 4 && y + dy < height; dy++) {
+                    for (uint8_t dx = 0; dx < 4 && x + dx < width; dx++) {
+                        uint8_t val = pixels[(y + dy) * width + (x + dx)];
+                        uint8_t level = range > 0 ? (uint8_t)((float)(val - min_val) / range * 3) : 0;
+                        delta_byte = bit_pos == 0 ? level : delta_byte | level << bit_pos;
+                        bit_pos += 2;
+                        if (bit_pos == 8) {
+                            output[out_idx++] = delta_byte;
+                            bit_pos = 0;
+                        }
+                    }
+                }
+                if (bit_pos != 0) output[out_idx++] = delta_byte;
+            } else {
+                output[out_idx++] = min_val;
+                output[out_idx++] = max_val;
+                output[out_idx++] = pixels[y * width + x];
+                if (x + 3 < width) output[out_idx++] = pixels[y * width + (x + 3)];
+                if (y + 3 < height) output[out_idx++] = pixels[(y + 3) * width + x];
+                if (y + 3 < height && x + 3 < width) output[out_idx++] = pixels[(y + 3) * width + (x + 3)];
+            }
+        }
+    }
+    return out_idx;
+}
+
+static void bench_images(const ImageCorpus* c) {
+    static const struct { const char* name; ImgCompressMode img; uint8_t pkg; } modes[] = {
+        { "rle",    IMG_COMPRESS_RLE,    COMPRESS_IMG_RLE },
+        { "block4", IMG_COMPRESS_BLOCK4, COMPRESS_IMG_BLOCK },
+        { "down2",  IMG_COMPRESS_DOWN2,  COMPRESS_IMG_DOWN2 },
+    };
+    uint16_t size = (uint16_t)c->side * c->side;
+    uint64_t raw_total = (uint64_t)size * c->images;
+
+    for (unsigned k = 0; k < sizeof(modes) / sizeof(modes[0]); k++) {
+        char stage[32];
+
+        Measure m = run([&](uint64_t* raw, uint64_t* coded) {
+            for (int i = 0; i < c->images; i++) {
+                CompressedImage cimg = img_compress(c->pixels[i], c->side, c->side, modes[k].img);
+                *coded += cimg.size;
+                _sink += cimg.size;
+            }
+            *raw = raw_total;
+            return (uint64_t)c->images;
+        });
+        snprintf(stage, sizeof(stage), "img_compress_%s", modes[k].name);
+        report(stage, c->name, &m);
+
+        // Descompressão: uma cópia de cada imagem comprimida
+        static uint8_t packed[BENCH_IMAGES][MAX_IMAGE_SIZE * 2 + 8];
+        static uint16_t packed_sizes[BENCH_IMAGES];
+        uint64_t coded_total = 0;
+        for (int i = 0; i < c->images; i++) {
+            CompressedImage cimg = img_compress(c->pixels[i], c->side, c->side, modes[k].img);
+            memcpy(packed[i], cimg.data, cimg.size);
+            packed_sizes[i] = cimg.size;
+            coded_total += cimg.size;
+        }
+        m = run([&](uint64_t* raw, uint64_t* coded) {
+            uint8_t out[MAX_IMAGE_SIZE];
+            for (int i = 0; i < c->images; i++) {
+                CompressedImage cimg = { packed[i], packed_sizes[i], (uint8_t)modes[k].img, c->side, c->side };
+                _sink += img_decompress(&cimg, out);
+            }
+            *raw = raw_total;
+            *coded = coded_total;
+            return (uint64_t)c->images;
+        });
+        snprintf(stage, sizeof(stage), "img_decompress_%s", modes[k].name);
+        report(stage, c->name, &m);
+
+        m = run([&](uint64_t* raw, uint64_t* coded) {
+            for (int i = 0; i < c->images; i++) {
+                CosmicImagePacket pkg = ppkg_image(1, 7, PKG_TYPE_IMAGE, modes[k].pkg,
+                                                   c->pixels[i], c->side, c->side);
+                *coded += pkg.size;
+                _sink += pkg.size;
+            }
+            *raw = raw_total;
+            return (uint64_t)c->images;
+        });
+        snprintf(stage, sizeof(stage), "ppkg_image_%s", modes[k].name);
+        report(stage, c->name, &m);
+    }
+
+    // BLOCK4 isolado: codificador anterior em float contra o atual (inteiro/SIMD)
+    static uint8_t ref[MAX_IMAGE_SIZE * 2], cur[MAX_IMAGE_SIZE * 2];
+    for (int i = 0; i < c->images; i++) {
+        uint16_t n = block4_float(c->pixels[i], c->side, c->side, ref);
+        if (_img_compress_block4(c->pixels[i], c->side, c->side, cur) != n || memcmp(ref, cur, n) != 0) {
+            fprintf(stderr, "bench: BLOCK4 difere da referência em %s/%d\n", c->name, i);
+            exit(1);
+        }
+    }
+    for (int impl = 0; impl < 2; impl++) {
+        Measure m = run([&](uint64_t* raw, uint64_t* coded) {
+            for (int i = 0; i < c->images; i++) {
+                uint16_t n = impl ? _img_compress_block4(c->pixels[i], c->side, c->side, cur)
+                                  : block4_float(c->pixels[i], c->side, c->side, ref);
+                *coded += n;
+                _sink += n;
+            }
+            *raw = raw_total;
+            return (uint64_t)c->images;
+        });
+        report(impl ? (COSMIC_IMG_SIMD ? "block4_simd" : "block4_int") : "block4_float", c->name, &m);
+    }
+}
+
+static void report_memory() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    printf("{\"stage\":\"memory\",\"profile\":\"%s\",\"static_ram\":%lu,\"max_packet\":%d,"
+           "\"peak_rss_kb\":%ld}\n",
+           profile_name(), (unsigned long)COSMIC_RAM_TOTAL, COSMIC_MAX_PACKET, ru.ru_maxrss);
+}
+
+// =================================================================================
+// MAIN
+// =================================================================================
+
+int main(int argc, char** argv) {
+    const char* telemetry_path = NULL;
+    const char* image_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "m:t:i:")) != -1) {
+        switch (opt) {
+            case 'm': _min_ms = strtoul(optarg, NULL, 10); break;
+            case 't': telemetry_path = optarg; break;
+            case 'i': image_path = optarg; break;
+            default:
+                fprintf(stderr, "uso: %s [-m ms] [-t telemetria.csv] [-i imagem.pgm]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    build_telemetry();
+    build_images();
+    if (telemetry_path && !load_telemetry(telemetry_path)) {
+        fprintf(stderr, "bench: não foi possível ler %s\n", telemetry_path);
+        return 1;
+    }
+    if (image_path && !load_image(image_path)) {
+        fprintf(stderr, "bench: não foi possível ler %s\n", image_path);
+        return 1;
+    }
+
+    uint8_t key[16];
+    for (int i = 0; i < 16; i++) key[i] = (uint8_t)(i * 17 + 3);
+    setCosmicKey(key);
+
+    for (int i = 0; i < _telemetry_count; i++) bench_telemetry(&_telemetry[i]);
+    bench_cipher();
+    for (int i = 0; i < _image_count; i++) bench_images(&_images[i]);
+    report_memory();
+    return 0;
+}
@@ -0,0 +1,21 @@
+#!/bin/sh
+# Benchmark no host (Linux) para os três perfis; uma linha JSON por medida.
+# Uso: extras/bench/bench.sh [-m ms] [-t telemetria.csv] [-i imagem.pgm] > resultado.jsonl
+#      PROFILES="3" CXXFLAGS="-O3 -march=native" extras/bench/bench.sh
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+src="$here/../../src"
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+CFLAGS=${CFLAGS:--O2}
+CXXFLAGS=${CXXFLAGS:--O2}
+
+for profile in ${PROFILES:-1 2 3}; do
+    $CC $CFLAGS -DCOSMIC_PROFILE=$profile -c "$src/fastlz.c" -o "$out/fastlz.o"
+    $CXX $CXXFLAGS -DCOSMIC_PROFILE=$profile -I"$here/../host" -I"$src" \
+        "$here/bench.cpp" "$out/fastlz.o" -lm -o "$out/bench"
+    "$out/bench" "$@"
+done
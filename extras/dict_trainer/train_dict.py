@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""
+Treinador de dicionários LZ (COMPRESS_COSMIC_DICT) e tabelas Huffman
+(COMPRESS_COSMIC_HUFF).
+
+Lê logs de pacotes capturados (já descriptografados), reconstrói o buffer
+int16 quantizado + delta que o ppkg entrega ao LZ e seleciona os trechos
+mais recorrentes para compor um dicionário. Com --huffman, conta os
+resíduos zigzag e gera os comprimentos de código da tabela. A saída é um
+header C pronto para registerCosmicDict() / registerCosmicHuffTable() no
+nó e no gateway.
+
+Formatos de entrada:
+  hex  - um pacote por linha em hexadecimal (espaços ignorados, '#' comenta)
+  lp   - binário: [tamanho uint16 little-endian][pacote] repetido
+
+Uso:
+  train_dict.py --id 1 --size 256 -o cosmic_dict_1.h captura1.txt captura2.txt
+  train_dict.py --huffman --id 1 -o cosmic_huff_1.h captura1.txt
+"""
+
+import argparse
+import heapq
+import struct
+import sys
+from collections import defaultdict
+
+HEADER_SIZE = 4
+PKG_TYPE_TELEMETRY = 0x10
+COMPRESS_NONE = 0x00
+COMPRESS_COSMIC = 0x01
+COMPRESS_COSMIC_RAW16 = 0x08
+COMPRESS_COSMIC_VARINT = 0x09
+
+MIN_SEGMENT = 4
+MAX_SEGMENT = 16
+
+HUFF_SYMBOLS = 16      # COSMIC_HUFF_SYMBOLS
+HUFF_ESCAPE = 15       # COSMIC_HUFF_ESCAPE
+HUFF_MAX_LEN = 12      # COSMIC_HUFF_MAX_LEN
+
+
+def read_packets(path, fmt):
+    if fmt == "hex":
+        with open(path, "r") as f:
+            for line in f:
+                line = line.split("#", 1)[0].strip().replace(" ", "")
+                if line:
+                    yield bytes.fromhex(line)
+    else:
+        with open(path, "rb") as f:
+            data = f.read()
+        pos = 0
+        while pos + 2 <= len(data):
+            (size,) = struct.unpack_from("<H", data, pos)
+            pos += 2
+            yield data[pos:pos + size]
+            pos += size
+
+
+def fastlz_decompress(buf):
+    """Mesmo formato do src/fastlz.c (nível 1, byte de versão inicial)."""
+    if not buf or buf[0] != 0x00:
+        return None
+    out = bytearray()
+    ip = 1
+    while ip < len(buf):
+        ctrl = buf[ip]
+        ip += 1
+        if ctrl < 32:
+            run = ctrl + 1
+            if ip + run > len(buf):
+                return None
+            out += buf[ip:ip + run]
+            ip += run
+            continue
+        length = ctrl >> 5
+        if length == 7:
+            if ip >= len(buf):
+                return None
+            length += buf[ip]
+            ip += 1
+        length += 2
+        if ip >= len(buf):
+            return None
+        ref = len(out) - (((ctrl & 0x1F) << 8) | buf[ip]) - 1
+        ip += 1
+        if ref < 0:
+            return None
+        for i in range(length):
+            out.append(out[ref + i])
+    return bytes(out)
+
+
+def f32(v):
+    return struct.unpack("<f", struct.pack("<f", v))[0]
+
+
+def quantize_delta(floats):
+    """Espelho de _quantize_delta: x100 em precisão simples, truncado para int16, delta."""
+    def q(v):
+        return ((int(f32(v * 100.0)) + 0x8000) & 0xFFFF) - 0x8000
+
+    ints = []
+    for i, v in enumerate(floats):
+        cur = q(v)
+        ints.append(cur if i == 0 else ((cur - q(floats[i - 1]) + 0x8000) & 0xFFFF) - 0x8000)
+    return struct.pack("<%dh" % len(ints), *ints)
+
+
+def varint_deltas(payload):
+    """Varints zigzag do CosmicStreamWriter de volta para int16 delta."""
+    ints, v, shift = [], 0, 0
+    for b in payload:
+        v |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            ints.append(((((v >> 1) ^ -(v & 1)) + 0x8000) & 0xFFFF) - 0x8000)
+            v, shift = 0, 0
+    return struct.pack("<%dh" % len(ints), *ints) if ints else None
+
+
+def parse_header(packet):
+    """(tipo, modo, tamanho do cabeçalho) para cabeçalho legado ou compacto."""
+    if len(packet) < 2:
+        return None
+    b0 = packet[0]
+    if b0 & 0xE0 != 0xE0:
+        return (packet[2], packet[3], HEADER_SIZE) if len(packet) >= HEADER_SIZE else None
+    if b0 & 0x07:
+        return None
+    pos = 2 + (1 if b0 & 0x10 else 0) + (1 if b0 & 0x08 else 0)
+    while pos < len(packet) and packet[pos] & 0x80:
+        pos += 1
+    return packet[1] & 0xF0, packet[1] & 0x0F, pos + 1
+
+
+def lz_input(packet):
+    """Buffer que o LZ veria no nó, ou None se o pacote não é telemetria útil."""
+    hdr = parse_header(packet)
+    if not hdr or hdr[0] != PKG_TYPE_TELEMETRY or len(packet) <= hdr[2]:
+        return None
+    mode, payload = hdr[1], packet[hdr[2]:]
+    if mode == COMPRESS_NONE:
+        n = len(payload) // 4
+        return quantize_delta(struct.unpack_from("<%df" % n, payload)) if n else None
+    if mode == COMPRESS_COSMIC:
+        return fastlz_decompress(payload)
+    if mode == COMPRESS_COSMIC_RAW16:
+        return payload
+    if mode == COMPRESS_COSMIC_VARINT:
+        return varint_deltas(payload)
+    return None
+
+
+def train(samples, dict_size):
+    # Frequência de cada segmento contada uma vez por amostra
+    freq = defaultdict(int)
+    for s in samples:
+        seen = set()
+        for length in range(MIN_SEGMENT, MAX_SEGMENT + 1):
+            for i in range(len(s) - length + 1):
+                seen.add(s[i:i + length])
+        for seg in seen:
+            freq[seg] += 1
+
+    # Pontuação: bytes economizados por ocorrência (cópia LZ custa ~2 bytes)
+    ranked = sorted(((len(seg) - 2) * f, seg) for seg, f in freq.items() if f > 1)
+    ranked.reverse()
+
+    chosen = []
+    total = 0
+    for score, seg in ranked:
+        if total + len(seg) > dict_size:
+            continue
+        if any(seg in c for c in chosen):
+            continue
+        chosen.append(seg)
+        total += len(seg)
+        if total >= dict_size - MIN_SEGMENT:
+            break
+
+    # Melhores segmentos no final: menor distância até os dados
+    chosen.reverse()
+    return b"".join(chosen)
+
+
+def huffman_lengths(freq):
+    """Comprimentos Huffman limitados a HUFF_MAX_LEN (achata contagens até caber)."""
+    freq = [f + 1 for f in freq]
+    while True:
+        heap = [(f, i, [i]) for i, f in enumerate(freq)]
+        heapq.heapify(heap)
+        lengths = [0] * len(freq)
+        tie = len(freq)
+        while len(heap) > 1:
+            f1, _, s1 = heapq.heappop(heap)
+            f2, _, s2 = heapq.heappop(heap)
+            for s in s1 + s2:
+                lengths[s] += 1
+            tie += 1
+            heapq.heappush(heap, (f1 + f2, tie, s1 + s2))
+        if max(lengths) <= HUFF_MAX_LEN:
+            return lengths
+        freq = [f // 2 + 1 for f in freq]
+
+
+def train_huffman(samples):
+    freq = [0] * HUFF_SYMBOLS
+    for s in samples:
+        for (v,) in struct.iter_unpack("<h", s[:len(s) & ~1]):
+            z = (v << 1) ^ (v >> 15)
+            freq[min(z & 0xFFFF, HUFF_ESCAPE)] += 1
+    return huffman_lengths(freq)
+
+
+def write_huff_header(out, table_id, lengths, n_samples):
+    out.write("// Gerado por extras/dict_trainer/train_dict.py --huffman a partir de %d amostras\n" % n_samples)
+    out.write("#ifndef COSMIC_HUFF_%d_H\n#define COSMIC_HUFF_%d_H\n\n" % (table_id, table_id))
+    out.write("#include <stdint.h>\n\n")
+    out.write("#define COSMIC_HUFF_%d_ID %d\n\n" % (table_id, table_id))
+    out.write("static const uint8_t cosmic_huff_%d_lengths[%d] = {\n" % (table_id, HUFF_SYMBOLS))
+    out.write("  " + ", ".join(str(l) for l in lengths) + "\n")
+    out.write("};\n\n#endif // COSMIC_HUFF_%d_H\n" % table_id)
+
+
+def write_header(out, dict_id, data, n_samples):
+    name = "cosmic_dict_%d" % dict_id
+    out.write("// Gerado por extras/dict_trainer/train_dict.py a partir de %d amostras\n" % n_samples)
+    out.write("#ifndef COSMIC_DICT_%d_H\n#define COSMIC_DICT_%d_H\n\n" % (dict_id, dict_id))
+    out.write("#include <stdint.h>\n\n")
+    out.write("#define COSMIC_DICT_%d_ID %d\n\n" % (dict_id, dict_id))
+    out.write("static const uint8_t %s[%d] = {\n" % (name, len(data)))
+    for i in range(0, len(data), 16):
+        out.write("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",\n")
+    out.write("};\n\n#endif // COSMIC_DICT_%d_H\n" % dict_id)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("logs", nargs="+", help="arquivos de captura")
+    ap.add_argument("--format", choices=("hex", "lp"), default="hex")
+    ap.add_argument("--id", type=int, required=True, help="ID do dicionário/tabela (0-255)")
+    ap.add_argument("--huffman", action="store_true", help="gera tabela Huffman em vez de dicionário")
+    ap.add_argument("--size", type=int, default=256, help="tamanho máximo (COSMIC_MAX_DICT_SIZE)")
+    ap.add_argument("-o", "--output", help="header C de saída (padrão: stdout)")
+    args = ap.parse_args()
+
+    samples = []
+    for path in args.logs:
+        for pkt in read_packets(path, args.format):
+            s = lz_input(pkt)
+            if s:
+                samples.append(s)
+
+    if not samples:
+        sys.exit("nenhum pacote de telemetria utilizável nos logs")
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    if args.huffman:
+        lengths = train_huffman(samples)
+        write_huff_header(out, args.id, lengths, len(samples))
+        print("tabela Huffman %d: %s" % (args.id, lengths), file=sys.stderr)
+    else:
+        data = train(samples, args.size)
+        write_header(out, args.id, data, len(samples))
+        print("dicionário %d: %d bytes de %d amostras" % (args.id, len(data), len(samples)), file=sys.stderr)
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,490 @@
+// Daemon de ingestão do gateway: recebe quadros CLoRa de packet forwarders
+// por UDP e emite um registro JSON por leitura decodificada.
+//
+// Thread principal: epoll sobre o socket UDP (não bloqueante), um signalfd
+// (SIGINT/SIGTERM) e um timerfd de estatísticas. A cada evento o socket é
+// drenado com recvmmsg até EAGAIN; cada datagrama GWMP (gwmp.h) é
+// confirmado (PUSH_ACK / PULL_ACK) e seus quadros vão para o
+// CosmicMpmcRing, opcionalmente sem duplicatas (cosmic_relay_accept).
+// Decodificadores reservam lotes do anel, decifram (cosmic_decrypt) e
+// formatam as linhas num buffer próprio, gravado na saída sob um mutex.
+//
+// Linhas de saída (uma por leitura; agregados geram uma por registro):
+//   {"ts":..,"gw":"0016c001ff10a235","net":1,"dev":42,"type":"telemetry","mode":1,
+//    "rssi":-80,"snr":7,"values":[21.5,...]}
+//   {..,"type":"image","w":16,"h":16,"pixels":"<base64>"}
+//   {..,"type":"status","uptime_s":..,"packets_tx":..,...}
+//   {..,"type":"error","size":23}          (-E: quadros que não decodificam)
+// ts = chegada no daemon, em ms desde a época.
+//
+// Uso: cosmic_ingestd [opções]
+//   -p porta Porta UDP (padrão 1700; IPv6 dual-stack)
+//   -w N     Decodificadores (padrão 2)
+//   -e       Quadros cifrados
+//   -k hex   Chave AES de 16 bytes (padrão a chave de teste de loadgen.h)
+//   -n id    Network ID da rede, usado no IV (padrão 1)
+//   -d       Descarta duplicatas (vários gateways ouvindo o mesmo nó)
+//   -E       Emite linhas "error" para quadros inválidos
+//   -o arq   Saída (padrão stdout)
+//   -s s     Intervalo das estatísticas em stderr (padrão 10; 0 = desliga)
+//   -N N     Encerra após N quadros (0 = só por sinal)
+//
+// Compilar: ver extras/gateway/gateway.sh (requer COSMIC_THREAD_LOCAL=thread_local)
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stddef.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include "cosmic_payload.h"
+#include "cosmic_aggregate.h"
+#include "cosmic_relay.h"
+#include "cosmic_ring.h"
+#include "cosmic_status.h"
+#include "loadgen.h"
+#include "gwmp.h"
+
+#define INGEST_MAX_WORKERS 64
+#define INGEST_BATCH       16              // Quadros por reserva no anel
+#define INGEST_UDP_BATCH   32              // Datagramas por recvmmsg
+#define INGEST_OUT_BUFFER  (64 * 1024)     // Buffer de linhas por decodificador
+#define INGEST_LINE_MAX    (256 + 16 * MAX_COSMIC_BUFFER + 4 * (MAX_IMAGE_SIZE + 2) / 3)  // Campos + valores ou base64
+#define INGEST_RING_MASK   (COSMIC_MPMC_SLOTS - 1)
+
+struct Worker {
+    pthread_t thread;
+    uint64_t decoded;
+    uint64_t errors;
+    int len;
+    char out[INGEST_OUT_BUFFER];
+};
+
+// Metadados por posição do anel (escritos pelo leitor antes de publicar)
+struct FrameMeta {
+    uint64_t gw_eui;
+    uint64_t rx_ms;
+    uint32_t counter;
+};
+
+static CosmicMpmcRing _ring;
+static FrameMeta _meta[COSMIC_MPMC_SLOTS];
+static bool _done;
+
+static bool _encrypted;
+static bool _emit_errors;
+static uint8_t _default_net = FLEET_NET_ID;
+static FILE* _out;
+static pthread_mutex_t _out_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Contadores do leitor (só a thread principal escreve)
+static uint64_t _datagrams, _frames, _duplicates, _dropped, _bad_datagrams;
+
+static const char* const STATUS_FIELDS[] = {
+    "packets_tx", "packets_rx", "bytes_in", "bytes_out", "fallbacks", "decode_errors"
+};
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+static uint64_t wall_ms() {
+    struct timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    return (uint64_t)t.tv_sec * 1000ULL + t.tv_nsec / 1000000;
+}
+
+static int parse_key(const char* hex, uint8_t* key) {
+    if (strlen(hex) != 32) return 0;
+    for (int i = 0; i < 16; i++) {
+        unsigned v;
+        if (sscanf(hex + 2 * i, "%2x", &v) != 1) return 0;
+        key[i] = (uint8_t)v;
+    }
+    return 1;
+}
+
+/**
+ * @brief Grava o buffer do decodificador na saída
+ */
+static void flush_lines(Worker* w) {
+    if (w->len == 0) return;
+    pthread_mutex_lock(&_out_lock);
+    fwrite(w->out, 1, w->len, _out);
+    fflush(_out);
+    pthread_mutex_unlock(&_out_lock);
+    w->len = 0;
+}
+
+/**
+ * @brief Abre uma linha com os campos comuns
+ * @return Ponteiro para continuar a linha (garante INGEST_LINE_MAX livres)
+ */
+static char* begin_line(Worker* w, const FrameMeta* m, const CosmicHeader* hdr, uint16_t dev,
+                        const char* type, uint8_t mode, const CosmicFrame* fr) {
+    if (w->len + INGEST_LINE_MAX > INGEST_OUT_BUFFER) flush_lines(w);
+    char* p = w->out + w->len;
+    p += sprintf(p, "{\"ts\":%llu,\"gw\":\"%016llx\",\"net\":%u,\"dev\":%u,\"type\":\"%s\",\"mode\":%u,"
+                    "\"rssi\":%d,\"snr\":%d",
+                 (unsigned long long)m->rx_ms, (unsigned long long)m->gw_eui,
+                 hdr->has_net ? hdr->net_id : _default_net, dev, type, mode, fr->rssi, fr->snr);
+    return p;
+}
+
+static void end_line(Worker* w, char* p) {
+    *p++ = '}';
+    *p++ = '\n';
+    w->len = (int)(p - w->out);
+}
+
+static char* put_values(char* p, const float* v, int n, uint8_t mode) {
+    // Só COMPRESS_NONE leva floats crus; os modos COSMIC quantizam em centésimos
+    const char* fmt = mode == COMPRESS_NONE ? "%.9g" : "%.2f";
+    p += sprintf(p, ",\"values\":[");
+    for (int i = 0; i < n; i++) {
+        if (i) *p++ = ',';
+        p += sprintf(p, fmt, v[i]);
+    }
+    *p++ = ']';
+    return p;
+}
+
+/**
+ * @brief Decifra, decodifica e formata um quadro
+ * @return 1 se decodificado, 0 se inválido
+ */
+static int decode(Worker* w, CosmicFrame* fr, const FrameMeta* m) {
+    // Cabeçalho completo vai cifrado: o net_id do IV vem de -n
+    if (_encrypted && !cosmic_decrypt(fr->data, fr->size, _default_net, m->counter)) return 0;
+    CosmicHeader hdr;
+    if (!cosmic_parse_header(fr->data, fr->size, &hdr)) return 0;
+
+    float values[MAX_COSMIC_BUFFER];
+    switch (hdr.type) {
+        case PKG_TYPE_TELEMETRY: {
+            int n = uppkg(fr->data, fr->size, values, MAX_COSMIC_BUFFER);
+            if (n < 0) return 0;
+            char* p = begin_line(w, m, &hdr, hdr.dev_id, "telemetry", hdr.mode, fr);
+            end_line(w, put_values(p, values, n, hdr.mode));
+            return 1;
+        }
+
+        case PKG_TYPE_IMAGE: {
+            uint8_t pixels[MAX_IMAGE_SIZE];
+            if (!uppkg_image(fr->data, fr->size, pixels, sizeof(pixels))) return 0;
+            uint8_t hlen = cosmic_parse_header(fr->data, fr->size, &hdr);
+            uint8_t width = fr->data[hlen], height = fr->data[hlen + 1];
+            char* p = begin_line(w, m, &hdr, hdr.dev_id, "image", hdr.mode, fr);
+            p += sprintf(p, ",\"w\":%u,\"h\":%u,\"pixels\":\"", width, height);
+            p += gwmp_b64_encode(pixels, width * height, p);
+            *p++ = '"';
+            end_line(w, p);
+            return 1;
+        }
+
+        case PKG_TYPE_STATUS: {
+            CosmicStatusReport r;
+            if (!uppkg_status(fr->data, fr->size, &r)) return 0;
+            const uint32_t counters[] = { r.stats.packets_tx, r.stats.packets_rx, r.stats.bytes_in,
+                                          r.stats.bytes_out, r.stats.fallbacks, r.stats.decode_errors };
+            char* p = begin_line(w, m, &hdr, hdr.dev_id, "status", hdr.mode, fr);
+            p += sprintf(p, ",\"uptime_s\":%lu", (unsigned long)r.uptime_s);
+            for (int i = 0; i < 6; i++) p += sprintf(p, ",\"%s\":%lu", STATUS_FIELDS[i], (unsigned long)counters[i]);
+            end_line(w, p);
+            return 1;
+        }
+
+        case PKG_TYPE_AGGREGATE: {
+            uint8_t scratch[MAX_COSMIC_BUFFER];
+            CosmicAggReader rd;
+            CosmicRecord rec;
+            if (cosmic_agg_open(&rd, fr->data, fr->size, scratch, sizeof(scratch)) < 0) return 0;
+            int r;
+            while ((r = cosmic_agg_next(&rd, &rec)) > 0) {
+                if (rec.type != PKG_TYPE_TELEMETRY) continue;
+                int n = uppkg_payload(rec.mode, rec.payload, rec.size, values, MAX_COSMIC_BUFFER);
+                if (n < 0) return 0;
+                char* p = begin_line(w, m, &hdr, rec.dev_id, "telemetry", rec.mode, fr);
+                end_line(w, put_values(p, values, n, rec.mode));
+            }
+            return r == 0;
+        }
+    }
+    return 0;
+}
+
+static void* worker_main(void* arg) {
+    Worker* w = (Worker*)arg;
+    CosmicFrame frames[INGEST_BATCH];
+    FrameMeta meta[INGEST_BATCH];
+    unsigned idle = 0;
+
+    for (;;) {
+        bool finished = __atomic_load_n(&_done, __ATOMIC_ACQUIRE);
+        uint32_t first;
+        uint32_t n = cosmic_mpmc_claim(&_ring, &first, INGEST_BATCH);
+        if (n == 0) {
+            if (finished) break;
+            flush_lines(w);
+            // Ocioso: cede a CPU e, se continuar vazio, dorme um pouco
+            if (++idle < 64) {
+                sched_yield();
+            } else {
+                struct timespec ts = { 0, 200000 };
+                nanosleep(&ts, NULL);
+            }
+            continue;
+        }
+        idle = 0;
+
+        // Copia o lote e devolve as posições antes de decodificar
+        for (uint32_t i = 0; i < n; i++) {
+            const CosmicFrame* fr = cosmic_mpmc_frame(&_ring, first + i);
+            memcpy(&frames[i], fr, offsetof(CosmicFrame, data) + fr->size);
+            meta[i] = _meta[(first + i) & INGEST_RING_MASK];
+        }
+        cosmic_mpmc_release(&_ring, first, n);
+
+        for (uint32_t i = 0; i < n; i++) {
+            if (decode(w, &frames[i], &meta[i])) {
+                __atomic_fetch_add(&w->decoded, 1, __ATOMIC_RELAXED);
+                continue;
+            }
+            __atomic_fetch_add(&w->errors, 1, __ATOMIC_RELAXED);
+            if (_emit_errors) {
+                CosmicHeader hdr;
+                memset(&hdr, 0, sizeof(hdr));
+                cosmic_parse_header(frames[i].data, frames[i].size, &hdr);
+                char* p = begin_line(w, &meta[i], &hdr, hdr.dev_id, "error", hdr.mode, &frames[i]);
+                p += sprintf(p, ",\"size\":%u", frames[i].size);
+                end_line(w, p);
+            }
+        }
+    }
+    flush_lines(w);
+    return NULL;
+}
+
+/**
+ * @brief Leitor: publica um quadro no anel
+ *
+ * Único produtor: a próxima posição é a cauda atual, e os metadados são
+ * gravados antes de cosmic_mpmc_push publicá-la com release.
+ *
+ * @return 1 se publicado, 0 se o anel está cheio
+ */
+static int ingest(const GwmpFrame* f, uint64_t eui, uint64_t rx_ms) {
+    uint32_t pos = _ring.tail;
+    if (COSMIC_LOAD_ACQUIRE(&_ring.slots[pos & INGEST_RING_MASK].seq) != pos) return 0;
+
+    FrameMeta* m = &_meta[pos & INGEST_RING_MASK];
+    m->gw_eui = eui;
+    m->rx_ms = rx_ms;
+    m->counter = f->counter;
+    return cosmic_mpmc_push(&_ring, f->data, f->size, f->rssi, f->snr);
+}
+
+static int open_socket(unsigned port) {
+    int fd = socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+    int off = 0, rcvbuf = 8 << 20;
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    struct sockaddr_in6 addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons((uint16_t)port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void print_stats(Worker* pool, int workers) {
+    uint64_t decoded = 0, errors = 0;
+    for (int i = 0; i < workers; i++) {
+        decoded += __atomic_load_n(&pool[i].decoded, __ATOMIC_RELAXED);
+        errors += __atomic_load_n(&pool[i].errors, __ATOMIC_RELAXED);
+    }
+    fprintf(stderr, "cosmic_ingestd: datagramas=%llu invalidos=%llu quadros=%llu duplicatas=%llu "
+                    "descartados=%llu decodificados=%llu erros=%llu\n",
+            (unsigned long long)_datagrams, (unsigned long long)_bad_datagrams,
+            (unsigned long long)_frames, (unsigned long long)_duplicates,
+            (unsigned long long)_dropped, (unsigned long long)decoded, (unsigned long long)errors);
+}
+
+/**
+ * @brief Drena o socket: confirma cada datagrama e publica seus quadros
+ * @return Quadros publicados
+ */
+static uint64_t drain(int fd, CosmicDedupCache* cache, bool dedup) {
+    static uint8_t bufs[INGEST_UDP_BATCH][GWMP_MAX_DATAGRAM + 1];
+    static struct sockaddr_in6 peers[INGEST_UDP_BATCH];
+    struct mmsghdr msgs[INGEST_UDP_BATCH];
+    struct iovec iov[INGEST_UDP_BATCH];
+    uint64_t published = 0;
+
+    for (;;) {
+        for (int i = 0; i < INGEST_UDP_BATCH; i++) {
+            iov[i].iov_base = bufs[i];
+            iov[i].iov_len = sizeof(bufs[i]);
+            memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &peers[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+        }
+        int n = recvmmsg(fd, msgs, INGEST_UDP_BATCH, 0, NULL);
+        if (n <= 0) break;                 // EAGAIN: socket vazio
+        uint64_t rx_ms = wall_ms();
+
+        for (int i = 0; i < n; i++) {
+            const uint8_t* d = bufs[i];
+            int len = (int)msgs[i].msg_len;
+            _datagrams++;
+            if (len < 4 || d[0] != GWMP_VERSION) { _bad_datagrams++; continue; }
+
+            // Confirma antes de processar, como o servidor de rede faria
+            uint8_t ack[4] = { GWMP_VERSION, d[1], d[2], 0 };
+            if (d[3] == GWMP_PUSH_DATA || d[3] == GWMP_PUSH_BIN) ack[3] = GWMP_PUSH_ACK;
+            else if (d[3] == GWMP_PULL_DATA) ack[3] = GWMP_PULL_ACK;
+            else { _bad_datagrams++; continue; }
+            sendto(fd, ack, sizeof(ack), MSG_DONTWAIT, (struct sockaddr*)&peers[i], msgs[i].msg_hdr.msg_namelen);
+            if (ack[3] == GWMP_PULL_ACK) continue;
+
+            uint64_t eui;
+            int frames = gwmp_parse(d, len, &eui, [&](const GwmpFrame* f) {
+                if (dedup && !cosmic_relay_accept(cache, f->data, f->size)) { _duplicates++; return; }
+                if (ingest(f, eui, rx_ms)) { _frames++; published++; }
+                else _dropped++;
+            });
+            if (frames < 0) _bad_datagrams++;
+        }
+    }
+    return published;
+}
+
+static int usage(const char* prog) {
+    fprintf(stderr, "uso: %s [-p porta] [-w decodificadores] [-e] [-k chave_hex] [-n net_id] [-c] [-d] [-E] "
+                    "[-o saida.jsonl] [-s intervalo_s] [-N quadros]\n", prog);
+    return 2;
+}
+
+// =================================================================================
+// MAIN
+// =================================================================================
+
+int main(int argc, char** argv) {
+    unsigned port = 1700, stats_s = 10;
+    int workers = 2;
+    bool dedup = false;
+    uint64_t max_frames = 0;
+    const char* out_path = NULL;
+    uint8_t key[16];
+    memcpy(key, FLEET_KEY, sizeof(key));
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:w:ek:n:dEo:s:N:")) != -1) {
+        switch (opt) {
+            case 'p': port = strtoul(optarg, NULL, 10); break;
+            case 'w': workers = (int)strtol(optarg, NULL, 10); break;
+            case 'e': _encrypted = true; break;
+            case 'k': if (!parse_key(optarg, key)) return usage(argv[0]); break;
+            case 'n': _default_net = (uint8_t)strtoul(optarg, NULL, 10); break;
+            case 'd': dedup = true; break;
+            case 'E': _emit_errors = true; break;
+            case 'o': out_path = optarg; break;
+            case 's': stats_s = strtoul(optarg, NULL, 10); break;
+            case 'N': max_frames = strtoull(optarg, NULL, 10); break;
+            default: return usage(argv[0]);
+        }
+    }
+    if (workers < 1 || workers > INGEST_MAX_WORKERS || port == 0 || port > 0xFFFF) return usage(argv[0]);
+
+    _out = out_path ? fopen(out_path, "w") : stdout;
+    if (!_out) { perror(out_path); return 1; }
+
+    setCosmicKey(key);
+    if (_encrypted) enableEncryption(); else disableEncryption();
+    setCosmicMixedHeaders(true);           // Mesmo formato misto da frota (fleet_gen)
+
+    int sock = open_socket(port);
+    if (sock < 0) { perror("cosmic_ingestd: bind"); return 1; }
+
+    // Sinais viram eventos no epoll em vez de interromper recvmmsg
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, NULL);
+    int sig = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    int timer = -1;
+    if (stats_s) {
+        timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        struct itimerspec its = { { (time_t)stats_s, 0 }, { (time_t)stats_s, 0 } };
+        timerfd_settime(timer, 0, &its, NULL);
+    }
+
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    int fds[3] = { sock, sig, timer };
+    for (int i = 0; i < 3; i++) {
+        if (fds[i] < 0) continue;
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fds[i];
+        epoll_ctl(ep, EPOLL_CTL_ADD, fds[i], &ev);
+    }
+
+    // Threads herdam a máscara: só a principal lê o signalfd
+    static Worker pool[INGEST_MAX_WORKERS];
+    static CosmicDedupCache cache;
+    cosmic_dedup_init(&cache, COSMIC_DEDUP_WINDOW_MS);
+    cosmic_mpmc_init(&_ring);
+    for (int i = 0; i < workers; i++) pthread_create(&pool[i].thread, NULL, worker_main, &pool[i]);
+
+    fprintf(stderr, "cosmic_ingestd: porta %u, %d decodificadores%s%s\n", port, workers,
+            _encrypted ? ", cifra" : "", dedup ? ", sem duplicatas" : "");
+
+    bool running = true;
+    while (running) {
+        struct epoll_event events[4];
+        int n = epoll_wait(ep, events, 4, -1);
+        if (n < 0 && errno != EINTR) { perror("cosmic_ingestd: epoll_wait"); break; }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == sock) {
+                drain(sock, &cache, dedup);
+                if (max_frames && _frames >= max_frames) running = false;
+            } else if (fd == timer) {
+                uint64_t expirations;
+                if (read(timer, &expirations, sizeof(expirations)) > 0) print_stats(pool, workers);
+            } else if (fd == sig) {
+                struct signalfd_siginfo si;
+                if (read(sig, &si, sizeof(si)) > 0) running = false;
+            }
+        }
+    }
+
+    // Encerra: decodificadores esvaziam o anel antes de sair
+    __atomic_store_n(&_done, true, __ATOMIC_RELEASE);
+    for (int i = 0; i < workers; i++) pthread_join(pool[i].thread, NULL);
+    print_stats(pool, workers);
+
+    close(ep);
+    close(sock);
+    if (timer >= 0) close(timer);
+    close(sig);
+    if (_out != stdout) fclose(_out);
+    return 0;
+}
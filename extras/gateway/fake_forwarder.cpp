@@ -0,0 +1,167 @@
+// Packet forwarder de teste: reenvia uma captura de fleet_gen para o
+// cosmic_ingestd em envelopes GWMP (gwmp.h), como um ou mais gateways
+// LoRa fariam.
+//
+// Cada datagrama leva até -b quadros (rxpk em JSON ou registros binários).
+// Os gateways simulados (-g) se alternam por datagrama; RSSI e SNR são
+// sintéticos. Um PULL_DATA é enviado por gateway no início e os ACKs
+// recebidos são contados no fim.
+//
+// Uso: fake_forwarder [opções] -i captura.bin -u host:porta
+//   -f fmt   Envelope: json (PUSH_DATA, padrão) ou bin (PUSH_BIN)
+//   -b N     Quadros por datagrama (padrão 8)
+//   -g N     Gateways simulados (padrão 1)
+//   -r pps   Taxa em quadros por segundo (0 = máxima)
+//   -R N     Repete a captura N vezes (padrão 1)
+//
+// Compilar: ver extras/gateway/gateway.sh
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include "cosmic_capture.h"
+#include "gwmp.h"
+
+#define FORWARDER_MAX_BATCH 64
+#define FORWARDER_EUI_BASE  0x0016C001FF100000ULL
+
+static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static void pace(uint64_t start, uint64_t sent, unsigned rate) {
+    if (!rate) return;
+    uint64_t due = start + sent * 1000000000ULL / rate;
+    uint64_t now = now_ns();
+    if (due > now) {
+        struct timespec ts = { (time_t)((due - now) / 1000000000ULL), (long)((due - now) % 1000000000ULL) };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static int open_udp(const char* target, struct sockaddr_storage* addr, socklen_t* addr_len) {
+    char host[256];
+    snprintf(host, sizeof(host), "%s", target);
+    char* port = strrchr(host, ':');
+    if (!port) return -1;
+    *port++ = '\0';
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, port, &hints, &res) != 0) return -1;
+    int fd = socket(res->ai_family, SOCK_DGRAM, 0);
+    memcpy(addr, res->ai_addr, res->ai_addrlen);
+    *addr_len = res->ai_addrlen;
+    freeaddrinfo(res);
+    return fd;
+}
+
+static int usage(const char* prog) {
+    fprintf(stderr, "uso: %s [-f json|bin] [-b quadros] [-g gateways] [-r pps] [-R repetições] "
+                    "-i captura.bin -u host:porta\n", prog);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    const char* target = NULL;
+    bool binary = false;
+    unsigned batch = 8, gateways = 1, rate = 0, repeat = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:u:f:b:g:r:R:")) != -1) {
+        switch (opt) {
+            case 'i': path = optarg; break;
+            case 'u': target = optarg; break;
+            case 'f':
+                if (strcmp(optarg, "bin") == 0) binary = true;
+                else if (strcmp(optarg, "json") != 0) return usage(argv[0]);
+                break;
+            case 'b': batch = strtoul(optarg, NULL, 10); break;
+            case 'g': gateways = strtoul(optarg, NULL, 10); break;
+            case 'r': rate = strtoul(optarg, NULL, 10); break;
+            case 'R': repeat = strtoul(optarg, NULL, 10); break;
+            default: return usage(argv[0]);
+        }
+    }
+    if (!path || !target || batch == 0 || batch > FORWARDER_MAX_BATCH || gateways == 0) return usage(argv[0]);
+
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    int fd = open_udp(target, &addr, &addr_len);
+    if (fd < 0) { fprintf(stderr, "fake_forwarder: destino inválido %s\n", target); return 1; }
+    int bufsize = 4 << 20;                 // ACKs só são lidos no fim
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+
+    // PULL_DATA: anuncia cada gateway ao servidor
+    uint8_t dgram[GWMP_MAX_DATAGRAM];
+    uint16_t token = 0;
+    for (unsigned g = 0; g < gateways; g++) {
+        int len = gwmp_put_header(dgram, token++, GWMP_PULL_DATA, FORWARDER_EUI_BASE + g);
+        sendto(fd, dgram, len, 0, (struct sockaddr*)&addr, addr_len);
+    }
+
+    uint32_t rng = 0x9E3779B9;
+    unsigned long frames = 0, datagrams = 0;
+    uint64_t start = now_ns();
+
+    for (unsigned r = 0; r < repeat; r++) {
+        FILE* f = fopen(path, "rb");
+        if (!f) { perror(path); return 1; }
+
+        CosmicCaptureRecord rec;
+        int rd = 1;
+        while (rd == 1) {
+            uint64_t eui = FORWARDER_EUI_BASE + datagrams % gateways;
+            int pos = gwmp_put_header(dgram, token++, binary ? GWMP_PUSH_BIN : GWMP_PUSH_DATA, eui);
+            unsigned count = 0;
+            while (count < batch && (rd = cosmic_capture_read(f, &rec)) == 1) {
+                rng = rng * 1664525u + 1013904223u;
+                GwmpFrame fr;
+                fr.data = rec.data;
+                fr.size = rec.size;
+                fr.rssi = (int16_t)(-120 + (int)(rng >> 26));        // -120..-57 dBm
+                fr.snr = (int8_t)(-10 + (int)((rng >> 20) & 31));     // -10..21 dB
+                fr.counter = rec.counter;
+                pos = binary ? gwmp_bin_append(dgram, pos, sizeof(dgram), &fr)
+                             : gwmp_json_append(dgram, pos, sizeof(dgram), &fr, count == 0);
+                if (pos < 0) { fprintf(stderr, "fake_forwarder: lote não cabe no datagrama\n"); return 1; }
+                count++;
+            }
+            if (rd < 0) { fprintf(stderr, "fake_forwarder: captura inválida %s\n", path); return 1; }
+            if (count == 0) break;
+            if (!binary) pos = gwmp_json_close(dgram, pos);
+
+            pace(start, frames, rate);
+            sendto(fd, dgram, pos, 0, (struct sockaddr*)&addr, addr_len);
+            frames += count;
+            datagrams++;
+        }
+        fclose(f);
+    }
+    double secs = (now_ns() - start) / 1e9;
+
+    // Conta os ACKs que já chegaram (PUSH_ACK por datagrama, PULL_ACK por gateway)
+    struct timeval tv = { 0, 200000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    unsigned long push_acks = 0, pull_acks = 0;
+    uint8_t ack[16];
+    ssize_t n;
+    while ((n = recv(fd, ack, sizeof(ack), 0)) > 0) {
+        if (n >= 4 && ack[3] == GWMP_PUSH_ACK) push_acks++;
+        else if (n >= 4 && ack[3] == GWMP_PULL_ACK) pull_acks++;
+    }
+    close(fd);
+
+    fprintf(stderr, "fake_forwarder: %lu quadros em %lu datagramas (%s) em %.2f s; "
+                    "PUSH_ACK %lu, PULL_ACK %lu\n",
+            frames, datagrams, binary ? "bin" : "json", secs, push_acks, pull_acks);
+    return 0;
+}
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Compila o daemon de ingestão e o forwarder de teste e faz uma rodada local:
+# fleet_gen gera a captura, cosmic_ingestd escuta e fake_forwarder reenvia.
+# Uso: extras/gateway/gateway.sh [opções do fleet_gen, sem -o/-u]
+#      FORMAT=bin BATCH=16 WORKERS=4 extras/gateway/gateway.sh -d 500 -n 20000 -e -I 5 -S 5
+#      BIN=/tmp/gw extras/gateway/gateway.sh   (mantém os binários em BIN)
+#      RATE=0 extras/gateway/gateway.sh        (taxa máxima: anel cheio descarta quadros)
+# Produção: cosmic_ingestd -p 1700 -w 4 -e -k <chave hex> -d -o leituras.jsonl
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+src="$here/../../src"
+host="$here/../host"
+loadgen="$here/../loadgen"
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+bin=${BIN:-$tmp}
+mkdir -p "$bin"
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+FLAGS="-O2 -DCOSMIC_PROFILE=3 -DCOSMIC_THREAD_LOCAL=thread_local"
+PORT=${PORT:-17000}
+
+$CC $FLAGS -c "$src/fastlz.c" -o "$tmp/fastlz.o"
+$CXX $FLAGS -I"$host" -I"$src" -I"$loadgen" "$loadgen/fleet_gen.cpp" "$tmp/fastlz.o" -lm -o "$bin/fleet_gen"
+$CXX $FLAGS -I"$host" -I"$src" -I"$loadgen" -I"$here" "$here/cosmic_ingestd.cpp" "$tmp/fastlz.o" \
+    -lm -pthread -o "$bin/cosmic_ingestd"
+$CXX -O2 -I"$host" -I"$here" "$here/fake_forwarder.cpp" -o "$bin/fake_forwarder"
+
+# -e precisa valer nos dois lados (o formato do cabeçalho vem do pacote)
+ingest_flags=""
+for arg in "$@"; do
+    case "$arg" in
+        -e) ingest_flags="$ingest_flags $arg" ;;
+    esac
+done
+
+"$bin/fleet_gen" "$@" -o "$tmp/capture.bin"
+
+out=${OUT:-$tmp/readings.jsonl}
+"$bin/cosmic_ingestd" -p "$PORT" -w "${WORKERS:-2}" -s 0 $ingest_flags ${INGEST_OPTS:-} -o "$out" &
+pid=$!
+sleep 0.3
+"$bin/fake_forwarder" -f "${FORMAT:-json}" -b "${BATCH:-8}" -g "${GATEWAYS:-2}" -r "${RATE:-20000}" \
+    -i "$tmp/capture.bin" -u "127.0.0.1:$PORT"
+sleep 0.5
+kill -TERM "$pid"
+wait "$pid"
+echo "gateway.sh: $(wc -l < "$out") linhas" >&2
+head -n 3 "$out"
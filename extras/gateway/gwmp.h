@@ -0,0 +1,270 @@
+// Envelope UDP no estilo do packet forwarder da Semtech (GWMP v2).
+//
+// Datagrama do concentrador para o servidor (PUSH_DATA):
+//   [0] versão (2) | [1-2] token | [3] identificador | [4-11] EUI do gateway | corpo
+//
+// GWMP_PUSH_DATA (0x00): corpo JSON, como no packet forwarder
+//   {"rxpk":[{"tmst":..,"rssi":-80,"lsnr":7.5,"size":23,"data":"<base64>","cnt":41}, ...]}
+//   "cnt" (extensão) é o contador de pacotes do emissor usado no IV; ausente = 0.
+//
+// GWMP_PUSH_BIN (0xC0, extensão): mesmo cabeçalho, corpo binário sem base64
+//   repetido: [tamanho u8][rssi i16 LE][snr i8][contador u32 LE][quadro]
+//
+// O servidor responde PUSH_ACK (0x01) com o mesmo token; PULL_DATA (0x02)
+// recebe PULL_ACK (0x04). Downlink (PULL_RESP) não é tratado aqui.
+
+#ifndef COSMIC_GWMP_H
+#define COSMIC_GWMP_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GWMP_VERSION      2
+#define GWMP_PUSH_DATA    0x00
+#define GWMP_PUSH_ACK     0x01
+#define GWMP_PULL_DATA    0x02
+#define GWMP_PULL_ACK     0x04
+#define GWMP_PUSH_BIN     0xC0
+
+#define GWMP_HEADER_SIZE  12
+#define GWMP_MAX_DATAGRAM 65507
+#define GWMP_BIN_RECORD   8                // Bytes de controle por quadro no corpo binário
+
+/**
+ * @brief Quadro extraído de um envelope
+ */
+struct GwmpFrame {
+    const uint8_t* data;                   // Aponta para o datagrama (binário) ou para scratch (JSON)
+    uint8_t size;
+    int16_t rssi;
+    int8_t snr;
+    uint32_t counter;
+};
+
+// =================================================================================
+// BASE64
+// =================================================================================
+
+static const char _gwmp_b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/**
+ * @brief Codifica em base64 (com '=')
+ * @return Caracteres escritos (sem '\0')
+ */
+static inline int gwmp_b64_encode(const uint8_t* in, int size, char* out) {
+    int o = 0;
+    for (int i = 0; i < size; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < size) v |= (uint32_t)in[i + 1] << 8;
+        if (i + 2 < size) v |= in[i + 2];
+        out[o++] = _gwmp_b64[(v >> 18) & 63];
+        out[o++] = _gwmp_b64[(v >> 12) & 63];
+        out[o++] = i + 1 < size ? _gwmp_b64[(v >> 6) & 63] : '=';
+        out[o++] = i + 2 < size ? _gwmp_b64[v & 63] : '=';
+    }
+    out[o] = '\0';
+    return o;
+}
+
+static inline int _gwmp_b64_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+/**
+ * @brief Decodifica base64 até o primeiro caractere inválido ('"', '=')
+ * @return Bytes escritos, ou -1 se excede max
+ */
+static inline int gwmp_b64_decode(const char* in, const char* end, uint8_t* out, int max) {
+    uint32_t acc = 0;
+    int bits = 0, o = 0;
+    for (; in < end; in++) {
+        int v = _gwmp_b64_value(*in);
+        if (v < 0) break;
+        acc = (acc << 6) | (uint32_t)v;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            if (o >= max) return -1;
+            out[o++] = (uint8_t)(acc >> bits);
+        }
+    }
+    return o;
+}
+
+// =================================================================================
+// MONTAGEM (forwarder)
+// =================================================================================
+
+static inline int gwmp_put_header(uint8_t* out, uint16_t token, uint8_t id, uint64_t eui) {
+    out[0] = GWMP_VERSION;
+    out[1] = (uint8_t)(token >> 8);
+    out[2] = (uint8_t)token;
+    out[3] = id;
+    for (int i = 0; i < 8; i++) out[4 + i] = (uint8_t)(eui >> (56 - 8 * i));
+    return GWMP_HEADER_SIZE;
+}
+
+/**
+ * @brief Acrescenta um quadro ao corpo binário (GWMP_PUSH_BIN)
+ * @return Nova posição, ou -1 se não cabe em max
+ */
+static inline int gwmp_bin_append(uint8_t* out, int pos, int max, const GwmpFrame* f) {
+    if (pos + GWMP_BIN_RECORD + f->size > max) return -1;
+    uint8_t* p = out + pos;
+    p[0] = f->size;
+    p[1] = (uint8_t)f->rssi;
+    p[2] = (uint8_t)((uint16_t)f->rssi >> 8);
+    p[3] = (uint8_t)f->snr;
+    p[4] = (uint8_t)f->counter;
+    p[5] = (uint8_t)(f->counter >> 8);
+    p[6] = (uint8_t)(f->counter >> 16);
+    p[7] = (uint8_t)(f->counter >> 24);
+    memcpy(p + GWMP_BIN_RECORD, f->data, f->size);
+    return pos + GWMP_BIN_RECORD + f->size;
+}
+
+/**
+ * @brief Acrescenta um objeto rxpk ao corpo JSON (chamar gwmp_json_close no fim)
+ * @param first true no primeiro quadro do datagrama
+ * @return Nova posição, ou -1 se não cabe em max
+ */
+static inline int gwmp_json_append(uint8_t* out, int pos, int max, const GwmpFrame* f, bool first) {
+    char b64[4 * ((255 + 2) / 3) + 1];
+    gwmp_b64_encode(f->data, f->size, b64);
+    int n = snprintf((char*)out + pos, max - pos,
+                     "%s{\"rssi\":%d,\"lsnr\":%d,\"size\":%u,\"cnt\":%lu,\"data\":\"%s\"}",
+                     first ? "{\"rxpk\":[" : ",", f->rssi, f->snr, (unsigned)f->size,
+                     (unsigned long)f->counter, b64);
+    if (n < 0 || n >= max - pos - 2) return -1;   // Reserva "]}"
+    return pos + n;
+}
+
+static inline int gwmp_json_close(uint8_t* out, int pos) {
+    out[pos++] = ']';
+    out[pos++] = '}';
+    return pos;
+}
+
+// =================================================================================
+// LEITURA (servidor)
+// =================================================================================
+
+/**
+ * @brief Valor numérico de "key" dentro de [obj, end), ou def se ausente
+ */
+static inline long _gwmp_json_num(const char* obj, const char* end, const char* key, long def) {
+    size_t klen = strlen(key);
+    for (const char* p = obj; p + klen + 3 < end; p++) {
+        if (p[0] != '"' || memcmp(p + 1, key, klen) != 0 || p[klen + 1] != '"') continue;
+        p += klen + 2;
+        while (p < end && (*p == ' ' || *p == ':')) p++;
+        return p < end ? (long)strtod(p, NULL) : def;
+    }
+    return def;
+}
+
+/**
+ * @brief Início da string de "key" dentro de [obj, end), ou NULL
+ */
+static inline const char* _gwmp_json_str(const char* obj, const char* end, const char* key) {
+    size_t klen = strlen(key);
+    for (const char* p = obj; p + klen + 3 < end; p++) {
+        if (p[0] != '"' || memcmp(p + 1, key, klen) != 0 || p[klen + 1] != '"') continue;
+        p += klen + 2;
+        while (p < end && (*p == ' ' || *p == ':')) p++;
+        return p < end && *p == '"' ? p + 1 : NULL;
+    }
+    return NULL;
+}
+
+/**
+ * @brief gwmp_parse - Percorre os quadros de um PUSH_DATA / PUSH_BIN
+ *
+ * Para JSON, cada objeto de "rxpk" é decodificado em scratch e o callback
+ * recebe o quadro antes do próximo; para binário o quadro aponta direto
+ * para o datagrama.
+ *
+ * @param dgram Datagrama recebido
+ * @param size Tamanho
+ * @param eui EUI do gateway (saída)
+ * @param on_frame Chamado para cada quadro válido
+ * @return Quadros entregues, ou -1 se o datagrama não é PUSH_DATA/PUSH_BIN
+ */
+template <typename OnFrame>
+static int gwmp_parse(const uint8_t* dgram, int size, uint64_t* eui, OnFrame on_frame) {
+    if (size < GWMP_HEADER_SIZE || dgram[0] != GWMP_VERSION) return -1;
+    uint8_t id = dgram[3];
+    if (id != GWMP_PUSH_DATA && id != GWMP_PUSH_BIN) return -1;
+
+    *eui = 0;
+    for (int i = 0; i < 8; i++) *eui = (*eui << 8) | dgram[4 + i];
+
+    const uint8_t* p = dgram + GWMP_HEADER_SIZE;
+    const uint8_t* end = dgram + size;
+    int count = 0;
+    GwmpFrame f;
+
+    if (id == GWMP_PUSH_BIN) {
+        while (end - p >= GWMP_BIN_RECORD) {
+            f.size = p[0];
+            f.rssi = (int16_t)(p[1] | (p[2] << 8));
+            f.snr = (int8_t)p[3];
+            f.counter = (uint32_t)p[4] | ((uint32_t)p[5] << 8) | ((uint32_t)p[6] << 16) | ((uint32_t)p[7] << 24);
+            if (f.size == 0 || end - p - GWMP_BIN_RECORD < f.size) break;
+            f.data = p + GWMP_BIN_RECORD;
+            on_frame(&f);
+            count++;
+            p += GWMP_BIN_RECORD + f.size;
+        }
+        return count;
+    }
+
+    // JSON: objetos planos dentro de "rxpk":[...]
+    const char* s = (const char*)p;
+    const char* e = (const char*)end;
+    const char* arr = NULL;
+    for (const char* q = s; q + 6 < e; q++) {
+        if (memcmp(q, "\"rxpk\"", 6) == 0) { arr = q + 6; break; }
+    }
+    if (!arr) return 0;
+
+    uint8_t scratch[255];
+    while (arr < e && *arr != ']') {
+        const char* obj = (const char*)memchr(arr, '{', e - arr);
+        if (!obj) break;
+        // Fim do objeto (pode conter "rsig":[{...}] aninhado)
+        int depth = 0;
+        const char* close = obj;
+        for (; close < e; close++) {
+            if (*close == '{') depth++;
+            else if (*close == '}' && --depth == 0) break;
+        }
+        if (close >= e) break;
+
+        const char* data = _gwmp_json_str(obj, close, "data");
+        if (data) {
+            int n = gwmp_b64_decode(data, close, scratch, sizeof(scratch));
+            if (n > 0) {
+                f.data = scratch;
+                f.size = (uint8_t)n;
+                f.rssi = (int16_t)_gwmp_json_num(obj, close, "rssi", 0);
+                f.snr = (int8_t)_gwmp_json_num(obj, close, "lsnr", 0);
+                f.counter = (uint32_t)_gwmp_json_num(obj, close, "cnt", 0);
+                on_frame(&f);
+                count++;
+            }
+        }
+        arr = close + 1;
+        while (arr < e && (*arr == ',' || *arr == ' ' || *arr == '\n')) arr++;
+    }
+    return count;
+}
+
+#endif // COSMIC_GWMP_H
@@ -0,0 +1,31 @@
+// Shim mínimo de Arduino.h para compilar a biblioteca no Linux (gcc/clang).
+//
+// Cobre só o que src/ usa: tipos e libc que o core do Arduino traz
+// implicitamente, millis() e micros(). Uso: -I extras/host -I src
+// (ver extras/bench/bench.sh).
+
+#ifndef COSMIC_HOST_ARDUINO_H
+#define COSMIC_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+static inline unsigned long _host_now_us() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long)t.tv_sec * 1000000UL + (unsigned long)t.tv_nsec / 1000UL;
+}
+
+static inline unsigned long millis() { return _host_now_us() / 1000UL; }
+static inline unsigned long micros() { return _host_now_us(); }
+static inline void delay(unsigned long ms) { usleep(ms * 1000UL); }
+static inline void delayMicroseconds(unsigned int us) { usleep(us); }
+
+#endif // COSMIC_HOST_ARDUINO_H
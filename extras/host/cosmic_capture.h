@@ -0,0 +1,86 @@
+// Formato de captura de quadros das ferramentas de host (extras/).
+//
+// Arquivo: sequência de registros, todos os inteiros little-endian:
+//   [tamanho u16] [contador u32] [quadro (tamanho - 4 bytes)]
+// UDP: um datagrama por quadro, sem o tamanho:
+//   [contador u32] [quadro]
+//
+// O contador é o _packet_counter usado pelo emissor no IV (não vai no ar);
+// com cifra desabilitada é 0. Quadros chegam como seriam recebidos do rádio.
+
+#ifndef COSMIC_CAPTURE_H
+#define COSMIC_CAPTURE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COSMIC_CAPTURE_MAX_FRAME 255
+#define COSMIC_CAPTURE_PREFIX    4         // Contador antes do quadro
+
+struct CosmicCaptureRecord {
+    uint32_t counter;
+    uint8_t size;
+    uint8_t data[COSMIC_CAPTURE_MAX_FRAME];
+};
+
+static inline void cosmic_capture_put32(uint8_t* out, uint32_t v) {
+    out[0] = (uint8_t)v;
+    out[1] = (uint8_t)(v >> 8);
+    out[2] = (uint8_t)(v >> 16);
+    out[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t cosmic_capture_get32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+/**
+ * @brief Monta o datagrama UDP [contador | quadro]
+ * @return Tamanho do datagrama
+ */
+static inline int cosmic_capture_datagram(uint8_t* out, uint32_t counter, const uint8_t* frame, uint8_t size) {
+    cosmic_capture_put32(out, counter);
+    memcpy(out + COSMIC_CAPTURE_PREFIX, frame, size);
+    return COSMIC_CAPTURE_PREFIX + size;
+}
+
+/**
+ * @brief Lê um datagrama UDP
+ * @return 1 se válido, 0 se curto ou longo demais
+ */
+static inline int cosmic_capture_parse(const uint8_t* in, int size, CosmicCaptureRecord* rec) {
+    if (size <= COSMIC_CAPTURE_PREFIX || size > COSMIC_CAPTURE_PREFIX + COSMIC_CAPTURE_MAX_FRAME) return 0;
+    rec->counter = cosmic_capture_get32(in);
+    rec->size = (uint8_t)(size - COSMIC_CAPTURE_PREFIX);
+    memcpy(rec->data, in + COSMIC_CAPTURE_PREFIX, rec->size);
+    return 1;
+}
+
+/**
+ * @brief Grava um registro no arquivo
+ * @return 1 se gravado, 0 em erro de escrita
+ */
+static inline int cosmic_capture_write(FILE* f, uint32_t counter, const uint8_t* frame, uint8_t size) {
+    uint8_t rec[2 + COSMIC_CAPTURE_PREFIX + COSMIC_CAPTURE_MAX_FRAME];
+    uint16_t len = (uint16_t)(COSMIC_CAPTURE_PREFIX + size);
+    rec[0] = (uint8_t)len;
+    rec[1] = (uint8_t)(len >> 8);
+    cosmic_capture_datagram(rec + 2, counter, frame, size);
+    return fwrite(rec, 1, 2 + len, f) == (size_t)(2 + len);
+}
+
+/**
+ * @brief Lê o próximo registro do arquivo
+ * @return 1 se lido, 0 no fim do arquivo, -1 se o registro é inválido
+ */
+static inline int cosmic_capture_read(FILE* f, CosmicCaptureRecord* rec) {
+    uint8_t buf[2 + COSMIC_CAPTURE_PREFIX + COSMIC_CAPTURE_MAX_FRAME];
+    if (fread(buf, 1, 2, f) != 2) return 0;
+    int len = buf[0] | (buf[1] << 8);
+    if (len <= COSMIC_CAPTURE_PREFIX || len > COSMIC_CAPTURE_PREFIX + COSMIC_CAPTURE_MAX_FRAME) return -1;
+    if (fread(buf + 2, 1, len, f) != (size_t)len) return -1;
+    return cosmic_capture_parse(buf + 2, len, rec) ? 1 : -1;
+}
+
+#endif // COSMIC_CAPTURE_H
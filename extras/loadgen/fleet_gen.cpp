@@ -0,0 +1,276 @@
+// Gerador de tráfego sintético de uma frota de nós CLoRa.
+//
+// Simula milhares de dispositivos, cada um com um modelo de sensor e um
+// número de canais, montando os quadros com ppkg / ppkg_image como o nó
+// faria. Perdas e duplicatas (ex: dois gateways ouvindo o mesmo nó) são
+// aplicadas na saída. Saída em arquivo de captura ou UDP (cosmic_capture.h),
+// consumida por load_harness.
+//
+// Uso: fleet_gen [opções] -o captura.bin | -u host:porta
+//   -d N     Dispositivos (padrão 1000)
+//   -n N     Quadros gerados (padrão 100000)
+//   -s lista Modelos de sensor atribuídos em rodízio: sine,walk,noisy,step (padrão todos)
+//   -I pct   Porcentagem de quadros de imagem (padrão 0)
+//   -S pct   Porcentagem de quadros STATUS (padrão 0)
+//   -e       Cifra habilitada (chave de teste fixa, igual à do load_harness)
+//   -c       Cabeçalho compacto (com net_id)
+//   -l pct   Perda: quadros descartados (padrão 0)
+//   -D pct   Duplicação: quadros repetidos logo em seguida (padrão 0)
+//   -r pps   UDP: taxa de envio em quadros por segundo (0 = máxima)
+//   -x seed  Semente do gerador pseudoaleatório
+//
+// Compilar: ver extras/loadgen/loadgen.sh
+
+#include <stdio.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include "cosmic_payload.h"
+#include "cosmic_status.h"
+#include "cosmic_capture.h"
+#include "loadgen.h"
+
+#define FLEET_MAX_CHANNELS 16
+
+enum SensorModel { SENSOR_SINE, SENSOR_WALK, SENSOR_NOISY, SENSOR_STEP, SENSOR_COUNT };
+static const char* const SENSOR_NAMES[SENSOR_COUNT] = { "sine", "walk", "noisy", "step" };
+
+struct Device {
+    uint16_t id;
+    uint8_t model;
+    uint8_t channels;
+    uint32_t tick;                         // Leituras já feitas
+    float state[FLEET_MAX_CHANNELS];       // Último valor por canal
+};
+
+static Device* _devices;
+static uint32_t _rng = 0x2545F491;
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+static uint32_t rng_next() {
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+}
+
+static float rng_unit() {
+    return (float)(rng_next() & 0xFFFF) / 32768.0f - 1.0f;
+}
+
+static bool rng_percent(unsigned pct) {
+    return pct && rng_next() % 100 < pct;
+}
+
+/**
+ * @brief Próxima leitura de todos os canais do dispositivo
+ */
+static void sample(Device* d, float* out) {
+    d->tick++;
+    for (int c = 0; c < d->channels; c++) {
+        float* v = &d->state[c];
+        switch (d->model) {
+            case SENSOR_SINE:
+                *v = 20.0f + 5.0f * sinf((d->tick + d->id * 7 + c * 13) * 0.05f);
+                break;
+            case SENSOR_WALK:
+                *v += 0.05f * rng_unit();
+                break;
+            case SENSOR_NOISY:
+                *v = 25.0f + rng_unit() + rng_unit() + rng_unit();
+                break;
+            default:                       // Degrau: constante com saltos raros
+                if (rng_next() % 64 == 0) *v = (float)(rng_next() % 100);
+                break;
+        }
+        out[c] = *v;
+    }
+}
+
+/**
+ * @brief Imagem estilo câmera: gradiente, mancha clara e ruído
+ */
+static void camera_image(uint8_t* px, uint8_t side) {
+    int cx = rng_next() % side, cy = rng_next() % side;
+    for (int y = 0; y < side; y++) {
+        for (int x = 0; x < side; x++) {
+            int v = 60 + (x + y) * 100 / (2 * side);
+            if ((x - cx) * (x - cx) + (y - cy) * (y - cy) < side * side / 16) v += 80;
+            v += (int)(rng_next() % 9) - 4;
+            px[y * side + x] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+        }
+    }
+}
+
+static int parse_models(const char* list, uint8_t* models) {
+    int n = 0;
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (char* tok = strtok(buf, ","); tok && n < SENSOR_COUNT; tok = strtok(NULL, ",")) {
+        for (int m = 0; m < SENSOR_COUNT; m++) {
+            if (strcmp(tok, SENSOR_NAMES[m]) == 0) models[n++] = (uint8_t)m;
+        }
+    }
+    return n;
+}
+
+static int open_udp(const char* target, struct sockaddr_storage* addr, socklen_t* addr_len) {
+    char host[256];
+    snprintf(host, sizeof(host), "%s", target);
+    char* port = strrchr(host, ':');
+    if (!port) return -1;
+    *port++ = '\0';
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, port, &hints, &res) != 0) return -1;
+    int fd = socket(res->ai_family, SOCK_DGRAM, 0);
+    memcpy(addr, res->ai_addr, res->ai_addrlen);
+    *addr_len = res->ai_addrlen;
+    freeaddrinfo(res);
+    return fd;
+}
+
+static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static int usage(const char* prog) {
+    fprintf(stderr, "uso: %s [-d dispositivos] [-n quadros] [-s sine,walk,noisy,step] [-I %%img] "
+                    "[-S %%status] [-e] [-c] [-l %%perda] [-D %%dup] [-r pps] [-x semente] "
+                    "-o captura.bin | -u host:porta\n", prog);
+    return 2;
+}
+
+// =================================================================================
+// MAIN
+// =================================================================================
+
+int main(int argc, char** argv) {
+    unsigned devices = 1000, frames = 100000;
+    unsigned image_pct = 0, status_pct = 0, loss_pct = 0, dup_pct = 0, rate = 0;
+    bool encrypt = false, compact = false;
+    const char* out_path = NULL;
+    const char* udp_target = NULL;
+    uint8_t models[SENSOR_COUNT] = { SENSOR_SINE, SENSOR_WALK, SENSOR_NOISY, SENSOR_STEP };
+    int model_count = SENSOR_COUNT;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:n:s:I:S:ecl:D:r:x:o:u:")) != -1) {
+        switch (opt) {
+            case 'd': devices = strtoul(optarg, NULL, 10); break;
+            case 'n': frames = strtoul(optarg, NULL, 10); break;
+            case 's': model_count = parse_models(optarg, models); break;
+            case 'I': image_pct = strtoul(optarg, NULL, 10); break;
+            case 'S': status_pct = strtoul(optarg, NULL, 10); break;
+            case 'e': encrypt = true; break;
+            case 'c': compact = true; break;
+            case 'l': loss_pct = strtoul(optarg, NULL, 10); break;
+            case 'D': dup_pct = strtoul(optarg, NULL, 10); break;
+            case 'r': rate = strtoul(optarg, NULL, 10); break;
+            case 'x': _rng = strtoul(optarg, NULL, 10) | 1; break;
+            case 'o': out_path = optarg; break;
+            case 'u': udp_target = optarg; break;
+            default: return usage(argv[0]);
+        }
+    }
+    if ((!out_path == !udp_target) || devices == 0 || devices > 0xFFFF || model_count == 0) {
+        return usage(argv[0]);
+    }
+
+    FILE* out = NULL;
+    int fd = -1;
+    struct sockaddr_storage addr;
+    socklen_t addr_len = 0;
+    if (out_path) {
+        out = strcmp(out_path, "-") == 0 ? stdout : fopen(out_path, "wb");
+        if (!out) { perror(out_path); return 1; }
+    } else {
+        fd = open_udp(udp_target, &addr, &addr_len);
+        if (fd < 0) { fprintf(stderr, "fleet_gen: destino inválido %s\n", udp_target); return 1; }
+    }
+
+    setCosmicKey(FLEET_KEY);
+    if (encrypt) enableEncryption(); else disableEncryption();
+    setCosmicHeaderFormat(compact, true);
+    setCosmicMixedHeaders(true);           // Nós com e sem -c decodificados pelo mesmo gateway
+
+    _devices = (Device*)calloc(devices, sizeof(Device));
+    for (unsigned i = 0; i < devices; i++) {
+        Device* d = &_devices[i];
+        d->id = (uint16_t)(i + 1);
+        d->model = models[i % model_count];
+        d->channels = (uint8_t)(4 + rng_next() % (FLEET_MAX_CHANNELS - 3));
+        for (int c = 0; c < FLEET_MAX_CHANNELS; c++) d->state[c] = 10.0f + (float)(rng_next() % 2000) / 100.0f;
+    }
+
+    unsigned long written = 0, lost = 0, dups = 0;
+    uint64_t start = now_ns();
+    float values[FLEET_MAX_CHANNELS];
+    uint8_t pixels[MAX_IMAGE_SIZE];
+    uint8_t dgram[COSMIC_CAPTURE_PREFIX + COSMIC_CAPTURE_MAX_FRAME];
+
+    for (unsigned f = 0; f < frames; f++) {
+        Device* d = &_devices[rng_next() % devices];
+        uint32_t counter = encrypt ? _packet_counter : 0;
+        const uint8_t* data;
+        uint8_t size;
+
+        unsigned kind = rng_next() % 100;
+        if (kind < image_pct) {
+            camera_image(pixels, MAX_IMAGE_SIDE);
+            CosmicImagePacket pkg = ppkg_image(FLEET_NET_ID, d->id, PKG_TYPE_IMAGE, COMPRESS_IMG_BLOCK,
+                                               pixels, MAX_IMAGE_SIDE, MAX_IMAGE_SIDE);
+            data = pkg.data;
+            size = pkg.size;
+        } else if (kind < image_pct + status_pct) {
+            CosmicPacket pkg = ppkg_status(FLEET_NET_ID, d->id);
+            data = pkg.data;
+            size = pkg.size;
+        } else {
+            sample(d, values);
+            CosmicPacket pkg = ppkg(true, FLEET_NET_ID, d->id, PKG_TYPE_TELEMETRY, COMPRESS_COSMIC,
+                                    values, d->channels);
+            data = pkg.data;
+            size = pkg.size;
+        }
+        if (size == 0) continue;
+
+        if (rng_percent(loss_pct)) { lost++; continue; }
+        int copies = rng_percent(dup_pct) ? 2 : 1;
+        dups += copies - 1;
+
+        for (int k = 0; k < copies; k++) {
+            if (out) {
+                if (!cosmic_capture_write(out, counter, data, size)) { perror("fleet_gen"); return 1; }
+            } else {
+                int len = cosmic_capture_datagram(dgram, counter, data, size);
+                sendto(fd, dgram, len, 0, (struct sockaddr*)&addr, addr_len);
+                if (rate) {
+                    // Ritmo: espera até o instante do próximo quadro
+                    uint64_t due = start + (uint64_t)(written + 1) * 1000000000ULL / rate;
+                    uint64_t now = now_ns();
+                    if (due > now) {
+                        struct timespec ts = { (time_t)((due - now) / 1000000000ULL),
+                                               (long)((due - now) % 1000000000ULL) };
+                        nanosleep(&ts, NULL);
+                    }
+                }
+            }
+            written++;
+        }
+    }
+
+    if (out && out != stdout) fclose(out);
+    double secs = (now_ns() - start) / 1e9;
+    fprintf(stderr, "fleet_gen: %lu quadros (%lu perdidos, %lu duplicados) de %u dispositivos em %.2f s\n",
+            written, lost, dups, devices, secs);
+    free(_devices);
+    return 0;
+}
@@ -0,0 +1,422 @@
+// Harness de carga do gateway: decodifica quadros de fleet_gen com N threads.
+//
+// Um leitor (thread principal) lê a captura ou o socket UDP, descarta
+// duplicatas (-d) e publica os quadros no CosmicMpmcRing (cosmic_ring.h);
+// os decodificadores reservam lotes, decifram (cosmic_decrypt) e
+// decodificam conforme o tipo (uppkg, uppkg_image, uppkg_status, agregado).
+// Para cada número de decodificadores imprime uma linha JSON:
+//
+//   {"workers":4,"frames":..,"decoded":..,"errors":..,"duplicates":..,
+//    "dropped":..,"seconds":..,"pps":..,"lat_p50_us":..,"lat_p90_us":..,
+//    "lat_p99_us":..,"lat_p999_us":..,"cpu_us_per_frame":..}
+//
+// Latência = chegada no leitor até o fim da decodificação (inclui a fila).
+// CPU por quadro soma todos os threads do processo, inclusive o leitor.
+//
+// Uso: load_harness [opções] -i captura.bin | -p porta
+//   -w lista Números de decodificadores a medir (padrão 1,2,4; UDP usa o primeiro)
+//   -e       Quadros cifrados (chave de teste de loadgen.h)
+//   -d       Descarta duplicatas (cosmic_relay_accept)
+//   -r pps   Captura: ritmo de leitura (0 = o mais rápido possível)
+//   -b N     Quadros por reserva no anel (padrão 16)
+//   -n N     UDP: encerra após N quadros (padrão 1000000)
+//   -T s     UDP: encerra após s segundos sem quadros (padrão 2)
+//
+// Compilar: ver extras/loadgen/loadgen.sh (requer COSMIC_THREAD_LOCAL=thread_local)
+
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "cosmic_payload.h"
+#include "cosmic_aggregate.h"
+#include "cosmic_relay.h"
+#include "cosmic_ring.h"
+#include "cosmic_status.h"
+#include "cosmic_capture.h"
+#include "loadgen.h"
+
+#define HARNESS_MAX_WORKERS 64
+#define HARNESS_MAX_BATCH   64
+#define HARNESS_UDP_BATCH   64
+#define HARNESS_RING_MASK   (COSMIC_MPMC_SLOTS - 1)
+
+struct Worker {
+    pthread_t thread;
+    uint64_t decoded;
+    uint64_t errors;
+};
+
+// Anel e metadados por posição (escritos pelo leitor antes de publicar a posição)
+static CosmicMpmcRing _ring;
+static uint64_t _ingest_ns[COSMIC_MPMC_SLOTS];
+static uint32_t _counters[COSMIC_MPMC_SLOTS];
+
+static uint32_t* _latency_ns;              // Indexado pela sequência do quadro no anel
+static uint32_t _latency_cap;
+static bool _done;
+static bool _encrypted;
+static uint32_t _batch = 16;
+
+static CosmicCaptureRecord* _records;      // Captura inteira em memória
+static uint32_t _record_count;
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static uint64_t cpu_us() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000ULL +
+           ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+/**
+ * @brief Leitor: publica um quadro no anel
+ *
+ * Único produtor, então a posição seguinte é a cauda atual; os metadados
+ * são gravados antes de cosmic_mpmc_push, que os publica com release.
+ *
+ * @return 1 se publicado, 0 se o anel está cheio
+ */
+static int ingest(const CosmicCaptureRecord* rec) {
+    uint32_t pos = _ring.tail;
+    if (COSMIC_LOAD_ACQUIRE(&_ring.slots[pos & HARNESS_RING_MASK].seq) != pos) return 0;
+
+    _ingest_ns[pos & HARNESS_RING_MASK] = now_ns();
+    _counters[pos & HARNESS_RING_MASK] = rec->counter;
+    return cosmic_mpmc_push(&_ring, rec->data, rec->size, 0, 0);
+}
+
+/**
+ * @brief Decifra e decodifica um quadro
+ * @return 1 se decodificado, 0 se inválido
+ */
+static int decode(uint8_t* frame, uint8_t size, uint32_t counter) {
+    if (_encrypted && !cosmic_decrypt(frame, size, FLEET_NET_ID, counter)) return 0;
+
+    CosmicHeader hdr;
+    if (!cosmic_parse_header(frame, size, &hdr)) return 0;
+
+    float values[MAX_COSMIC_BUFFER];
+    switch (hdr.type) {
+        case PKG_TYPE_TELEMETRY:
+            return uppkg(frame, size, values, MAX_COSMIC_BUFFER) >= 0;
+
+        case PKG_TYPE_IMAGE: {
+            uint8_t pixels[MAX_IMAGE_SIZE];
+            return uppkg_image(frame, size, pixels, sizeof(pixels));
+        }
+
+        case PKG_TYPE_STATUS: {
+            CosmicStatusReport report;
+            return uppkg_status(frame, size, &report);
+        }
+
+        case PKG_TYPE_AGGREGATE: {
+            uint8_t scratch[MAX_COSMIC_BUFFER];
+            CosmicAggReader rd;
+            CosmicRecord rec;
+            if (cosmic_agg_open(&rd, frame, size, scratch, sizeof(scratch)) < 0) return 0;
+            int r;
+            while ((r = cosmic_agg_next(&rd, &rec)) > 0) {
+                if (rec.type == PKG_TYPE_TELEMETRY &&
+                    uppkg_payload(rec.mode, rec.payload, rec.size, values, MAX_COSMIC_BUFFER) < 0) return 0;
+            }
+            return r == 0;
+        }
+    }
+    return 0;
+}
+
+static void* worker_main(void* arg) {
+    Worker* w = (Worker*)arg;
+    uint8_t frames[HARNESS_MAX_BATCH][COSMIC_FRAME_SIZE];
+    uint8_t sizes[HARNESS_MAX_BATCH];
+    uint32_t counters[HARNESS_MAX_BATCH];
+    uint64_t arrived[HARNESS_MAX_BATCH];
+
+    for (;;) {
+        bool finished = __atomic_load_n(&_done, __ATOMIC_ACQUIRE);
+        uint32_t first;
+        uint32_t n = cosmic_mpmc_claim(&_ring, &first, _batch);
+        if (n == 0) {
+            if (finished) break;
+            sched_yield();
+            continue;
+        }
+
+        // Copia o lote e devolve as posições antes de decodificar
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t slot = (first + i) & HARNESS_RING_MASK;
+            const CosmicFrame* fr = cosmic_mpmc_frame(&_ring, first + i);
+            memcpy(frames[i], fr->data, fr->size);
+            sizes[i] = fr->size;
+            counters[i] = _counters[slot];
+            arrived[i] = _ingest_ns[slot];
+        }
+        cosmic_mpmc_release(&_ring, first, n);
+
+        for (uint32_t i = 0; i < n; i++) {
+            if (decode(frames[i], sizes[i], counters[i])) w->decoded++;
+            else w->errors++;
+
+            uint64_t lat = now_ns() - arrived[i];
+            if (first + i < _latency_cap) _latency_ns[first + i] = lat > UINT32_MAX ? UINT32_MAX : (uint32_t)lat;
+        }
+    }
+    return NULL;
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile_us(const uint32_t* sorted, uint32_t n, double p) {
+    if (n == 0) return 0.0;
+    uint32_t i = (uint32_t)(p * (n - 1) + 0.5);
+    return sorted[i] / 1000.0;
+}
+
+struct RunStats {
+    uint32_t frames;                       // Publicados no anel
+    uint32_t duplicates;
+    uint32_t dropped;                      // UDP: anel cheio
+    uint64_t elapsed_ns;
+    uint64_t cpu_us;
+};
+
+static void report(int workers, Worker* pool, const RunStats* st) {
+    uint64_t decoded = 0, errors = 0;
+    for (int i = 0; i < workers; i++) {
+        decoded += pool[i].decoded;
+        errors += pool[i].errors;
+    }
+
+    uint32_t n = st->frames < _latency_cap ? st->frames : _latency_cap;
+    qsort(_latency_ns, n, sizeof(uint32_t), cmp_u32);
+    double secs = st->elapsed_ns / 1e9;
+    printf("{\"workers\":%d,\"frames\":%u,\"decoded\":%llu,\"errors\":%llu,\"duplicates\":%u,"
+           "\"dropped\":%u,\"seconds\":%.3f,\"pps\":%.0f,\"lat_p50_us\":%.1f,\"lat_p90_us\":%.1f,"
+           "\"lat_p99_us\":%.1f,\"lat_p999_us\":%.1f,\"cpu_us_per_frame\":%.2f}\n",
+           workers, st->frames, (unsigned long long)decoded, (unsigned long long)errors,
+           st->duplicates, st->dropped, secs, secs > 0 ? decoded / secs : 0.0,
+           percentile_us(_latency_ns, n, 0.50), percentile_us(_latency_ns, n, 0.90),
+           percentile_us(_latency_ns, n, 0.99), percentile_us(_latency_ns, n, 0.999),
+           st->frames ? (double)st->cpu_us / st->frames : 0.0);
+    fflush(stdout);
+}
+
+static void start_workers(Worker* pool, int workers) {
+    cosmic_mpmc_init(&_ring);
+    memset(_latency_ns, 0, (size_t)_latency_cap * sizeof(uint32_t));
+    __atomic_store_n(&_done, false, __ATOMIC_RELEASE);
+    for (int i = 0; i < workers; i++) {
+        pool[i].decoded = pool[i].errors = 0;
+        pthread_create(&pool[i].thread, NULL, worker_main, &pool[i]);
+    }
+}
+
+static void stop_workers(Worker* pool, int workers) {
+    __atomic_store_n(&_done, true, __ATOMIC_RELEASE);
+    for (int i = 0; i < workers; i++) pthread_join(pool[i].thread, NULL);
+}
+
+/**
+ * @brief Uma medida sobre a captura em memória
+ */
+static void run_capture(int workers, bool dedup, unsigned rate) {
+    static Worker pool[HARNESS_MAX_WORKERS];
+    static CosmicDedupCache cache;
+    RunStats st;
+    memset(&st, 0, sizeof(st));
+    cosmic_dedup_init(&cache, COSMIC_DEDUP_WINDOW_MS);
+
+    start_workers(pool, workers);
+    uint64_t cpu0 = cpu_us();
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < _record_count; i++) {
+        const CosmicCaptureRecord* rec = &_records[i];
+        if (rate) {
+            uint64_t due = start + (uint64_t)i * 1000000000ULL / rate;
+            while (now_ns() < due) sched_yield();
+        }
+        if (dedup && !cosmic_relay_accept(&cache, rec->data, rec->size)) {
+            st.duplicates++;
+            continue;
+        }
+        while (!ingest(rec)) sched_yield();
+        st.frames++;
+    }
+    stop_workers(pool, workers);
+    st.elapsed_ns = now_ns() - start;
+    st.cpu_us = cpu_us() - cpu0;
+    report(workers, pool, &st);
+}
+
+/**
+ * @brief Uma medida recebendo datagramas UDP (recvmmsg em lote)
+ */
+static int run_udp(int workers, bool dedup, unsigned port, uint32_t max_frames, unsigned idle_s) {
+    static Worker pool[HARNESS_MAX_WORKERS];
+    static CosmicDedupCache cache;
+    static uint8_t bufs[HARNESS_UDP_BATCH][COSMIC_CAPTURE_PREFIX + COSMIC_CAPTURE_MAX_FRAME + 1];
+    struct mmsghdr msgs[HARNESS_UDP_BATCH];
+    struct iovec iov[HARNESS_UDP_BATCH];
+    RunStats st;
+    memset(&st, 0, sizeof(st));
+    cosmic_dedup_init(&cache, COSMIC_DEDUP_WINDOW_MS);
+
+    int fd = socket(AF_INET6, SOCK_DGRAM, 0);
+    int off = 0, rcvbuf = 8 << 20;
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    struct timeval tv = { 0, 100000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in6 addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons((uint16_t)port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        perror("load_harness: bind");
+        return 1;
+    }
+
+    for (int i = 0; i < HARNESS_UDP_BATCH; i++) {
+        iov[i].iov_base = bufs[i];
+        iov[i].iov_len = sizeof(bufs[i]);
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    fprintf(stderr, "load_harness: aguardando quadros na porta %u\n", port);
+    start_workers(pool, workers);
+    uint64_t cpu0 = 0, start = 0, last = 0;
+    uint32_t received = 0;
+    while (received < max_frames) {
+        int n = recvmmsg(fd, msgs, HARNESS_UDP_BATCH, MSG_WAITFORONE, NULL);
+        uint64_t now = now_ns();
+        if (n <= 0) {
+            if (start && now - last > (uint64_t)idle_s * 1000000000ULL) break;
+            continue;
+        }
+        if (!start) { start = now; cpu0 = cpu_us(); }
+        last = now;
+
+        for (int i = 0; i < n && received < max_frames; i++, received++) {
+            CosmicCaptureRecord rec;
+            if (!cosmic_capture_parse(bufs[i], msgs[i].msg_len, &rec)) continue;
+            if (dedup && !cosmic_relay_accept(&cache, rec.data, rec.size)) { st.duplicates++; continue; }
+            if (ingest(&rec)) st.frames++;
+            else st.dropped++;
+        }
+    }
+    stop_workers(pool, workers);
+    st.elapsed_ns = last - start;
+    st.cpu_us = start ? cpu_us() - cpu0 : 0;
+    close(fd);
+    report(workers, pool, &st);
+    return 0;
+}
+
+static int load_capture(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+
+    uint32_t cap = 1024;
+    _records = (CosmicCaptureRecord*)malloc(cap * sizeof(CosmicCaptureRecord));
+    int r;
+    while ((r = cosmic_capture_read(f, &_records[_record_count])) == 1) {
+        if (++_record_count == cap) {
+            cap *= 2;
+            _records = (CosmicCaptureRecord*)realloc(_records, cap * sizeof(CosmicCaptureRecord));
+        }
+    }
+    fclose(f);
+    return r == 0;
+}
+
+static int usage(const char* prog) {
+    fprintf(stderr, "uso: %s [-w 1,2,4] [-e] [-d] [-r pps] [-b lote] [-n quadros] [-T s] "
+                    "-i captura.bin | -p porta\n", prog);
+    return 2;
+}
+
+// =================================================================================
+// MAIN
+// =================================================================================
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    unsigned port = 0, rate = 0, idle_s = 2;
+    uint32_t max_frames = 1000000;
+    bool dedup = false;
+    int workers[HARNESS_MAX_WORKERS] = { 1, 2, 4 };
+    int worker_runs = 3;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:p:w:edr:b:n:T:")) != -1) {
+        switch (opt) {
+            case 'i': path = optarg; break;
+            case 'p': port = strtoul(optarg, NULL, 10); break;
+            case 'w': {
+                worker_runs = 0;
+                for (char* s = optarg; *s && worker_runs < HARNESS_MAX_WORKERS; ) {
+                    int w = (int)strtol(s, &s, 10);
+                    if (w < 1 || w > HARNESS_MAX_WORKERS) return usage(argv[0]);
+                    workers[worker_runs++] = w;
+                    if (*s == ',') s++;
+                    else if (*s) return usage(argv[0]);
+                }
+                break;
+            }
+            case 'e': _encrypted = true; break;
+            case 'd': dedup = true; break;
+            case 'r': rate = strtoul(optarg, NULL, 10); break;
+            case 'b': _batch = strtoul(optarg, NULL, 10); break;
+            case 'n': max_frames = strtoul(optarg, NULL, 10); break;
+            case 'T': idle_s = strtoul(optarg, NULL, 10); break;
+            default: return usage(argv[0]);
+        }
+    }
+    if (!path == !port || worker_runs == 0 || _batch == 0 || _batch > HARNESS_MAX_BATCH) {
+        return usage(argv[0]);
+    }
+
+    setCosmicKey(FLEET_KEY);
+    if (_encrypted) enableEncryption(); else disableEncryption();
+    setCosmicMixedHeaders(true);           // Mesmo formato misto da frota (fleet_gen)
+
+    if (path) {
+        if (!load_capture(path)) {
+            fprintf(stderr, "load_harness: captura inválida %s\n", path);
+            return 1;
+        }
+        _latency_cap = _record_count;
+    } else {
+        _latency_cap = max_frames;
+    }
+    _latency_ns = (uint32_t*)malloc(((size_t)_latency_cap + 1) * sizeof(uint32_t));
+
+    int rc = 0;
+    if (path) {
+        for (int i = 0; i < worker_runs; i++) run_capture(workers[i], dedup, rate);
+    } else {
+        rc = run_udp(workers[0], dedup, port, max_frames, idle_s);
+    }
+    free(_latency_ns);
+    free(_records);
+    return rc;
+}
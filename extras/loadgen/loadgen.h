@@ -0,0 +1,15 @@
+// Parâmetros compartilhados entre fleet_gen e load_harness.
+
+#ifndef COSMIC_LOADGEN_H
+#define COSMIC_LOADGEN_H
+
+#include <stdint.h>
+
+#define FLEET_NET_ID 1
+
+// Chave de teste fixa: o harness decifra o que o gerador cifrou (-e nos dois)
+static const uint8_t FLEET_KEY[16] = {
+    'C', 'L', 'o', 'R', 'a', '-', 'l', 'o', 'a', 'd', '-', 't', 'e', 's', 't', '!'
+};
+
+#endif // COSMIC_LOADGEN_H
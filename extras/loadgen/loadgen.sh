@@ -0,0 +1,34 @@
+#!/bin/sh
+# Gera uma frota sintética e mede o gateway com 1, 2, 4... decodificadores.
+# Uso: extras/loadgen/loadgen.sh [opções do fleet_gen, sem -o/-u]
+#      WORKERS=1,2,4,8 HARNESS_OPTS="-d" extras/loadgen/loadgen.sh -d 5000 -n 200000 -e -D 5
+#      BIN=/tmp/loadgen extras/loadgen/loadgen.sh   (mantém fleet_gen e load_harness em BIN)
+# Captura/UDP manual: fleet_gen -u 127.0.0.1:1700 ... e load_harness -p 1700 ...
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+src="$here/../../src"
+host="$here/../host"
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+bin=${BIN:-$tmp}
+mkdir -p "$bin"
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+FLAGS="-O2 -DCOSMIC_PROFILE=3 -DCOSMIC_THREAD_LOCAL=thread_local"
+
+$CC $FLAGS -c "$src/fastlz.c" -o "$tmp/fastlz.o"
+for tool in fleet_gen load_harness; do
+    $CXX $FLAGS -I"$host" -I"$src" -I"$here" "$here/$tool.cpp" "$tmp/fastlz.o" -lm -pthread -o "$bin/$tool"
+done
+
+# -e precisa valer nos dois lados (o formato do cabeçalho vem do pacote)
+harness_flags=""
+for arg in "$@"; do
+    case "$arg" in
+        -e) harness_flags="$harness_flags $arg" ;;
+    esac
+done
+
+"$bin/fleet_gen" "$@" -o "$tmp/capture.bin"
+"$bin/load_harness" -w "${WORKERS:-1,2,4}" $harness_flags ${HARNESS_OPTS:-} -i "$tmp/capture.bin"
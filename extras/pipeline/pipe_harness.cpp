@@ -0,0 +1,152 @@
+// Harness da pipeline de montagem/transmissão (cosmic_pipeline.h).
+//
+// O thread principal monta telemetria (ppkg via cosmic_pipe_ppkg) e o
+// thread do "rádio" consome com cosmic_pipe_tx_begin/tx_done, segurando
+// cada pacote por -a us como se estivesse no ar. Os pacotes transmitidos
+// são guardados; ao final o thread principal decifra e decodifica todos e
+// confere a ordem e os valores. Uma linha JSON:
+//
+//   {"packets":..,"depth":..,"sent":..,"callbacks":..,"bad":..,"full":..,
+//    "seconds":..,"pps":..}
+//
+// "full" conta as vezes em que a montagem encontrou a pipeline cheia.
+//
+// Uso: pipe_harness [-n pacotes] [-c canais] [-a airtime_us] [-e]
+//
+// Compilar: ver extras/pipeline/pipeline.sh (build com ThreadSanitizer)
+
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include "cosmic_pipeline.h"
+
+#define HARNESS_NET_ID 7
+#define HARNESS_DEV_ID 42
+
+static const uint8_t _key[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+
+struct Radio {
+    CosmicPipeline* pipe;
+    unsigned long packets;
+    unsigned long airtime_us;
+    uint8_t* air;                          // packets * MAX_COSMIC_BUFFER
+    uint8_t* sizes;
+    unsigned long sent;
+    unsigned long callbacks;
+};
+
+static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static int usage() {
+    fprintf(stderr, "uso: pipe_harness [-n pacotes] [-c canais] [-a airtime_us] [-e]\n");
+    return 2;
+}
+
+static float reading(unsigned long k, int ch) {
+    return (float)((k * 7 + ch * 13) % 1000) * 0.25f - 125.0f;
+}
+
+/**
+ * @brief Fim de transmissão: roda no thread do rádio
+ */
+static void on_done(const CosmicPacket* pkg, int status, void* user) {
+    Radio* r = (Radio*)user;
+    if (status == COSMIC_TX_OK && pkg->size) r->callbacks++;
+}
+
+static void* radio_thread(void* arg) {
+    Radio* r = (Radio*)arg;
+    while (r->sent < r->packets) {
+        const CosmicPacket* pkg = cosmic_pipe_tx_begin(r->pipe);
+        if (!pkg) {
+            sched_yield();
+            continue;
+        }
+        memcpy(r->air + r->sent * MAX_COSMIC_BUFFER, pkg->data, pkg->size);
+        r->sizes[r->sent] = pkg->size;
+        if (r->airtime_us) {
+            uint64_t until = now_ns() + r->airtime_us * 1000ULL;
+            while (now_ns() < until) {}
+        }
+        r->sent++;
+        cosmic_pipe_tx_done(r->pipe, COSMIC_TX_OK);
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    unsigned long packets = 100000, airtime_us = 0;
+    int channels = 8;
+    bool encrypted = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:c:a:e")) != -1) {
+        switch (opt) {
+            case 'n': packets = strtoul(optarg, NULL, 10); break;
+            case 'c': channels = atoi(optarg); break;
+            case 'a': airtime_us = strtoul(optarg, NULL, 10); break;
+            case 'e': encrypted = true; break;
+            default: return usage();
+        }
+    }
+    if (packets == 0 || channels <= 0 || channels > 32) return usage();
+
+    setCosmicKey(_key);
+    if (encrypted) enableEncryption(); else disableEncryption();
+
+    static CosmicPipeline pipe;
+    Radio radio = { &pipe, packets, airtime_us, NULL, NULL, 0, 0 };
+    radio.air = (uint8_t*)malloc(packets * MAX_COSMIC_BUFFER);
+    radio.sizes = (uint8_t*)malloc(packets);
+    if (!radio.air || !radio.sizes) {
+        fprintf(stderr, "pipe_harness: sem memória\n");
+        return 1;
+    }
+    cosmic_pipe_init(&pipe, on_done, &radio);
+
+    uint64_t t = now_ns();
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, radio_thread, &radio) != 0) {
+        perror("pthread_create");
+        return 1;
+    }
+    float values[32];
+    unsigned long full = 0;
+    for (unsigned long k = 0; k < packets; k++) {
+        for (int c = 0; c < channels; c++) values[c] = reading(k, c);
+        while (!cosmic_pipe_ppkg(&pipe, true, HARNESS_NET_ID, HARNESS_DEV_ID, PKG_TYPE_TELEMETRY,
+                                 COMPRESS_COSMIC, values, channels)) {
+            full++;
+            sched_yield();
+        }
+    }
+    pthread_join(tid, NULL);
+    uint64_t ns = now_ns() - t;
+
+    // Conferência no thread de montagem (dono de _c_buffer e da arena)
+    unsigned long bad = 0;
+    float out[32];
+    for (unsigned long k = 0; k < radio.sent; k++) {
+        uint8_t* pkt = radio.air + k * MAX_COSMIC_BUFFER;
+        if (encrypted && !cosmic_decrypt(pkt, radio.sizes[k], HARNESS_NET_ID, (uint32_t)k)) {
+            bad++;
+            continue;
+        }
+        int n = uppkg(pkt, radio.sizes[k], out, channels);
+        bool ok = n == channels;
+        for (int c = 0; ok && c < n; c++) ok = fabsf(out[c] - reading(k, c)) < 0.01f;
+        if (!ok) bad++;
+    }
+
+    printf("{\"packets\":%lu,\"depth\":%d,\"sent\":%lu,\"callbacks\":%lu,\"bad\":%lu,\"full\":%lu,"
+           "\"seconds\":%.3f,\"pps\":%.0f}\n",
+           packets, COSMIC_PIPELINE_DEPTH, radio.sent, radio.callbacks, bad, full, ns / 1e9,
+           ns ? radio.sent * 1e9 / ns : 0.0);
+    free(radio.air);
+    free(radio.sizes);
+    return bad || radio.callbacks != packets ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Compila pipe_harness com ThreadSanitizer e roda a montagem e o rádio em
+# threads separados (buffer duplo e triplo). Qualquer corrida entre
+# cosmic_pipe_submit e cosmic_pipe_tx_done aparece como relatório do TSan.
+# Uso: extras/pipeline/pipeline.sh [opções do pipe_harness]
+#      extras/pipeline/pipeline.sh -n 20000 -a 50 -e
+#      SANITIZE= extras/pipeline/pipeline.sh   (sem TSan, para medir)
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+src="$here/../../src"
+host="$here/../host"
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+bin=${BIN:-$tmp}
+mkdir -p "$bin"
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+SANITIZE=${SANITIZE-"-fsanitize=thread -g"}
+FLAGS="-O1 -DCOSMIC_PROFILE=3 $SANITIZE"
+
+$CC $FLAGS -c "$src/fastlz.c" -o "$tmp/fastlz.o"
+for depth in 2 3; do
+    $CXX $FLAGS -DCOSMIC_PIPELINE_DEPTH=$depth -I"$host" -I"$src" "$here/pipe_harness.cpp" "$tmp/fastlz.o" \
+        -lm -pthread -o "$bin/pipe_harness$depth"
+done
+
+for depth in 2 3; do
+    TSAN_OPTIONS="halt_on_error=1 ${TSAN_OPTIONS:-}" "$bin/pipe_harness$depth" "$@"
+done
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Compila prog_demo (imagens de até 64x64) e envia uma imagem progressiva.
+# Uso: extras/progressive/prog.sh [opções do prog_demo]
+#      extras/progressive/prog.sh -b 3 -q 8 -q 4 -r 32,8,16,10 -m 51 -l 10 -o /tmp/prog
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+src="$here/../../src"
+host="$here/../host"
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+bin=${BIN:-$tmp}
+mkdir -p "$bin"
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+FLAGS="-O2 -DCOSMIC_PROFILE=3 -DMAX_IMAGE_SIDE=64"
+
+$CC $FLAGS -c "$src/fastlz.c" -o "$tmp/fastlz.o"
+$CXX $FLAGS -I"$host" -I"$src" "$here/prog_demo.cpp" "$tmp/fastlz.o" -lm -o "$bin/prog_demo"
+"$bin/prog_demo" "$@"
@@ -0,0 +1,202 @@
+// Demonstração da imagem progressiva (cosmic_progressive.h).
+//
+//   prog_demo [-i imagem.pgm] [-b nível_base] [-q passo]... [-r x,y,w,h] [-m mtu] [-l perda%] [-s semente] [-o dir]
+//
+// Envia a imagem (sintética, ou PGM P5 recortada para MAX_IMAGE_SIDE) como
+// base + refinos + ROI e aplica cada pacote numa reconstrução de gateway.
+// Cada -q acrescenta um refino da imagem inteira, um nível abaixo do
+// anterior (padrão: -q 8 -q 4). Com -l, pacotes são descartados ao acaso.
+//
+// Uma linha JSON por camada: pacotes e bytes acumulados, PSNR da imagem e
+// da ROI no gateway, e quantos pacotes de -m bytes a imagem crua levaria.
+// Com -o, grava dir/layerN.pgm após cada camada.
+//
+// Compilar: ver extras/progressive/prog.sh
+
+#include <math.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "cosmic_progressive.h"
+
+#define DEMO_MAX_REFINES (COSMIC_PROG_MAX_LAYERS - 2)
+
+static uint8_t _image[MAX_IMAGE_SIZE];
+static CosmicProgEncoder _enc;
+static CosmicProgImage _gw;
+
+static int usage() {
+    fprintf(stderr, "uso: prog_demo [-i imagem.pgm] [-b nível] [-q passo]... [-r x,y,w,h] [-m mtu] [-l perda%%] "
+                    "[-s semente] [-o dir]\n");
+    return 2;
+}
+
+/**
+ * @brief Cena sintética: gradiente, discos e uma placa de texto com detalhe fino
+ */
+static void synth_image(uint8_t w, uint8_t h) {
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int v = 60 + (x * 80) / w + (y * 40) / h;
+            int dx = x - w / 3, dy = y - h / 3;
+            if (dx * dx + dy * dy < (w / 5) * (w / 5)) v += 70;
+            dx = x - (3 * w) / 4;
+            dy = y - (2 * h) / 3;
+            if (dx * dx + dy * dy < (w / 8) * (w / 8)) v -= 50;
+            // Placa com listras de 1 pixel (o que a ROI deve preservar)
+            if (x >= w / 2 && x < w / 2 + w / 4 && y >= h / 8 && y < h / 8 + h / 6) v = ((x + y / 2) & 1) ? 230 : 30;
+            v += (rand() % 9) - 4;
+            _image[y * w + x] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+        }
+    }
+}
+
+static bool load_pgm(const char* path, uint8_t* w_out, uint8_t* h_out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    int w, h, maxval;
+    if (fscanf(f, "P5 %d %d %d", &w, &h, &maxval) != 3 || maxval > 255 || w <= 0 || h <= 0) {
+        fclose(f);
+        return false;
+    }
+    fgetc(f);
+    int cw = w < MAX_IMAGE_SIDE ? w : MAX_IMAGE_SIDE, ch = h < MAX_IMAGE_SIDE ? h : MAX_IMAGE_SIDE;
+    for (int y = 0; y < ch; y++) {
+        for (int x = 0; x < w; x++) {
+            int px = fgetc(f);
+            if (px == EOF) { fclose(f); return false; }
+            if (x < cw) _image[y * cw + x] = (uint8_t)px;
+        }
+    }
+    fclose(f);
+    *w_out = (uint8_t)cw;
+    *h_out = (uint8_t)ch;
+    return true;
+}
+
+static void save_pgm(const char* dir, int layer, const uint8_t* pixels, uint8_t w, uint8_t h) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/layer%d.pgm", dir, layer);
+    FILE* f = fopen(path, "wb");
+    if (!f) { perror(path); return; }
+    fprintf(f, "P5 %d %d 255\n", w, h);
+    fwrite(pixels, 1, (size_t)w * h, f);
+    fclose(f);
+}
+
+/**
+ * @brief PSNR (dB) entre a original e a reconstrução num retângulo; 99 se idênticas
+ */
+static double psnr(const uint8_t* a, const uint8_t* b, uint8_t width, int x0, int y0, int w, int h) {
+    double se = 0;
+    for (int y = y0; y < y0 + h; y++) {
+        for (int x = x0; x < x0 + w; x++) {
+            int d = a[y * width + x] - b[y * width + x];
+            se += d * d;
+        }
+    }
+    if (se == 0) return 99.0;
+    return 10.0 * log10(255.0 * 255.0 * w * h / se);
+}
+
+int main(int argc, char** argv) {
+    const char* input = NULL;
+    const char* dir = NULL;
+    int base_level = 3, mtu = 51, loss = 0, nsteps = 0;
+    int steps[DEMO_MAX_REFINES];
+    int roi[4] = { -1, -1, -1, -1 };
+    unsigned seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:b:q:r:m:l:s:o:")) != -1) {
+        switch (opt) {
+            case 'i': input = optarg; break;
+            case 'b': base_level = atoi(optarg); break;
+            case 'q':
+                if (nsteps == DEMO_MAX_REFINES) return usage();
+                steps[nsteps++] = atoi(optarg);
+                break;
+            case 'r':
+                if (sscanf(optarg, "%d,%d,%d,%d", &roi[0], &roi[1], &roi[2], &roi[3]) != 4) return usage();
+                break;
+            case 'm': mtu = atoi(optarg); break;
+            case 'l': loss = atoi(optarg); break;
+            case 's': seed = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'o': dir = optarg; break;
+            default: return usage();
+        }
+    }
+    if (base_level < 0 || base_level > COSMIC_PROG_MAX_LEVEL || mtu <= 0 || mtu > 255) return usage();
+    if (nsteps == 0) {
+        steps[nsteps++] = 8;
+        steps[nsteps++] = 4;
+    }
+    srand(seed);
+
+    uint8_t w = MAX_IMAGE_SIDE, h = MAX_IMAGE_SIDE;
+    if (input) {
+        if (!load_pgm(input, &w, &h)) {
+            fprintf(stderr, "prog_demo: não foi possível ler %s\n", input);
+            return 1;
+        }
+    } else {
+        synth_image(w, h);
+    }
+    if (roi[0] < 0) {
+        // Padrão: a placa da cena sintética
+        roi[0] = w / 2;
+        roi[1] = h / 8;
+        roi[2] = w / 4;
+        roi[3] = h / 6;
+    }
+    if (roi[0] >= w || roi[1] >= h || roi[2] <= 0 || roi[3] <= 0) return usage();
+    if (roi[2] > w - roi[0]) roi[2] = w - roi[0];
+    if (roi[3] > h - roi[1]) roi[3] = h - roi[1];
+
+    cosmic_prog_init(&_enc);
+    cosmic_prog_image_init(&_gw);
+    if (!cosmic_prog_begin(&_enc, _image, w, h, (uint8_t)base_level, (uint8_t)mtu)) {
+        fprintf(stderr, "prog_demo: parâmetros inválidos (mtu mínimo %d)\n", COSMIC_PROG_MIN_MTU);
+        return 1;
+    }
+    int level = base_level;
+    for (int i = 0; i < nsteps && level > 0; i++) {
+        if (steps[i] <= 0 || steps[i] > 255 || !cosmic_prog_add_refine(&_enc, (uint8_t)--level, (uint8_t)steps[i])) {
+            return usage();
+        }
+    }
+    cosmic_prog_add_roi(&_enc, (uint8_t)roi[0], (uint8_t)roi[1], (uint8_t)roi[2], (uint8_t)roi[3]);
+    uint8_t roi_layer = _enc.layers - 1;
+
+    int raw_packets = (w * h + (mtu - HEADER_MAX_SIZE - 3) - 1) / (mtu - HEADER_MAX_SIZE - 3);
+    printf("{\"image\":[%u,%u],\"mtu\":%d,\"raw_bytes\":%d,\"raw_packets\":%d,\"loss\":%d,\"roi\":[%d,%d,%d,%d]}\n",
+           w, h, mtu, w * h, raw_packets, loss, roi[0], roi[1], roi[2], roi[3]);
+
+    static const char* names[] = { "base", "refine", "roi" };
+    int packets = 0, lost = 0, bytes = 0, errors = 0;
+    while (!cosmic_prog_done(&_enc)) {
+        uint8_t layer = _enc.layer;
+        const CosmicProgLayer* l = &_enc.plan[layer];
+        CosmicPacket pkg = ppkg_prog(&_enc, 1, 42);
+        packets++;
+        bytes += pkg.size;
+        if (loss > 0 && rand() % 100 < loss) {
+            lost++;
+        } else {
+            int rc = uppkg_prog(&_gw, pkg.data, pkg.size);
+            if (rc < 0) errors++;
+        }
+        if (_enc.layer == layer) continue;
+
+        const char* kind = l->base ? names[0] : layer == roi_layer ? names[2] : names[1];
+        printf("{\"layer\":%u,\"kind\":\"%s\",\"level\":%u,\"step\":%u,\"packets\":%d,\"lost\":%d,\"bytes\":%d,"
+               "\"psnr\":%.2f,\"roi_psnr\":%.2f,\"encoder_psnr\":%.2f}\n",
+               layer, kind, l->level, l->step, packets, lost, bytes, psnr(_image, _gw.pixels, w, 0, 0, w, h),
+               psnr(_image, _gw.pixels, w, roi[0], roi[1], roi[2], roi[3]), psnr(_image, _enc.canvas, w, 0, 0, w, h));
+        if (dir) save_pgm(dir, layer, _gw.pixels, w, h);
+    }
+    if (errors) {
+        fprintf(stderr, "prog_demo: %d pacotes rejeitados pelo gateway\n", errors);
+        return 1;
+    }
+    return 0;
+}
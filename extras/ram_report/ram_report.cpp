@@ -0,0 +1,30 @@
+// Relatório estático de RAM da biblioteca CLoRa por perfil.
+//
+// Compila a biblioteca no host (shim extras/host) e imprime o tamanho de
+// cada região estática para o perfil selecionado, a partir das mesmas
+// macros COSMIC_RAM_* usadas por COSMIC_RAM_BUDGET e pelo benchmark. Use
+// ram_report.sh para gerar a tabela dos três perfis. Campos com ponteiros
+// usam o layout do host (diferença de poucos bytes em MCUs de 8/32 bits).
+
+#include <stdio.h>
+#include "cosmic_payload.h"
+
+static const char* profile_name() {
+#if COSMIC_PROFILE == COSMIC_PROFILE_TINY
+    return "tiny";
+#elif COSMIC_PROFILE == COSMIC_PROFILE_STANDARD
+    return "standard";
+#else
+    return "gateway";
+#endif
+}
+
+int main() {
+    printf("%-10s telemetry=%-6lu image=%-6lu arena=%-6lu output=%-5lu lz_hash=%-6lu tables=%-5lu crypto=%-4lu total=%lu\n",
+           profile_name(),
+           (unsigned long)COSMIC_RAM_TELEMETRY, (unsigned long)COSMIC_RAM_IMAGE,
+           (unsigned long)COSMIC_RAM_ARENA, (unsigned long)COSMIC_RAM_OUTPUT,
+           (unsigned long)COSMIC_RAM_LZ_HASH, (unsigned long)COSMIC_RAM_TABLES,
+           (unsigned long)COSMIC_RAM_CRYPTO, (unsigned long)COSMIC_RAM_TOTAL);
+    return 0;
+}
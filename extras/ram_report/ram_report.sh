@@ -0,0 +1,15 @@
+#!/bin/sh
+# Tabela de RAM estática por perfil (tiny / standard / gateway).
+# Uso: extras/ram_report/ram_report.sh   (requer g++ no host)
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+src="$here/../../src"
+host="$here/../host"
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+for profile in 1 2 3; do
+    gcc -O0 -DCOSMIC_PROFILE=$profile -c "$src/fastlz.c" -o "$out/fastlz.o"
+    g++ -O0 -Wall -DCOSMIC_PROFILE=$profile -I"$host" -I"$src" "$here/ram_report.cpp" "$out/fastlz.o" -o "$out/ram_report"
+    "$out/ram_report"
+done
@@ -0,0 +1,427 @@
+// Agregados incrementais por janela de tempo (host/gateway).
+//
+// Mantém, por dispositivo e canal, min/max/soma/contagem/último em três
+// resoluções, cada uma num anel de baldes de tamanho fixo:
+//
+//   minuto  COSMIC_ROLLUP_MINUTES baldes (padrão 2 h)
+//   hora    COSMIC_ROLLUP_HOURS   baldes (padrão 2 dias)
+//   dia     COSMIC_ROLLUP_DAYS    baldes (padrão 32 dias)
+//
+// Cada amostra atualiza um balde por nível: O(canais), sem depender do
+// histórico. O balde é identificado pelo número (ts / duração); um
+// balde de outro número no mesmo slot está vencido e é zerado ao ser
+// reaproveitado. Amostras fora de ordem entram enquanto o balde ainda
+// está no anel; mais antigas que isso só contam nos níveis que ainda as
+// retêm.
+//
+// Memória por dispositivo (padrões): ~2,4 KiB + 4,7 KiB por canal.
+//
+// Um resumo de [t0, t1] é montado com o menor número de baldes: dias
+// inteiros no meio, horas inteiras e minutos nas bordas (no máximo
+// ~2 x 60 + 2 x 24 + dias). Onde os minutos já saíram do anel, entra a
+// hora (ou o dia) que os contém; o intervalo efetivamente coberto volta
+// em from/to. A granularidade mínima é o minuto.
+//
+// Um CosmicRollup é de um único thread.
+
+#ifndef COSMIC_ROLLUP_H
+#define COSMIC_ROLLUP_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "cosmic_export.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+
+#ifndef COSMIC_ROLLUP_MINUTES
+#define COSMIC_ROLLUP_MINUTES 120              // Baldes de 1 min
+#endif
+
+#ifndef COSMIC_ROLLUP_HOURS
+#define COSMIC_ROLLUP_HOURS 48                 // Baldes de 1 h
+#endif
+
+#ifndef COSMIC_ROLLUP_DAYS
+#define COSMIC_ROLLUP_DAYS 32                  // Baldes de 1 dia
+#endif
+
+#ifndef COSMIC_ROLLUP_MAX_CHANNELS
+#define COSMIC_ROLLUP_MAX_CHANNELS 64
+#endif
+
+#define COSMIC_ROLLUP_MAX_DEVICES 65536
+#define COSMIC_ROLLUP_LEVELS      3
+#define COSMIC_ROLLUP_SLOTS       (COSMIC_ROLLUP_MINUTES + COSMIC_ROLLUP_HOURS + COSMIC_ROLLUP_DAYS)
+
+#define COSMIC_ROLLUP_MINUTE      0
+#define COSMIC_ROLLUP_HOUR        1
+#define COSMIC_ROLLUP_DAY         2
+
+// Códigos de retorno
+#define COSMIC_ROLLUP_OK          0
+#define COSMIC_ROLLUP_ERR_ARG     -1
+#define COSMIC_ROLLUP_ERR_MEM     -2
+#define COSMIC_ROLLUP_ERR_EMPTY   -3           // Dispositivo sem amostras
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+/**
+ * @brief Agregado de um canal (num balde ou num resumo); média = sum / count
+ */
+struct CosmicRollupCell {
+    float min;
+    float max;
+    float last;                            // Valor de maior timestamp
+    uint32_t count;                        // Valores finitos agregados
+    double sum;
+};
+
+/**
+ * @brief Anéis de um dispositivo
+ */
+struct CosmicRollupSeries {
+    uint16_t dev_id;
+    uint16_t channels;
+    uint32_t newest[COSMIC_ROLLUP_LEVELS];     // Maior número de balde visto por nível
+    uint64_t first_ts;                         // Menor timestamp visto
+    uint32_t bucket[COSMIC_ROLLUP_SLOTS];      // Número do balde em cada slot
+    uint64_t last_ts[COSMIC_ROLLUP_SLOTS];     // Timestamp do último valor do slot
+    uint32_t samples[COSMIC_ROLLUP_SLOTS];     // Amostras do slot, com ou sem valores finitos
+    CosmicRollupCell* cells;                   // [COSMIC_ROLLUP_SLOTS][channels]
+};
+
+struct CosmicRollup {
+    CosmicRollupSeries** series;           // Indexado por dev_id, criado sob demanda
+    uint32_t devices;
+    uint64_t samples;
+    uint64_t bytes;                        // Memória dos anéis
+};
+
+/**
+ * @brief Resumo de um dispositivo numa janela (cosmic_rollup_summary)
+ */
+struct CosmicRollupSummary {
+    uint16_t dev_id;
+    uint16_t channels;
+    uint64_t from;                         // Intervalo coberto [from, to) em ms
+    uint64_t to;
+    uint32_t samples;
+    uint16_t buckets[COSMIC_ROLLUP_LEVELS];    // Baldes usados por nível
+    CosmicRollupCell stats[COSMIC_ROLLUP_MAX_CHANNELS];
+};
+
+/**
+ * @brief Recebe cada balde de cosmic_rollup_buckets
+ */
+typedef void (*CosmicRollupVisitor)(void* user, uint16_t dev_id, uint64_t start_ms,
+                                    const CosmicRollupCell* cells, int channels);
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+static const uint64_t _rollup_span[COSMIC_ROLLUP_LEVELS] = { 60000ULL, 3600000ULL, 86400000ULL };
+static const uint32_t _rollup_size[COSMIC_ROLLUP_LEVELS] = {
+    COSMIC_ROLLUP_MINUTES, COSMIC_ROLLUP_HOURS, COSMIC_ROLLUP_DAYS
+};
+static const uint32_t _rollup_base[COSMIC_ROLLUP_LEVELS] = {
+    0, COSMIC_ROLLUP_MINUTES, COSMIC_ROLLUP_MINUTES + COSMIC_ROLLUP_HOURS
+};
+
+static inline uint32_t _rollup_slot(int level, uint32_t bucket) {
+    return _rollup_base[level] + bucket % _rollup_size[level];
+}
+
+/**
+ * @brief O balde ainda pode estar no anel (vazio ou não)?
+ */
+static inline bool _rollup_retained(const CosmicRollupSeries* s, int level, uint32_t bucket) {
+    return (uint64_t)bucket + _rollup_size[level] > s->newest[level];
+}
+
+static inline void _rollup_cell_reset(CosmicRollupCell* c) {
+    c->min = 0.0f;
+    c->max = 0.0f;
+    c->last = 0.0f;
+    c->count = 0;
+    c->sum = 0.0;
+}
+
+/**
+ * @brief Acumula b em a; b é mais recente que tudo que já está em a
+ */
+static inline void _rollup_cell_merge(CosmicRollupCell* a, const CosmicRollupCell* b) {
+    if (!b->count) return;
+    if (!a->count || b->min < a->min) a->min = b->min;
+    if (!a->count || b->max > a->max) a->max = b->max;
+    a->last = b->last;
+    a->count += b->count;
+    a->sum += b->sum;
+}
+
+static CosmicRollupSeries* _rollup_series(CosmicRollup* r, uint16_t dev_id) {
+    CosmicRollupSeries* s = r->series[dev_id];
+    if (s) return s;
+    s = (CosmicRollupSeries*)calloc(1, sizeof(CosmicRollupSeries));
+    if (!s) return NULL;
+    s->dev_id = dev_id;
+    memset(s->newest, 0xFF, sizeof(s->newest));   // UINT32_MAX: nível ainda sem amostras
+    memset(s->bucket, 0xFF, sizeof(s->bucket));   // Nenhum slot casa com um balde real
+    r->series[dev_id] = s;
+    r->devices++;
+    r->bytes += sizeof(CosmicRollupSeries);
+    return s;
+}
+
+/**
+ * @brief Aumenta os canais de uma série, mantendo os agregados existentes
+ */
+static bool _rollup_grow(CosmicRollup* r, CosmicRollupSeries* s, int channels) {
+    CosmicRollupCell* cells = (CosmicRollupCell*)calloc((size_t)COSMIC_ROLLUP_SLOTS * channels,
+                                                        sizeof(CosmicRollupCell));
+    if (!cells) return false;
+    for (uint32_t i = 0; s->cells && i < COSMIC_ROLLUP_SLOTS; i++) {
+        memcpy(cells + i * channels, s->cells + i * s->channels, s->channels * sizeof(CosmicRollupCell));
+    }
+    free(s->cells);
+    r->bytes += (uint64_t)COSMIC_ROLLUP_SLOTS * (channels - s->channels) * sizeof(CosmicRollupCell);
+    s->cells = cells;
+    s->channels = (uint16_t)channels;
+    return true;
+}
+
+static void _rollup_add(CosmicRollupSeries* s, int level, uint64_t ts_ms, const float* values, int n) {
+    uint32_t bucket = (uint32_t)(ts_ms / _rollup_span[level]);
+    if (s->newest[level] != UINT32_MAX && !_rollup_retained(s, level, bucket)) return;   // Já saiu do anel
+
+    uint32_t slot = _rollup_slot(level, bucket);
+    CosmicRollupCell* cells = s->cells + slot * s->channels;
+    if (s->bucket[slot] != bucket) {
+        s->bucket[slot] = bucket;
+        s->last_ts[slot] = ts_ms;
+        s->samples[slot] = 0;
+        for (int c = 0; c < s->channels; c++) _rollup_cell_reset(&cells[c]);
+    }
+    bool newer = ts_ms >= s->last_ts[slot];
+    for (int c = 0; c < n; c++) {
+        float v = values[c];
+        if (!_cosmic_finite(v)) continue;
+        CosmicRollupCell* cell = &cells[c];
+        if (!cell->count || v < cell->min) cell->min = v;
+        if (!cell->count || v > cell->max) cell->max = v;
+        if (!cell->count || newer) cell->last = v;
+        cell->count++;
+        cell->sum += v;
+    }
+    s->samples[slot]++;
+    if (newer) s->last_ts[slot] = ts_ms;
+    if (s->newest[level] == UINT32_MAX || bucket > s->newest[level]) s->newest[level] = bucket;
+}
+
+/**
+ * @brief Soma um balde ao resumo, se ele tem dados
+ */
+static void _rollup_take(const CosmicRollupSeries* s, int level, uint32_t bucket, CosmicRollupSummary* out) {
+    uint32_t slot = _rollup_slot(level, bucket);
+    out->buckets[level]++;
+    if (s->bucket[slot] != bucket) return;
+    const CosmicRollupCell* cells = s->cells + slot * s->channels;
+    for (int c = 0; c < s->channels; c++) _rollup_cell_merge(&out->stats[c], &cells[c]);
+    out->samples += s->samples[slot];
+}
+
+// =================================================================================
+// API PÚBLICA - AGREGADOS
+// =================================================================================
+
+/**
+ * @brief cosmic_rollup_init - Prepara um conjunto vazio de agregados
+ * @return COSMIC_ROLLUP_OK ou COSMIC_ROLLUP_ERR_MEM
+ */
+int cosmic_rollup_init(CosmicRollup* r) {
+    memset(r, 0, sizeof(*r));
+    r->series = (CosmicRollupSeries**)calloc(COSMIC_ROLLUP_MAX_DEVICES, sizeof(CosmicRollupSeries*));
+    if (!r->series) return COSMIC_ROLLUP_ERR_MEM;
+    r->bytes = COSMIC_ROLLUP_MAX_DEVICES * sizeof(CosmicRollupSeries*);
+    return COSMIC_ROLLUP_OK;
+}
+
+/**
+ * @brief cosmic_rollup_free - Libera todos os anéis
+ */
+void cosmic_rollup_free(CosmicRollup* r) {
+    for (uint32_t d = 0; r->series && d < COSMIC_ROLLUP_MAX_DEVICES; d++) {
+        if (!r->series[d]) continue;
+        free(r->series[d]->cells);
+        free(r->series[d]);
+    }
+    free(r->series);
+    memset(r, 0, sizeof(*r));
+}
+
+/**
+ * @brief cosmic_rollup_add - Agrega uma amostra (todos os canais) de um dispositivo
+ *
+ * Valores não finitos são ignorados. Canais além de
+ * COSMIC_ROLLUP_MAX_CHANNELS são descartados.
+ *
+ * @param r Agregados
+ * @param dev_id Dispositivo
+ * @param ts_ms Timestamp em ms
+ * @param values Valores (ex: saída de uppkg)
+ * @param n Número de canais
+ * @return COSMIC_ROLLUP_OK ou código de erro
+ */
+int cosmic_rollup_add(CosmicRollup* r, uint16_t dev_id, uint64_t ts_ms, const float* values, int n) {
+    if (n < 1) return COSMIC_ROLLUP_ERR_ARG;
+    if (n > COSMIC_ROLLUP_MAX_CHANNELS) n = COSMIC_ROLLUP_MAX_CHANNELS;
+    CosmicRollupSeries* s = _rollup_series(r, dev_id);
+    if (!s) return COSMIC_ROLLUP_ERR_MEM;
+    if (n > s->channels && !_rollup_grow(r, s, n)) return COSMIC_ROLLUP_ERR_MEM;
+
+    if (s->newest[0] == UINT32_MAX || ts_ms < s->first_ts) s->first_ts = ts_ms;
+    for (int l = 0; l < COSMIC_ROLLUP_LEVELS; l++) _rollup_add(s, l, ts_ms, values, n);
+    r->samples++;
+    return COSMIC_ROLLUP_OK;
+}
+
+/**
+ * @brief cosmic_rollup_summary - Min/max/média/último de cada canal em [t0, t1]
+ *
+ * A janela é alargada para minutos inteiros e limitada às amostras
+ * vistas e ao que os anéis ainda retêm; from/to trazem o intervalo
+ * realmente coberto.
+ *
+ * @param r Agregados
+ * @param dev_id Dispositivo
+ * @param t0 Início (ms, inclusive)
+ * @param t1 Fim (ms, inclusive)
+ * @param out Resumo
+ * @return COSMIC_ROLLUP_OK, COSMIC_ROLLUP_ERR_EMPTY ou COSMIC_ROLLUP_ERR_ARG
+ */
+int cosmic_rollup_summary(const CosmicRollup* r, uint16_t dev_id, uint64_t t0, uint64_t t1,
+                          CosmicRollupSummary* out) {
+    memset(out, 0, sizeof(*out));
+    out->dev_id = dev_id;
+    if (t1 < t0) return COSMIC_ROLLUP_ERR_ARG;
+    const CosmicRollupSeries* s = r->series[dev_id];
+    if (!s || s->newest[0] == UINT32_MAX) return COSMIC_ROLLUP_ERR_EMPTY;
+    out->channels = s->channels;
+
+    const uint64_t minute = _rollup_span[COSMIC_ROLLUP_MINUTE];
+    const uint64_t day = _rollup_span[COSMIC_ROLLUP_DAY];
+    uint64_t newest = s->newest[COSMIC_ROLLUP_MINUTE];
+    uint64_t a = (t0 > s->first_ts ? t0 : s->first_ts) / minute * minute;
+    uint64_t b = (t1 / minute < newest ? t1 / minute + 1 : newest + 1) * minute;
+    uint64_t oldest_day = s->newest[COSMIC_ROLLUP_DAY] + 1 > COSMIC_ROLLUP_DAYS
+                              ? s->newest[COSMIC_ROLLUP_DAY] + 1 - COSMIC_ROLLUP_DAYS : 0;
+    if (a < oldest_day * day) a = oldest_day * day;
+    if (a >= b) {
+        out->from = out->to = a;
+        return COSMIC_ROLLUP_OK;
+    }
+
+    // Cursor de a até b: o maior balde alinhado que cabe; bordas vencidas
+    // caem para o balde mais grosso que ainda as contém
+    out->from = a;
+    uint64_t t = a;
+    while (t < b) {
+        int level = -1;
+        for (int l = COSMIC_ROLLUP_DAY; l >= COSMIC_ROLLUP_MINUTE; l--) {
+            uint64_t span = _rollup_span[l];
+            if (t % span == 0 && t + span <= b && _rollup_retained(s, l, (uint32_t)(t / span))) {
+                level = l;
+                break;
+            }
+        }
+        if (level < 0) {
+            for (int l = COSMIC_ROLLUP_HOUR; l <= COSMIC_ROLLUP_DAY; l++) {
+                if (_rollup_retained(s, l, (uint32_t)(t / _rollup_span[l]))) {
+                    level = l;
+                    break;
+                }
+            }
+            if (level < 0) level = COSMIC_ROLLUP_DAY;     // Não acontece após o corte em oldest_day
+            uint64_t start = t / _rollup_span[level] * _rollup_span[level];
+            if (start < out->from) out->from = start;
+        }
+        uint32_t bucket = (uint32_t)(t / _rollup_span[level]);
+        _rollup_take(s, level, bucket, out);
+        t = ((uint64_t)bucket + 1) * _rollup_span[level];
+    }
+    out->to = t;
+    return COSMIC_ROLLUP_OK;
+}
+
+/**
+ * @brief cosmic_rollup_buckets - Percorre os baldes com dados de um nível em [t0, t1]
+ *
+ * Série para gráficos: um CosmicRollupCell por canal e balde, em ordem de tempo.
+ *
+ * @param level COSMIC_ROLLUP_MINUTE, _HOUR ou _DAY
+ * @return Número de baldes entregues, ou código de erro (< 0)
+ */
+long cosmic_rollup_buckets(const CosmicRollup* r, uint16_t dev_id, int level, uint64_t t0, uint64_t t1,
+                           CosmicRollupVisitor visit, void* user) {
+    if (level < 0 || level >= COSMIC_ROLLUP_LEVELS || t1 < t0) return COSMIC_ROLLUP_ERR_ARG;
+    const CosmicRollupSeries* s = r->series[dev_id];
+    if (!s || s->newest[level] == UINT32_MAX) return COSMIC_ROLLUP_ERR_EMPTY;
+
+    uint64_t first = t0 / _rollup_span[level];
+    uint64_t last = t1 / _rollup_span[level];
+    uint32_t newest = s->newest[level];
+    if (last > newest) last = newest;
+    if (first + _rollup_size[level] <= newest) first = newest + 1 - _rollup_size[level];
+    long total = 0;
+    for (uint64_t bucket = first; bucket <= last; bucket++) {
+        uint32_t slot = _rollup_slot(level, (uint32_t)bucket);
+        if (s->bucket[slot] != bucket) continue;
+        if (visit) visit(user, dev_id, bucket * _rollup_span[level], s->cells + slot * s->channels, s->channels);
+        total++;
+    }
+    return total;
+}
+
+/**
+ * @brief cosmic_rollup_json - Resumo como uma linha JSON compacta
+ *
+ *   {"dev":42,"from":..,"to":..,"n":3600,"min":[..],"max":[..],"mean":[..],"last":[..]}
+ *
+ * Canais sem valores saem como null. Feito para caber em painéis e em
+ * contexto de prompt: ~4 números por canal, independente do período.
+ *
+ * @return 1 se gravado, 0 se não coube (buffer inalterado)
+ */
+int cosmic_rollup_json(CosmicExportBuffer* b, const CosmicRollupSummary* sum) {
+    static const char* const keys[] = { ",\"min\":[", "],\"max\":[", "],\"mean\":[", "],\"last\":[" };
+    uint32_t mark = _export_begin(b);
+    _export_str(b, "{\"dev\":");
+    _export_uint(b, sum->dev_id);
+    _export_str(b, ",\"from\":");
+    _export_uint(b, sum->from);
+    _export_str(b, ",\"to\":");
+    _export_uint(b, sum->to);
+    _export_str(b, ",\"n\":");
+    _export_uint(b, sum->samples);
+    for (int k = 0; k < 4; k++) {
+        _export_str(b, keys[k]);
+        for (int c = 0; c < sum->channels; c++) {
+            const CosmicRollupCell* cell = &sum->stats[c];
+            if (c) _export_byte(b, ',');
+            if (!cell->count) {
+                _export_str(b, "null");
+                continue;
+            }
+            float v = k == 0 ? cell->min : k == 1 ? cell->max : k == 2 ? (float)(cell->sum / cell->count) : cell->last;
+            _export_float(b, v);
+        }
+    }
+    _export_str(b, "]}\n");
+    return _export_end(b, mark);
+}
+
+#endif // COSMIC_ROLLUP_H
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Compila rollup_tool, agrega uma frota sintética (fleet_gen) e imprime
+# o resumo de alguns dispositivos.
+# Uso: extras/rollup/rollup.sh [opções do fleet_gen, sem -o/-u]
+#      BIN=/tmp/rollup extras/rollup/rollup.sh -d 100 -n 200000 -e
+# Com o gateway: cosmic_ingestd ... | rollup_tool -j - -q 1
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+src="$here/../../src"
+host="$here/../host"
+loadgen="$here/../loadgen"
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+bin=${BIN:-$tmp}
+mkdir -p "$bin"
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+FLAGS="-O2 -DCOSMIC_PROFILE=3"
+
+$CC $FLAGS -c "$src/fastlz.c" -o "$tmp/fastlz.o"
+$CXX $FLAGS -I"$host" -I"$src" -I"$loadgen" "$loadgen/fleet_gen.cpp" "$tmp/fastlz.o" -lm -o "$bin/fleet_gen"
+$CXX $FLAGS -I"$host" -I"$src" -I"$loadgen" -I"$here" "$here/rollup_tool.cpp" "$tmp/fastlz.o" -lm -o "$bin/rollup_tool"
+
+ingest_flags=""
+for arg in "$@"; do
+    case "$arg" in
+        -e) ingest_flags="$ingest_flags $arg" ;;
+    esac
+done
+
+"$bin/fleet_gen" "$@" -o "$tmp/capture.bin"
+# Dispositivo 1: tudo e a primeira hora a partir do início padrão (já fora
+# dos anéis de minuto/hora com -n grande: volta o dia inteiro)
+"$bin/rollup_tool" -i "$tmp/capture.bin" $ingest_flags -q 1 -q 1:1700000000000:1700003599999
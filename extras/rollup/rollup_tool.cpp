@@ -0,0 +1,202 @@
+// Ferramenta dos agregados por janela (cosmic_rollup.h).
+//
+//   rollup_tool -i captura.bin [-t início_ms] [-s passo_ms] [-e] [-q dev:t0:t1]...
+//       Decodifica uma captura de fleet_gen (uppkg) e agrega a telemetria;
+//       o quadro k recebe o timestamp início + k * passo.
+//   rollup_tool -j leituras.jsonl | -j - [-q dev:t0:t1]...
+//       Agrega as linhas "telemetry" do cosmic_ingestd (campos ts, dev, values).
+//
+// Cada -q imprime o resumo (cosmic_rollup_json) de um dispositivo em
+// [t0, t1] ms; t0/t1 omitidos valem tudo. Sem -q, um resumo de todo o
+// período por dispositivo. Em stderr: amostras/s na agregação, memória
+// dos anéis e tempo médio por resumo.
+//
+// Compilar: ver extras/rollup/rollup.sh
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "cosmic_rollup.h"
+#include "cosmic_capture.h"
+#include "loadgen.h"
+
+#define ROLLUP_TOOL_MAX_QUERIES 64
+
+struct Query {
+    uint16_t dev;
+    uint64_t t0;
+    uint64_t t1;
+};
+
+static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static int usage() {
+    fprintf(stderr, "uso: rollup_tool (-i captura.bin [-t início_ms] [-s passo_ms] [-e] | -j arq.jsonl) "
+                    "[-q dev[:t0[:t1]]]...\n");
+    return 2;
+}
+
+/**
+ * @brief Valor numérico de "key" numa linha JSON plana
+ */
+static const char* json_field(const char* line, const char* key) {
+    char pat[32];
+    snprintf(pat, sizeof(pat), "\"%s\":", key);
+    const char* p = strstr(line, pat);
+    return p ? p + strlen(pat) : NULL;
+}
+
+static bool parse_query(const char* arg, Query* q) {
+    char* p;
+    unsigned long dev = strtoul(arg, &p, 10);
+    if (p == arg || dev >= COSMIC_ROLLUP_MAX_DEVICES) return false;
+    q->dev = (uint16_t)dev;
+    q->t0 = 0;
+    q->t1 = UINT64_MAX;
+    if (*p == ':') q->t0 = strtoull(p + 1, &p, 10);
+    if (*p == ':') q->t1 = strtoull(p + 1, &p, 10);
+    return *p == '\0';
+}
+
+static int ingest_capture(CosmicRollup* r, const char* path, uint64_t start, uint64_t step, bool encrypted) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { perror(path); return -1; }
+
+    CosmicCaptureRecord rec;
+    float values[MAX_COSMIC_BUFFER];
+    unsigned long frames = 0;
+    int rd;
+    while ((rd = cosmic_capture_read(f, &rec)) == 1) {
+        uint64_t ts = start + frames++ * step;
+        if (encrypted && !cosmic_decrypt(rec.data, rec.size, FLEET_NET_ID, rec.counter)) continue;
+        CosmicHeader hdr;
+        if (!cosmic_parse_header(rec.data, rec.size, &hdr) || hdr.type != PKG_TYPE_TELEMETRY) continue;
+        int n = uppkg(rec.data, rec.size, values, MAX_COSMIC_BUFFER);
+        if (n <= 0) continue;
+        if (cosmic_rollup_add(r, hdr.dev_id, ts, values, n) != COSMIC_ROLLUP_OK) {
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+    if (rd < 0) fprintf(stderr, "rollup_tool: captura truncada após %lu quadros\n", frames);
+    return 0;
+}
+
+static int ingest_jsonl(CosmicRollup* r, const char* path) {
+    FILE* f = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!f) { perror(path); return -1; }
+
+    static char line[1 << 16];
+    float values[COSMIC_ROLLUP_MAX_CHANNELS];
+    while (fgets(line, sizeof(line), f)) {
+        if (!strstr(line, "\"type\":\"telemetry\"")) continue;
+        const char* ts = json_field(line, "ts");
+        const char* dev = json_field(line, "dev");
+        const char* v = json_field(line, "values");
+        if (!ts || !dev || !v || *v != '[') continue;
+
+        int n = 0;
+        char* p = (char*)v + 1;
+        while (*p && *p != ']' && n < COSMIC_ROLLUP_MAX_CHANNELS) {
+            values[n++] = strtof(p, &p);
+            if (*p == ',') p++;
+        }
+        if (n == 0) continue;
+        if (cosmic_rollup_add(r, (uint16_t)strtoul(dev, NULL, 10), strtoull(ts, NULL, 10), values, n)
+            != COSMIC_ROLLUP_OK) {
+            if (f != stdin) fclose(f);
+            return -1;
+        }
+    }
+    if (f != stdin) fclose(f);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* capture = NULL;
+    const char* jsonl = NULL;
+    uint64_t start = 1700000000000ULL, step = 1000;
+    bool encrypted = false;
+    static Query queries[ROLLUP_TOOL_MAX_QUERIES];
+    int nq = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:j:t:s:eq:")) != -1) {
+        switch (opt) {
+            case 'i': capture = optarg; break;
+            case 'j': jsonl = optarg; break;
+            case 't': start = strtoull(optarg, NULL, 10); break;
+            case 's': step = strtoull(optarg, NULL, 10); break;
+            case 'e': encrypted = true; break;
+            case 'q':
+                if (nq == ROLLUP_TOOL_MAX_QUERIES || !parse_query(optarg, &queries[nq])) return usage();
+                nq++;
+                break;
+            default: return usage();
+        }
+    }
+    if (!capture == !jsonl) return usage();
+
+    CosmicRollup r;
+    if (cosmic_rollup_init(&r) != COSMIC_ROLLUP_OK) {
+        fprintf(stderr, "rollup_tool: sem memória\n");
+        return 1;
+    }
+    setCosmicKey(FLEET_KEY);
+    if (encrypted) enableEncryption(); else disableEncryption();
+    setCosmicMixedHeaders(true);           // Mesmo formato misto da frota (fleet_gen)
+
+    uint64_t t = now_ns();
+    int rc = capture ? ingest_capture(&r, capture, start, step, encrypted) : ingest_jsonl(&r, jsonl);
+    uint64_t ns = now_ns() - t;
+    if (rc != 0) {
+        fprintf(stderr, "rollup_tool: falha ao agregar\n");
+        cosmic_rollup_free(&r);
+        return 1;
+    }
+    fprintf(stderr, "rollup_tool: %llu amostras de %u dispositivos em %.3f s (%.0f amostras/s, %.0f ns/amostra), "
+                    "%.1f KiB de anéis\n",
+            (unsigned long long)r.samples, r.devices, ns / 1e9, ns ? r.samples * 1e9 / ns : 0.0,
+            r.samples ? (double)ns / r.samples : 0.0, r.bytes / 1024.0);
+
+    // Sem -q: todo o período de cada dispositivo
+    if (nq == 0) {
+        for (uint32_t d = 0; d < COSMIC_ROLLUP_MAX_DEVICES && nq < ROLLUP_TOOL_MAX_QUERIES; d++) {
+            if (!r.series[d]) continue;
+            queries[nq].dev = (uint16_t)d;
+            queries[nq].t0 = 0;
+            queries[nq].t1 = UINT64_MAX;
+            nq++;
+        }
+    }
+
+    static uint8_t text[1 << 16];
+    CosmicExportBuffer out;
+    cosmic_export_init(&out, text, sizeof(text));
+    CosmicRollupSummary sum;
+    uint64_t query_ns = 0;
+    for (int i = 0; i < nq; i++) {
+        t = now_ns();
+        int q = cosmic_rollup_summary(&r, queries[i].dev, queries[i].t0, queries[i].t1, &sum);
+        query_ns += now_ns() - t;
+        if (q != COSMIC_ROLLUP_OK) {
+            fprintf(stderr, "rollup_tool: dev %u sem amostras\n", queries[i].dev);
+            continue;
+        }
+        if (!cosmic_rollup_json(&out, &sum)) {
+            fwrite(out.data, 1, out.len, stdout);
+            cosmic_export_reset(&out);
+            cosmic_rollup_json(&out, &sum);
+        }
+    }
+    fwrite(out.data, 1, out.len, stdout);
+    if (nq) fprintf(stderr, "rollup_tool: %d resumos, %.2f us por resumo\n", nq, query_ns / 1e3 / nq);
+
+    cosmic_rollup_free(&r);
+    return 0;
+}
@@ -0,0 +1,27 @@
+#!/bin/sh
+# Compila sched_sim e roda o escalonador com relógio simulado: canal livre,
+# canal ocupado 30% e 60% do tempo (agregação, também cifrada) e duty
+# cycle apertado.
+# Uso: extras/scheduler/sched.sh [opções extras do sched_sim]
+#      extras/scheduler/sched.sh -t 86400 -k 32
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+src="$here/../../src"
+host="$here/../host"
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+bin=${BIN:-$tmp}
+mkdir -p "$bin"
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+FLAGS="-O2 -DCOSMIC_PROFILE=3"
+
+$CC $FLAGS -c "$src/fastlz.c" -o "$tmp/fastlz.o"
+$CXX $FLAGS -I"$host" -I"$src" "$here/sched_sim.cpp" "$tmp/fastlz.o" -lm -o "$bin/sched_sim"
+
+"$bin/sched_sim" -b 0 "$@"
+"$bin/sched_sim" -b 30 -B 20000 "$@"
+"$bin/sched_sim" -b 60 -B 60000 "$@"
+"$bin/sched_sim" -b 60 -B 60000 -e "$@"
+"$bin/sched_sim" -b 30 -B 20000 -d 1 "$@"
@@ -0,0 +1,185 @@
+// Simulação do escalonador de transmissão (cosmic_scheduler.h) com relógio simulado.
+//
+// Um nó com -k sensores gera telemetria a cada -p ms (fases espalhadas),
+// STATUS a cada 5 min, e entrega tudo a cosmic_sched_ppkg. O relógio
+// avança de 1 em 1 ms e é o now_ms passado ao escalonador; o canal fica
+// ocupado em rajadas (-b % do tempo, -B ms em média) e cada quadro
+// entregue por cosmic_sched_poll ocupa o rádio pelo seu tempo no ar.
+// Com -e a fila fica em claro e cada quadro é cifrado no poll; o gateway
+// decifra com o contador na ordem de transmissão.
+//
+// O "gateway" decodifica cada quadro pelo cabeçalho (uppkg ou
+// cosmic_agg_open/next + uppkg_payload) e confere que cada leitura chega
+// uma vez. Uma linha JSON:
+//
+//   {"sim_s":..,"readings":..,"refused":..,"delivered":..,"duplicates":..,
+//    "frames":..,"aggregates":..,"min_records":..,"type_mismatch":..,
+//    "decode_errors":..,"pending":..,"airtime_s":..,"duty_pct":..,"duty_ok":..}
+//
+// Uso: sched_sim [-t segundos] [-k sensores] [-p período_ms] [-d duty‰] [-b ocupado%] [-B rajada_ms] [-s semente] [-e]
+//
+// Compilar: ver extras/scheduler/sched.sh
+
+#include <stdio.h>
+#include "cosmic_scheduler.h"
+
+#define SIM_NET_ID  3
+#define SIM_NODE_ID 9
+#define SIM_MAX_READINGS (1UL << 22)
+#define SIM_ID_BASE 300                    // id = v[1] * SIM_ID_BASE + v[0] (cabe na quantização)
+
+static const uint8_t _key[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+
+static uint8_t _seen[SIM_MAX_READINGS];
+
+struct SimStats {
+    unsigned long readings, refused, delivered, duplicates;
+    unsigned long frames, aggregates, type_mismatch, decode_errors;
+    int min_records;
+};
+
+static int usage() {
+    fprintf(stderr, "uso: sched_sim [-t segundos] [-k sensores] [-p período_ms] [-d duty‰] [-b ocupado%%] "
+                    "[-B rajada_ms] [-s semente] [-e]\n");
+    return 2;
+}
+
+static void deliver_reading(SimStats* st, const float* v, int n) {
+    if (n < 2) {
+        st->decode_errors++;
+        return;
+    }
+    unsigned long id = (unsigned long)lroundf(v[1]) * SIM_ID_BASE + (unsigned long)lroundf(v[0]);
+    if (id >= SIM_MAX_READINGS) {
+        st->decode_errors++;
+    } else if (_seen[id]) {
+        st->duplicates++;
+    } else {
+        _seen[id] = 1;
+        st->delivered++;
+    }
+}
+
+/**
+ * @brief Gateway: decodifica um quadro transmitido e confere o tipo anunciado
+ */
+static void receive(SimStats* st, CosmicPacket* pkg, bool encrypted, uint32_t counter) {
+    CosmicHeader hdr;
+    float v[8];
+    st->frames++;
+    if (encrypted && !cosmic_decrypt(pkg->data, pkg->size, SIM_NET_ID, counter)) {
+        st->decode_errors++;
+        return;
+    }
+    if (!cosmic_parse_header(pkg->data, pkg->size, &hdr)) {
+        st->decode_errors++;
+        return;
+    }
+    if (hdr.type != pkg->type) st->type_mismatch++;
+
+    if (hdr.type == PKG_TYPE_TELEMETRY) {
+        deliver_reading(st, v, uppkg(pkg->data, pkg->size, v, 8));
+    } else if (hdr.type == PKG_TYPE_AGGREGATE) {
+        static uint8_t scratch[MAX_COSMIC_BUFFER];
+        CosmicAggReader rd;
+        CosmicRecord rec;
+        int records = cosmic_agg_open(&rd, pkg->data, pkg->size, scratch, sizeof(scratch));
+        if (records < 0) {
+            st->decode_errors++;
+            return;
+        }
+        st->aggregates++;
+        if (st->min_records == 0 || records < st->min_records) st->min_records = records;
+        int r;
+        while ((r = cosmic_agg_next(&rd, &rec)) == 1) {
+            deliver_reading(st, v, uppkg_payload(rec.mode, rec.payload, rec.size, v, 8));
+        }
+        if (r < 0) st->decode_errors++;
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned long sim_s = 3600, period_ms = 60000, burst_ms = 2000;
+    int sensors = 8, duty = 10, busy_pct = 30;
+    unsigned seed = 1;
+    bool encrypted = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "t:k:p:d:b:B:s:e")) != -1) {
+        switch (opt) {
+            case 't': sim_s = strtoul(optarg, NULL, 10); break;
+            case 'k': sensors = atoi(optarg); break;
+            case 'p': period_ms = strtoul(optarg, NULL, 10); break;
+            case 'd': duty = atoi(optarg); break;
+            case 'b': busy_pct = atoi(optarg); break;
+            case 'B': burst_ms = strtoul(optarg, NULL, 10); break;
+            case 's': seed = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'e': encrypted = true; break;
+            default: return usage();
+        }
+    }
+    if (sim_s == 0 || sensors <= 0 || sensors > 1000 || period_ms == 0 || duty < 0 || busy_pct < 0 ||
+        busy_pct >= 100 || burst_ms == 0) {
+        return usage();
+    }
+    srand(seed);
+    setCosmicKey(_key);
+    if (encrypted) enableEncryption(); else disableEncryption();
+
+    LoraRadioConfig radio = { 9, 125000, LORA_CR_4_5, 8, true, true, false, 400 };
+    static CosmicScheduler sched;
+    uint32_t now = 0;
+    cosmic_sched_init(&sched, &radio, (uint16_t)duty, SIM_NET_ID, SIM_NODE_ID, now);
+
+    SimStats st;
+    memset(&st, 0, sizeof(st));
+    // Probabilidade por ms de iniciar uma rajada para ocupar busy_pct do tempo
+    double start_p = busy_pct ? (double)busy_pct / ((100.0 - busy_pct) * burst_ms) : 0.0;
+    uint32_t busy_until = 0, radio_until = 0;
+    uint64_t airtime_us = 0;
+    unsigned long next_id = 0;
+    uint32_t end = (uint32_t)(sim_s * 1000);
+
+    for (now = 0; now < end; now++) {
+        for (int k = 0; k < sensors; k++) {
+            if ((now + k * (period_ms / sensors)) % period_ms != 0 || next_id >= SIM_MAX_READINGS) continue;
+            float v[4] = { (float)(next_id % SIM_ID_BASE), (float)(next_id / SIM_ID_BASE),
+                           20.0f + k, (float)(now % 1000) / 10.0f };
+            next_id++;
+            st.readings++;
+            if (!cosmic_sched_ppkg(&sched, true, SIM_NET_ID, (uint16_t)(100 + k), PKG_TYPE_TELEMETRY,
+                                   COMPRESS_COSMIC, v, 4)) {
+                st.refused++;
+            }
+        }
+        if (now % 300000 == 0) {
+            float s[2] = { (float)(now / 1000), 3.3f };
+            cosmic_sched_ppkg(&sched, false, SIM_NET_ID, SIM_NODE_ID, PKG_TYPE_STATUS, COMPRESS_NONE, s, 2);
+        }
+
+        if (now >= busy_until && (double)rand() / RAND_MAX < start_p) busy_until = now + burst_ms;
+        if (now < radio_until) continue;
+
+        CosmicPacket out;
+        uint32_t counter = _packet_counter;  // Contador que o poll usará se cifrar
+        if (cosmic_sched_poll(&sched, now, now < busy_until, &out)) {
+            uint32_t us = lora_time_on_air_us(&radio, out.size);
+            airtime_us += us;
+            radio_until = now + (us + 999) / 1000;
+            receive(&st, &out, encrypted, counter);
+        }
+    }
+
+    // Balde cheio no início + duty sobre o tempo simulado
+    double allowed_us = duty ? (double)COSMIC_DUTY_WINDOW_MS * duty + (double)end * duty : 0.0;
+    bool duty_ok = duty == 0 || airtime_us <= allowed_us;
+    printf("{\"sim_s\":%lu,\"readings\":%lu,\"refused\":%lu,\"delivered\":%lu,\"duplicates\":%lu,\"frames\":%lu,"
+           "\"aggregates\":%lu,\"min_records\":%d,\"type_mismatch\":%lu,\"decode_errors\":%lu,\"pending\":%u,\"airtime_s\":%.1f,"
+           "\"duty_pct\":%.3f,\"duty_ok\":%s}\n",
+           sim_s, st.readings, st.refused, st.delivered, st.duplicates, st.frames, st.aggregates, st.min_records,
+           st.type_mismatch, st.decode_errors, cosmic_sched_pending(&sched), airtime_us / 1e6, airtime_us / 10.0 / end,
+           duty_ok ? "true" : "false");
+    bool ok = duty_ok && st.duplicates == 0 && st.type_mismatch == 0 && st.decode_errors == 0 &&
+              (st.aggregates == 0 || st.min_records >= 2);
+    return ok ? 0 : 1;
+}
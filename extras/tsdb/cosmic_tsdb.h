@@ -0,0 +1,730 @@
+// Armazenamento colunar de telemetria decodificada (host/gateway, Linux).
+//
+// Só acrescenta. Cada dispositivo tem um diretório com segmentos
+// mapeados em memória:
+//
+//   <dir>/dev_00042/seg_000000.col, seg_000001.col, ...
+//
+// Segmento (little-endian, layout fixo):
+//   [CosmicTsdbSegmentHeader][dir_entries x CosmicTsdbDirEntry][blocos...]
+// O diretório é o índice: intervalo de tempo, deslocamento e tamanho de
+// cada bloco. O primeiro segmento reserva COSMIC_TSDB_DIR_FIRST entradas e
+// cada segmento seguinte o dobro, até COSMIC_TSDB_DIR_ENTRIES: um
+// dispositivo com poucas amostras não paga um diretório de 6 KiB. Uma consulta lê só os cabeçalhos dos segmentos, o diretório
+// e os blocos cujo intervalo cruza a janela pedida.
+//
+// Bloco: até COSMIC_TSDB_BLOCK_SAMPLES amostras de um dispositivo, em colunas:
+//   timestamps  delta-of-delta em ms, zigzag varint
+//   canal c     COSMIC_TSDB_COL_DELTA: centésimos com delta, zigzag varint
+//               (o mesmo código de COMPRESS_COSMIC_VARINT; exato para tudo
+//               que uppkg devolve nos modos COSMIC)
+//               COSMIC_TSDB_COL_XOR: bits do float XOR o anterior (floats crus)
+// O corpo do bloco passa pelo fastlz quando isso reduz o tamanho.
+//
+// Amostras ficam num bloco aberto em RAM até completar o bloco,
+// cosmic_tsdb_flush ou cosmic_tsdb_close; não há log: o bloco aberto se
+// perde se o processo cair. Um CosmicTsdb é de um único thread.
+
+#ifndef COSMIC_TSDB_H
+#define COSMIC_TSDB_H
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cosmic_payload.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+
+#ifndef COSMIC_TSDB_SEGMENT_SIZE
+#define COSMIC_TSDB_SEGMENT_SIZE (1u << 20)    // Tamanho máximo de um segmento
+#endif
+
+#ifndef COSMIC_TSDB_DIR_ENTRIES
+#define COSMIC_TSDB_DIR_ENTRIES 256            // Máximo de blocos por segmento (diretório de 6 KiB)
+#endif
+
+#ifndef COSMIC_TSDB_DIR_FIRST
+#define COSMIC_TSDB_DIR_FIRST 4                // Blocos no primeiro segmento de cada dispositivo
+#endif
+
+#ifndef COSMIC_TSDB_BLOCK_SAMPLES
+#define COSMIC_TSDB_BLOCK_SAMPLES 256          // Amostras por bloco
+#endif
+
+#define COSMIC_TSDB_MAX_CHANNELS 256
+#define COSMIC_TSDB_MAX_DEVICES  65536
+#define COSMIC_TSDB_MAGIC        0x53544C43    // "CLTS"
+#define COSMIC_TSDB_VERSION      2
+
+#define COSMIC_TSDB_COL_DELTA    0
+#define COSMIC_TSDB_COL_XOR      1
+#define COSMIC_TSDB_BLOCK_LZ     0x01          // Corpo comprimido com fastlz
+
+// Maior delta entre amostras consecutivas num bloco (~12 dias); acima disso abre outro bloco
+#define COSMIC_TSDB_MAX_DELTA_MS (1 << 30)
+
+// Códigos de retorno
+#define COSMIC_TSDB_OK           0
+#define COSMIC_TSDB_ERR_ARG      -1
+#define COSMIC_TSDB_ERR_IO       -2
+#define COSMIC_TSDB_ERR_CORRUPT  -3
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+struct CosmicTsdbSegmentHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t dev_id;
+    uint32_t used;                         // Bytes ocupados (cabeçalho + diretório + blocos)
+    uint32_t entries;                      // Blocos no diretório
+    uint64_t t_min;
+    uint64_t t_max;
+    uint32_t samples;
+    uint32_t dir_entries;                  // Capacidade do diretório deste segmento
+};
+
+struct CosmicTsdbDirEntry {
+    uint64_t t_min;
+    uint64_t t_max;
+    uint32_t offset;
+    uint32_t size;                         // Cabeçalho do bloco + corpo gravado
+};
+
+struct CosmicTsdbBlockHeader {
+    uint64_t t_first;
+    uint32_t raw_size;                     // Corpo antes do fastlz
+    uint32_t stored_size;                  // Corpo gravado
+    uint16_t count;
+    uint16_t channels;
+    uint32_t flags;                        // COSMIC_TSDB_BLOCK_*
+};
+
+// Início dos blocos num segmento com diretório de `entries` posições
+#define COSMIC_TSDB_DATA_START(entries) \
+    (sizeof(CosmicTsdbSegmentHeader) + (entries) * sizeof(CosmicTsdbDirEntry))
+
+// Maior corpo de bloco: varint de 5 bytes por timestamp e por valor
+#define COSMIC_TSDB_MAX_RAW \
+    (COSMIC_TSDB_BLOCK_SAMPLES * 5 * (COSMIC_TSDB_MAX_CHANNELS + 1) + COSMIC_TSDB_MAX_CHANNELS)
+
+/**
+ * @brief Série de um dispositivo: bloco aberto e segmento de escrita mapeado
+ */
+struct CosmicTsdbSeries {
+    uint16_t dev_id;
+    uint16_t channels;                     // Canais do bloco aberto
+    uint16_t count;                        // Amostras no bloco aberto
+    uint32_t segment;                      // Índice do segmento de escrita
+    uint8_t* map;                          // Segmento de escrita (NULL até o primeiro bloco)
+    uint64_t ts[COSMIC_TSDB_BLOCK_SAMPLES];
+    float* values;                         // [COSMIC_TSDB_BLOCK_SAMPLES][channels]
+};
+
+struct CosmicTsdb {
+    char dir[256];
+    CosmicTsdbSeries** series;             // Indexado por dev_id, criado sob demanda
+    uint8_t* raw;                          // Scratch: corpo do bloco
+    uint8_t* packed;                       // Scratch: corpo após fastlz
+    uint64_t* block_ts;                    // Scratch de consulta
+    float* block_values;
+    uint64_t blocks_written;
+    uint64_t bytes_raw;                    // Corpos antes do fastlz
+    uint64_t bytes_stored;                 // Blocos gravados (com cabeçalho)
+};
+
+/**
+ * @brief Resumo de um dispositivo (cosmic_tsdb_info)
+ */
+struct CosmicTsdbInfo {
+    uint32_t segments;
+    uint32_t blocks;
+    uint64_t samples;
+    uint64_t bytes;
+    uint64_t t_min;
+    uint64_t t_max;
+};
+
+/**
+ * @brief Recebe cada amostra de uma consulta
+ */
+typedef void (*CosmicTsdbVisitor)(void* user, uint16_t dev_id, uint64_t ts, const float* values, int n);
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+static void _tsdb_segment_path(const CosmicTsdb* db, uint16_t dev_id, uint32_t seg, char* out, size_t max) {
+    snprintf(out, max, "%s/dev_%05u/seg_%06u.col", db->dir, dev_id, seg);
+}
+
+/**
+ * @brief Quantos segmentos o dispositivo já tem em disco
+ */
+static uint32_t _tsdb_count_segments(const CosmicTsdb* db, uint16_t dev_id) {
+    char path[320];
+    struct stat st;
+    uint32_t n = 0;
+    for (;;) {
+        _tsdb_segment_path(db, dev_id, n, path, sizeof(path));
+        if (stat(path, &st) != 0) return n;
+        n++;
+    }
+}
+
+/**
+ * @brief Capacidade do diretório do segmento seg (dobra a cada segmento)
+ */
+static uint32_t _tsdb_dir_capacity(uint32_t seg) {
+    uint32_t n = COSMIC_TSDB_DIR_FIRST;
+    while (seg-- && n < COSMIC_TSDB_DIR_ENTRIES) n *= 2;
+    return n < COSMIC_TSDB_DIR_ENTRIES ? n : COSMIC_TSDB_DIR_ENTRIES;
+}
+
+/**
+ * @brief Cabeçalho coerente (magic, versão, diretório e bytes usados)
+ */
+static bool _tsdb_header_valid(const CosmicTsdbSegmentHeader* hdr) {
+    return hdr->magic == COSMIC_TSDB_MAGIC && hdr->version == COSMIC_TSDB_VERSION &&
+           hdr->dir_entries >= 1 && hdr->dir_entries <= COSMIC_TSDB_DIR_ENTRIES &&
+           hdr->entries <= hdr->dir_entries && hdr->used >= COSMIC_TSDB_DATA_START(hdr->dir_entries) &&
+           hdr->used <= COSMIC_TSDB_SEGMENT_SIZE;
+}
+
+/**
+ * @brief Mapeia um segmento para escrita, criando-o se não existe
+ *
+ * O arquivo fica com COSMIC_TSDB_SEGMENT_SIZE (esparso) enquanto está
+ * aberto e volta a `used` em _tsdb_unmap_segment.
+ */
+static uint8_t* _tsdb_map_segment(CosmicTsdb* db, CosmicTsdbSeries* s) {
+    char path[320];
+    snprintf(path, sizeof(path), "%s/dev_%05u", db->dir, s->dev_id);
+    mkdir(path, 0755);
+    _tsdb_segment_path(db, s->dev_id, s->segment, path, sizeof(path));
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ftruncate(fd, COSMIC_TSDB_SEGMENT_SIZE) != 0) {
+        close(fd);
+        return NULL;
+    }
+    void* map = mmap(NULL, COSMIC_TSDB_SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);                             // O mapeamento mantém o arquivo
+    if (map == MAP_FAILED) return NULL;
+
+    CosmicTsdbSegmentHeader* hdr = (CosmicTsdbSegmentHeader*)map;
+    if (st.st_size == 0) {
+        memset(hdr, 0, sizeof(*hdr));
+        hdr->magic = COSMIC_TSDB_MAGIC;
+        hdr->version = COSMIC_TSDB_VERSION;
+        hdr->dev_id = s->dev_id;
+        hdr->dir_entries = _tsdb_dir_capacity(s->segment);
+        hdr->used = COSMIC_TSDB_DATA_START(hdr->dir_entries);
+        hdr->t_min = UINT64_MAX;
+    } else if (!_tsdb_header_valid(hdr)) {
+        munmap(map, COSMIC_TSDB_SEGMENT_SIZE);
+        return NULL;
+    }
+    return (uint8_t*)map;
+}
+
+static void _tsdb_unmap_segment(CosmicTsdb* db, CosmicTsdbSeries* s) {
+    if (!s->map) return;
+    uint32_t used = ((CosmicTsdbSegmentHeader*)s->map)->used;
+    munmap(s->map, COSMIC_TSDB_SEGMENT_SIZE);
+    s->map = NULL;
+
+    char path[320];
+    _tsdb_segment_path(db, s->dev_id, s->segment, path, sizeof(path));
+    if (truncate(path, used) != 0) perror(path);
+}
+
+static CosmicTsdbSeries* _tsdb_series(CosmicTsdb* db, uint16_t dev_id) {
+    CosmicTsdbSeries* s = db->series[dev_id];
+    if (s) return s;
+    s = (CosmicTsdbSeries*)calloc(1, sizeof(CosmicTsdbSeries));
+    if (!s) return NULL;
+    s->dev_id = dev_id;
+    uint32_t n = _tsdb_count_segments(db, dev_id);
+    s->segment = n ? n - 1 : 0;            // Continua o último segmento
+    db->series[dev_id] = s;
+    return s;
+}
+
+/**
+ * @brief Coluna de canal: centésimos com delta se todos os valores forem exatos
+ */
+static int _tsdb_put_channel(uint8_t* out, const float* values, int stride, int count) {
+    int pos = 1;
+    bool exact = true;
+    for (int i = 0; i < count && exact; i++) {
+        float v = values[i * stride];
+        float q = roundf(v * (float)COSMIC_QUANT_SCALE);
+        float back = (int32_t)q / (float)COSMIC_QUANT_SCALE;   // Mesma conta de _dequantize_delta
+        exact = fabsf(q) < (float)(1 << 29) && memcmp(&back, &v, sizeof(v)) == 0;
+    }
+
+    if (exact) {
+        out[0] = COSMIC_TSDB_COL_DELTA;
+        int32_t prev = 0;
+        for (int i = 0; i < count; i++) {
+            int32_t q = (int32_t)roundf(values[i * stride] * (float)COSMIC_QUANT_SCALE);
+            pos += _put_varint(out + pos, _zigzag_encode(q - prev));
+            prev = q;
+        }
+        return pos;
+    }
+
+    // XOR com o anterior: [zeros à esquerda (bytes) << 4 | zeros à direita][bytes do meio]
+    out[0] = COSMIC_TSDB_COL_XOR;
+    uint32_t prev = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t bits;
+        memcpy(&bits, &values[i * stride], 4);
+        uint32_t x = bits ^ prev;
+        prev = bits;
+        if (x == 0) {
+            out[pos++] = 0xFF;
+            continue;
+        }
+        int lead = __builtin_clz(x) / 8, trail = __builtin_ctz(x) / 8;
+        out[pos++] = (uint8_t)(lead << 4 | trail);
+        for (int b = trail; b < 4 - lead; b++) out[pos++] = (uint8_t)(x >> (8 * b));
+    }
+    return pos;
+}
+
+static int _tsdb_get_channel(const uint8_t* in, int avail, float* values, int stride, int count) {
+    if (avail < 1) return 0;
+    int pos = 1;
+    if (in[0] == COSMIC_TSDB_COL_DELTA) {
+        int32_t q = 0;
+        for (int i = 0; i < count; i++) {
+            uint32_t zz;
+            int used = _get_varint(in + pos, avail - pos, &zz);
+            if (!used) return 0;
+            pos += used;
+            q += _zigzag_decode(zz);
+            values[i * stride] = q / (float)COSMIC_QUANT_SCALE;
+        }
+        return pos;
+    }
+    if (in[0] != COSMIC_TSDB_COL_XOR) return 0;
+
+    uint32_t prev = 0;
+    for (int i = 0; i < count; i++) {
+        if (pos >= avail) return 0;
+        uint8_t ctl = in[pos++];
+        uint32_t x = 0;
+        if (ctl != 0xFF) {
+            int lead = ctl >> 4, trail = ctl & 0x0F;
+            if (lead + trail > 3 || pos + 4 - lead - trail > avail) return 0;
+            for (int b = trail; b < 4 - lead; b++) x |= (uint32_t)in[pos++] << (8 * b);
+        }
+        prev ^= x;
+        memcpy(&values[i * stride], &prev, 4);
+    }
+    return pos;
+}
+
+/**
+ * @brief Codifica o bloco aberto em db->raw
+ * @return Tamanho do corpo
+ */
+static int _tsdb_encode_block(CosmicTsdb* db, const CosmicTsdbSeries* s) {
+    uint8_t* out = db->raw;
+    int pos = 0;
+    int32_t prev_delta = 0;
+    for (int i = 1; i < s->count; i++) {
+        int32_t delta = (int32_t)(s->ts[i] - s->ts[i - 1]);
+        pos += _put_varint(out + pos, _zigzag_encode(delta - prev_delta));
+        prev_delta = delta;
+    }
+    for (int c = 0; c < s->channels; c++) {
+        pos += _tsdb_put_channel(out + pos, s->values + c, s->channels, s->count);
+    }
+    return pos;
+}
+
+/**
+ * @brief Decodifica um bloco gravado em db->block_ts / db->block_values
+ * @return 1 se válido, 0 se corrompido
+ */
+static int _tsdb_decode_block(CosmicTsdb* db, const uint8_t* block, uint32_t size) {
+    CosmicTsdbBlockHeader bh;
+    if (size < sizeof(bh)) return 0;
+    memcpy(&bh, block, sizeof(bh));
+    if (bh.count == 0 || bh.count > COSMIC_TSDB_BLOCK_SAMPLES || bh.channels > COSMIC_TSDB_MAX_CHANNELS ||
+        bh.stored_size != size - sizeof(bh) || bh.raw_size > COSMIC_TSDB_MAX_RAW) return 0;
+
+    const uint8_t* body = block + sizeof(bh);
+    if (bh.flags & COSMIC_TSDB_BLOCK_LZ) {
+        int n = fastlz_decompress(body, bh.stored_size, db->raw, COSMIC_TSDB_MAX_RAW);
+        if (n != (int)bh.raw_size) return 0;
+        body = db->raw;
+    }
+
+    int pos = 0, avail = (int)bh.raw_size;
+    uint64_t ts = bh.t_first;
+    int32_t delta = 0;
+    db->block_ts[0] = ts;
+    for (int i = 1; i < bh.count; i++) {
+        uint32_t zz;
+        int used = _get_varint(body + pos, avail - pos, &zz);
+        if (!used) return 0;
+        pos += used;
+        delta += _zigzag_decode(zz);
+        ts += (int64_t)delta;
+        db->block_ts[i] = ts;
+    }
+    for (int c = 0; c < bh.channels; c++) {
+        int used = _tsdb_get_channel(body + pos, avail - pos, db->block_values + c, bh.channels, bh.count);
+        if (!used) return 0;
+        pos += used;
+    }
+    return pos == avail;
+}
+
+/**
+ * @brief Grava o bloco aberto no segmento de escrita (abre outro se não cabe)
+ */
+static int _tsdb_flush_series(CosmicTsdb* db, CosmicTsdbSeries* s) {
+    if (s->count == 0) return COSMIC_TSDB_OK;
+
+    CosmicTsdbBlockHeader bh;
+    memset(&bh, 0, sizeof(bh));
+    bh.t_first = s->ts[0];
+    bh.count = s->count;
+    bh.channels = s->channels;
+    bh.raw_size = (uint32_t)_tsdb_encode_block(db, s);
+
+    const uint8_t* body = db->raw;
+    bh.stored_size = bh.raw_size;
+    if (bh.raw_size >= 32) {
+        int lz = fastlz_compress_level(1, db->raw, (int)bh.raw_size, db->packed);
+        if (lz > 0 && (uint32_t)lz < bh.raw_size) {
+            body = db->packed;
+            bh.stored_size = (uint32_t)lz;
+            bh.flags |= COSMIC_TSDB_BLOCK_LZ;
+        }
+    }
+
+    uint64_t t_min = UINT64_MAX, t_max = 0;
+    for (int i = 0; i < s->count; i++) {
+        if (s->ts[i] < t_min) t_min = s->ts[i];
+        if (s->ts[i] > t_max) t_max = s->ts[i];
+    }
+
+    uint32_t size = (uint32_t)sizeof(bh) + bh.stored_size;
+    uint32_t aligned = (size + 7) & ~7u;
+    for (int attempt = 0; ; attempt++) {
+        if (!s->map && !(s->map = _tsdb_map_segment(db, s))) return COSMIC_TSDB_ERR_IO;
+        CosmicTsdbSegmentHeader* hdr = (CosmicTsdbSegmentHeader*)s->map;
+        if (hdr->entries < hdr->dir_entries && hdr->used + aligned <= COSMIC_TSDB_SEGMENT_SIZE) break;
+        if (attempt) return COSMIC_TSDB_ERR_ARG;   // Não cabe nem num segmento vazio
+        _tsdb_unmap_segment(db, s);
+        s->segment++;
+    }
+
+    // Bloco, depois a entrada do diretório, por último os contadores
+    CosmicTsdbSegmentHeader* hdr = (CosmicTsdbSegmentHeader*)s->map;
+    uint8_t* dst = s->map + hdr->used;
+    memcpy(dst, &bh, sizeof(bh));
+    memcpy(dst + sizeof(bh), body, bh.stored_size);
+
+    CosmicTsdbDirEntry* dir = (CosmicTsdbDirEntry*)(s->map + sizeof(CosmicTsdbSegmentHeader));
+    CosmicTsdbDirEntry* e = &dir[hdr->entries];
+    e->t_min = t_min;
+    e->t_max = t_max;
+    e->offset = hdr->used;
+    e->size = size;
+
+    if (t_min < hdr->t_min) hdr->t_min = t_min;
+    if (t_max > hdr->t_max) hdr->t_max = t_max;
+    hdr->samples += s->count;
+    hdr->used += aligned;
+    hdr->entries++;
+
+    db->blocks_written++;
+    db->bytes_raw += bh.raw_size;
+    db->bytes_stored += size;
+    s->count = 0;
+    return COSMIC_TSDB_OK;
+}
+
+/**
+ * @brief Entrega as amostras de [t0, t1] de um bloco decodificado
+ */
+static uint32_t _tsdb_visit(uint16_t dev_id, const uint64_t* ts, const float* values,
+                            int count, int channels, uint64_t t0, uint64_t t1,
+                            CosmicTsdbVisitor visit, void* user) {
+    uint32_t n = 0;
+    for (int i = 0; i < count; i++) {
+        if (ts[i] < t0 || ts[i] > t1) continue;
+        if (visit) visit(user, dev_id, ts[i], values + i * channels, channels);
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Lê o cabeçalho de um segmento e, se map != NULL, mapeia-o só para leitura
+ * @return Bytes usados do segmento, ou 0 se não existe/inválido
+ */
+static uint32_t _tsdb_map_readonly(const CosmicTsdb* db, uint16_t dev_id, uint32_t seg,
+                                   CosmicTsdbSegmentHeader* hdr, const uint8_t** map) {
+    char path[320];
+    _tsdb_segment_path(db, dev_id, seg, path, sizeof(path));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    // Cabeçalho por pread: segmentos fora da janela nem são mapeados
+    uint32_t used = 0;
+    if (pread(fd, hdr, sizeof(*hdr), 0) == (ssize_t)sizeof(*hdr) && _tsdb_header_valid(hdr)) {
+        used = hdr->used;
+    }
+    if (used && map) {
+        *map = NULL;
+        void* m = mmap(NULL, used, PROT_READ, MAP_SHARED, fd, 0);
+        if (m == MAP_FAILED) used = 0;
+        else *map = (const uint8_t*)m;
+    }
+    close(fd);
+    return used;
+}
+
+// =================================================================================
+// API PÚBLICA - ARMAZENAMENTO COLUNAR
+// =================================================================================
+
+/**
+ * @brief cosmic_tsdb_open - Abre (ou cria) o armazenamento em um diretório
+ * @param db Estado do armazenamento
+ * @param dir Diretório raiz
+ * @return COSMIC_TSDB_OK ou código de erro
+ */
+int cosmic_tsdb_open(CosmicTsdb* db, const char* dir) {
+    memset(db, 0, sizeof(*db));
+    if (strlen(dir) >= sizeof(db->dir)) return COSMIC_TSDB_ERR_ARG;
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) return COSMIC_TSDB_ERR_IO;
+    snprintf(db->dir, sizeof(db->dir), "%s", dir);
+
+    db->series = (CosmicTsdbSeries**)calloc(COSMIC_TSDB_MAX_DEVICES, sizeof(CosmicTsdbSeries*));
+    db->raw = (uint8_t*)malloc(COSMIC_TSDB_MAX_RAW);
+    db->packed = (uint8_t*)malloc(COSMIC_TSDB_MAX_RAW + COSMIC_TSDB_MAX_RAW / 16 + 64);   // Pior caso do fastlz
+    db->block_ts = (uint64_t*)malloc(COSMIC_TSDB_BLOCK_SAMPLES * sizeof(uint64_t));
+    db->block_values = (float*)malloc(COSMIC_TSDB_BLOCK_SAMPLES * COSMIC_TSDB_MAX_CHANNELS * sizeof(float));
+    if (!db->series || !db->raw || !db->packed || !db->block_ts || !db->block_values) return COSMIC_TSDB_ERR_IO;
+    return COSMIC_TSDB_OK;
+}
+
+/**
+ * @brief cosmic_tsdb_append - Acrescenta uma amostra (todos os canais) de um dispositivo
+ *
+ * Mudança no número de canais ou salto maior que COSMIC_TSDB_MAX_DELTA_MS
+ * fecha o bloco aberto. Timestamps fora de ordem são aceitos.
+ *
+ * @param db Armazenamento aberto
+ * @param dev_id Dispositivo
+ * @param ts_ms Timestamp em ms
+ * @param values Valores (ex: saída de uppkg)
+ * @param n Número de canais (1..COSMIC_TSDB_MAX_CHANNELS)
+ * @return COSMIC_TSDB_OK ou código de erro
+ */
+int cosmic_tsdb_append(CosmicTsdb* db, uint16_t dev_id, uint64_t ts_ms, const float* values, int n) {
+    if (n < 1 || n > COSMIC_TSDB_MAX_CHANNELS) return COSMIC_TSDB_ERR_ARG;
+    CosmicTsdbSeries* s = _tsdb_series(db, dev_id);
+    if (!s) return COSMIC_TSDB_ERR_IO;
+
+    if (s->count) {
+        uint64_t last = s->ts[s->count - 1];
+        uint64_t gap = ts_ms > last ? ts_ms - last : last - ts_ms;
+        if (n != s->channels || gap >= COSMIC_TSDB_MAX_DELTA_MS || s->count == COSMIC_TSDB_BLOCK_SAMPLES) {
+            int r = _tsdb_flush_series(db, s);
+            if (r != COSMIC_TSDB_OK) return r;
+        }
+    }
+    if (s->count == 0 && n != s->channels) {
+        float* v = (float*)realloc(s->values, (size_t)COSMIC_TSDB_BLOCK_SAMPLES * n * sizeof(float));
+        if (!v) return COSMIC_TSDB_ERR_IO;
+        s->values = v;
+        s->channels = (uint16_t)n;
+    }
+
+    s->ts[s->count] = ts_ms;
+    memcpy(s->values + s->count * n, values, n * sizeof(float));
+    s->count++;
+    if (s->count == COSMIC_TSDB_BLOCK_SAMPLES) return _tsdb_flush_series(db, s);
+    return COSMIC_TSDB_OK;
+}
+
+/**
+ * @brief cosmic_tsdb_flush - Grava os blocos abertos de todos os dispositivos
+ * @return COSMIC_TSDB_OK ou o primeiro código de erro
+ */
+int cosmic_tsdb_flush(CosmicTsdb* db) {
+    int rc = COSMIC_TSDB_OK;
+    for (uint32_t d = 0; d < COSMIC_TSDB_MAX_DEVICES; d++) {
+        CosmicTsdbSeries* s = db->series[d];
+        if (!s) continue;
+        int r = _tsdb_flush_series(db, s);
+        if (r != COSMIC_TSDB_OK && rc == COSMIC_TSDB_OK) rc = r;
+        if (s->map) msync(s->map, ((CosmicTsdbSegmentHeader*)s->map)->used, MS_ASYNC);
+    }
+    return rc;
+}
+
+/**
+ * @brief cosmic_tsdb_close - Grava o que falta, desmapeia e libera tudo
+ * @return COSMIC_TSDB_OK ou código de erro da gravação final
+ */
+int cosmic_tsdb_close(CosmicTsdb* db) {
+    int rc = COSMIC_TSDB_OK;
+    if (db->series) {
+        rc = cosmic_tsdb_flush(db);
+        for (uint32_t d = 0; d < COSMIC_TSDB_MAX_DEVICES; d++) {
+            CosmicTsdbSeries* s = db->series[d];
+            if (!s) continue;
+            _tsdb_unmap_segment(db, s);
+            free(s->values);
+            free(s);
+        }
+    }
+    free(db->series);
+    free(db->raw);
+    free(db->packed);
+    free(db->block_ts);
+    free(db->block_values);
+    memset(db, 0, sizeof(*db));
+    return rc;
+}
+
+/**
+ * @brief cosmic_tsdb_query - Percorre as amostras de um dispositivo em [t0, t1]
+ *
+ * Segmentos são filtrados pelo cabeçalho e blocos pelo diretório; só os
+ * blocos que cruzam a janela são lidos. Amostras ainda no bloco aberto
+ * também entram. A ordem é a de gravação (por bloco), não por timestamp.
+ *
+ * @param db Armazenamento aberto
+ * @param dev_id Dispositivo
+ * @param t0 Início da janela (ms, inclusive)
+ * @param t1 Fim da janela (ms, inclusive)
+ * @param visit Chamada por amostra (pode ser NULL para só contar)
+ * @param user Repassado a visit
+ * @return Número de amostras entregues, ou código de erro (< 0)
+ */
+long cosmic_tsdb_query(CosmicTsdb* db, uint16_t dev_id, uint64_t t0, uint64_t t1,
+                       CosmicTsdbVisitor visit, void* user) {
+    long total = 0;
+    CosmicTsdbSeries* s = db->series[dev_id];
+    uint32_t segments = _tsdb_count_segments(db, dev_id);
+
+    for (uint32_t seg = 0; seg < segments; seg++) {
+        CosmicTsdbSegmentHeader hdr;
+        const uint8_t* map = NULL;
+        bool writing = s && s->map && seg == s->segment;
+        uint32_t used;
+        if (writing) {
+            map = s->map;
+            memcpy(&hdr, map, sizeof(hdr));
+            used = hdr.used;
+        } else {
+            // Primeiro só o cabeçalho; mapeia se a janela cruza o segmento
+            used = _tsdb_map_readonly(db, dev_id, seg, &hdr, NULL);
+            if (!used) return COSMIC_TSDB_ERR_CORRUPT;
+            if (hdr.entries == 0 || hdr.t_max < t0 || hdr.t_min > t1) continue;
+            used = _tsdb_map_readonly(db, dev_id, seg, &hdr, &map);
+            if (!used) return COSMIC_TSDB_ERR_IO;
+        }
+
+        const CosmicTsdbDirEntry* dir = (const CosmicTsdbDirEntry*)(map + sizeof(CosmicTsdbSegmentHeader));
+        int rc = COSMIC_TSDB_OK;
+        for (uint32_t b = 0; b < hdr.entries; b++) {
+            const CosmicTsdbDirEntry* e = &dir[b];
+            if (e->t_max < t0 || e->t_min > t1) continue;
+            if (e->offset < COSMIC_TSDB_DATA_START(hdr.dir_entries) || e->offset + e->size > used ||
+                !_tsdb_decode_block(db, map + e->offset, e->size)) {
+                rc = COSMIC_TSDB_ERR_CORRUPT;
+                break;
+            }
+            CosmicTsdbBlockHeader bh;
+            memcpy(&bh, map + e->offset, sizeof(bh));
+            total += _tsdb_visit(dev_id, db->block_ts, db->block_values, bh.count, bh.channels,
+                                 t0, t1, visit, user);
+        }
+        if (!writing) munmap((void*)map, used);
+        if (rc != COSMIC_TSDB_OK) return rc;
+    }
+
+    if (s && s->count) {
+        total += _tsdb_visit(dev_id, s->ts, s->values, s->count, s->channels, t0, t1, visit, user);
+    }
+    return total;
+}
+
+/**
+ * @brief cosmic_tsdb_info - Resumo do que está gravado para um dispositivo
+ * @return COSMIC_TSDB_OK, ou COSMIC_TSDB_ERR_CORRUPT se um segmento é inválido
+ */
+int cosmic_tsdb_info(CosmicTsdb* db, uint16_t dev_id, CosmicTsdbInfo* info) {
+    memset(info, 0, sizeof(*info));
+    info->t_min = UINT64_MAX;
+    CosmicTsdbSeries* s = db->series[dev_id];
+    info->segments = _tsdb_count_segments(db, dev_id);
+
+    for (uint32_t seg = 0; seg < info->segments; seg++) {
+        CosmicTsdbSegmentHeader hdr;
+        if (s && s->map && seg == s->segment) memcpy(&hdr, s->map, sizeof(hdr));
+        else if (!_tsdb_map_readonly(db, dev_id, seg, &hdr, NULL)) return COSMIC_TSDB_ERR_CORRUPT;
+        info->blocks += hdr.entries;
+        info->samples += hdr.samples;
+        info->bytes += hdr.used;
+        if (hdr.entries && hdr.t_min < info->t_min) info->t_min = hdr.t_min;
+        if (hdr.entries && hdr.t_max > info->t_max) info->t_max = hdr.t_max;
+    }
+    if (s && s->count) {
+        info->samples += s->count;
+        for (int i = 0; i < s->count; i++) {
+            if (s->ts[i] < info->t_min) info->t_min = s->ts[i];
+            if (s->ts[i] > info->t_max) info->t_max = s->ts[i];
+        }
+    }
+    if (info->samples == 0) info->t_min = 0;
+    return COSMIC_TSDB_OK;
+}
+
+/**
+ * @brief cosmic_tsdb_devices - Lista os dispositivos presentes no diretório
+ * @param out Dispositivos encontrados (ordem do diretório)
+ * @param max Capacidade de out
+ * @return Número de dispositivos (pode exceder max)
+ */
+int cosmic_tsdb_devices(const CosmicTsdb* db, uint16_t* out, int max) {
+    DIR* d = opendir(db->dir);
+    if (!d) return 0;
+    int n = 0;
+    struct dirent* e;
+    while ((e = readdir(d)) != NULL) {
+        unsigned dev;
+        if (sscanf(e->d_name, "dev_%5u", &dev) != 1 || dev >= COSMIC_TSDB_MAX_DEVICES) continue;
+        if (n < max) out[n] = (uint16_t)dev;
+        n++;
+    }
+    closedir(d);
+    return n;
+}
+
+#endif // COSMIC_TSDB_H
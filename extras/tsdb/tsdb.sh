@@ -0,0 +1,38 @@
+#!/bin/sh
+# Compila tsdb_tool, grava uma frota sintética (fleet_gen) no armazenamento
+# colunar e mostra tamanho e uma consulta por janela.
+# Uso: extras/tsdb/tsdb.sh [opções do fleet_gen, sem -o/-u]
+#      DB=/tmp/clora-db BIN=/tmp/tsdb extras/tsdb/tsdb.sh -d 100 -n 200000 -e
+# Com o gateway: cosmic_ingestd ... | tsdb_tool ingest -D dir -j -
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+src="$here/../../src"
+host="$here/../host"
+loadgen="$here/../loadgen"
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+bin=${BIN:-$tmp}
+db=${DB:-$tmp/db}
+mkdir -p "$bin"
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+FLAGS="-O2 -DCOSMIC_PROFILE=3"
+
+$CC $FLAGS -c "$src/fastlz.c" -o "$tmp/fastlz.o"
+$CXX $FLAGS -I"$host" -I"$src" -I"$loadgen" "$loadgen/fleet_gen.cpp" "$tmp/fastlz.o" -lm -o "$bin/fleet_gen"
+$CXX $FLAGS -I"$host" -I"$src" -I"$loadgen" -I"$here" "$here/tsdb_tool.cpp" "$tmp/fastlz.o" -lm -o "$bin/tsdb_tool"
+
+ingest_flags=""
+for arg in "$@"; do
+    case "$arg" in
+        -e) ingest_flags="$ingest_flags $arg" ;;
+    esac
+done
+
+"$bin/fleet_gen" "$@" -o "$tmp/capture.bin"
+"$bin/tsdb_tool" ingest -D "$db" -i "$tmp/capture.bin" $ingest_flags
+"$bin/tsdb_tool" info -D "$db" | tail -n 1
+# Primeiras 6 h do dispositivo 1 a partir do início padrão (fleet_gen sorteia o
+# dispositivo de cada quadro: com -d 1000 e passo de 1 s, ~1 amostra a cada 17 min)
+"$bin/tsdb_tool" query -D "$db" -d 1 -f 1700000000000 -u 1700021600000 | head -n 3
@@ -0,0 +1,212 @@
+// Ferramenta do armazenamento colunar (cosmic_tsdb.h).
+//
+//   tsdb_tool ingest -D dir -i captura.bin [-t início_ms] [-s passo_ms] [-e]
+//       Decodifica uma captura de fleet_gen (uppkg) e grava a telemetria;
+//       o quadro k recebe o timestamp início + k * passo.
+//   tsdb_tool ingest -D dir -j leituras.jsonl | -j -
+//       Grava as linhas "telemetry" do cosmic_ingestd (campos ts, dev, values).
+//   tsdb_tool query -D dir -d dev [-f t0] [-u t1]
+//       Imprime CSV "ts,v0,v1,..." da janela [t0, t1] (ms).
+//   tsdb_tool info -D dir
+//       Uma linha JSON por dispositivo e uma de total, com bytes por
+//       amostra comparados a uma linha crua (timestamp u64 + floats).
+//
+// Compilar: ver extras/tsdb/tsdb.sh
+
+#include <stdio.h>
+#include <time.h>
+#include "cosmic_tsdb.h"
+#include "cosmic_capture.h"
+#include "loadgen.h"
+
+static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static int usage() {
+    fprintf(stderr, "uso: tsdb_tool ingest -D dir (-i captura.bin [-t início_ms] [-s passo_ms] [-e] | -j arq.jsonl)\n"
+                    "     tsdb_tool query -D dir -d dev [-f t0] [-u t1]\n"
+                    "     tsdb_tool info -D dir\n");
+    return 2;
+}
+
+/**
+ * @brief Valor numérico de "key" numa linha JSON plana
+ */
+static const char* json_field(const char* line, const char* key) {
+    char pat[32];
+    snprintf(pat, sizeof(pat), "\"%s\":", key);
+    const char* p = strstr(line, pat);
+    return p ? p + strlen(pat) : NULL;
+}
+
+static void report_ingest(const CosmicTsdb* db, unsigned long samples, unsigned long values, uint64_t ns) {
+    double secs = ns / 1e9;
+    fprintf(stderr, "tsdb_tool: %lu amostras (%lu valores) em %.3f s (%.0f amostras/s), %llu blocos, "
+                    "%.2f bytes/valor\n",
+            samples, values, secs, secs > 0 ? samples / secs : 0.0, (unsigned long long)db->blocks_written,
+            values ? (double)db->bytes_stored / values : 0.0);
+}
+
+static int ingest_capture(CosmicTsdb* db, const char* path, uint64_t start, uint64_t step, bool encrypted) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { perror(path); return 1; }
+
+    CosmicCaptureRecord rec;
+    float values[MAX_COSMIC_BUFFER];
+    unsigned long frames = 0, samples = 0, nvalues = 0;
+    uint64_t t = now_ns();
+    int r;
+    while ((r = cosmic_capture_read(f, &rec)) == 1) {
+        uint64_t ts = start + frames++ * step;
+        if (encrypted && !cosmic_decrypt(rec.data, rec.size, FLEET_NET_ID, rec.counter)) continue;
+        CosmicHeader hdr;
+        if (!cosmic_parse_header(rec.data, rec.size, &hdr) || hdr.type != PKG_TYPE_TELEMETRY) continue;
+        int n = uppkg(rec.data, rec.size, values, MAX_COSMIC_BUFFER);
+        if (n <= 0) continue;
+        if (n > COSMIC_TSDB_MAX_CHANNELS) n = COSMIC_TSDB_MAX_CHANNELS;
+        if (cosmic_tsdb_append(db, hdr.dev_id, ts, values, n) != COSMIC_TSDB_OK) {
+            fprintf(stderr, "tsdb_tool: falha ao gravar dev %u\n", hdr.dev_id);
+            fclose(f);
+            return 1;
+        }
+        samples++;
+        nvalues += n;
+    }
+    fclose(f);
+    if (r < 0) fprintf(stderr, "tsdb_tool: captura truncada após %lu quadros\n", frames);
+    int rc = cosmic_tsdb_flush(db);
+    report_ingest(db, samples, nvalues, now_ns() - t);
+    return rc == COSMIC_TSDB_OK ? 0 : 1;
+}
+
+static int ingest_jsonl(CosmicTsdb* db, const char* path) {
+    FILE* f = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!f) { perror(path); return 1; }
+
+    static char line[1 << 16];
+    float values[COSMIC_TSDB_MAX_CHANNELS];
+    unsigned long samples = 0, nvalues = 0;
+    uint64_t t = now_ns();
+    while (fgets(line, sizeof(line), f)) {
+        if (!strstr(line, "\"type\":\"telemetry\"")) continue;
+        const char* ts = json_field(line, "ts");
+        const char* dev = json_field(line, "dev");
+        const char* v = json_field(line, "values");
+        if (!ts || !dev || !v || *v != '[') continue;
+
+        int n = 0;
+        char* p = (char*)v + 1;
+        while (*p && *p != ']' && n < COSMIC_TSDB_MAX_CHANNELS) {
+            values[n++] = strtof(p, &p);
+            if (*p == ',') p++;
+        }
+        if (n == 0) continue;
+        if (cosmic_tsdb_append(db, (uint16_t)strtoul(dev, NULL, 10), strtoull(ts, NULL, 10), values, n)
+            != COSMIC_TSDB_OK) {
+            fprintf(stderr, "tsdb_tool: falha ao gravar\n");
+            return 1;
+        }
+        samples++;
+        nvalues += n;
+    }
+    if (f != stdin) fclose(f);
+    int rc = cosmic_tsdb_flush(db);
+    report_ingest(db, samples, nvalues, now_ns() - t);
+    return rc == COSMIC_TSDB_OK ? 0 : 1;
+}
+
+static void print_csv(void* user, uint16_t dev_id, uint64_t ts, const float* values, int n) {
+    (void)user;
+    (void)dev_id;
+    printf("%llu", (unsigned long long)ts);
+    for (int i = 0; i < n; i++) printf(",%.9g", values[i]);
+    putchar('\n');
+}
+
+static int info(CosmicTsdb* db) {
+    static uint16_t devs[COSMIC_TSDB_MAX_DEVICES];
+    int n = cosmic_tsdb_devices(db, devs, COSMIC_TSDB_MAX_DEVICES);
+    uint64_t samples = 0, bytes = 0, values = 0;
+    for (int i = 0; i < n; i++) {
+        CosmicTsdbInfo in;
+        if (cosmic_tsdb_info(db, devs[i], &in) != COSMIC_TSDB_OK) {
+            fprintf(stderr, "tsdb_tool: segmento inválido em dev %u\n", devs[i]);
+            return 1;
+        }
+        // Canais: lidos da primeira amostra
+        long channels = 0;
+        cosmic_tsdb_query(db, devs[i], in.t_min, in.t_min,
+                          [](void* user, uint16_t, uint64_t, const float*, int c) { *(long*)user = c; },
+                          &channels);
+        printf("{\"dev\":%u,\"segments\":%u,\"blocks\":%u,\"samples\":%llu,\"channels\":%ld,"
+               "\"bytes\":%llu,\"t_min\":%llu,\"t_max\":%llu}\n",
+               devs[i], in.segments, in.blocks, (unsigned long long)in.samples, channels,
+               (unsigned long long)in.bytes, (unsigned long long)in.t_min, (unsigned long long)in.t_max);
+        samples += in.samples;
+        bytes += in.bytes;
+        values += in.samples * channels;
+    }
+    uint64_t row_bytes = samples * 8 + values * 4;
+    printf("{\"devices\":%d,\"samples\":%llu,\"bytes\":%llu,\"row_bytes\":%llu,\"ratio\":%.2f}\n",
+           n, (unsigned long long)samples, (unsigned long long)bytes, (unsigned long long)row_bytes,
+           bytes ? (double)row_bytes / bytes : 0.0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage();
+    const char* cmd = argv[1];
+    const char* dir = NULL;
+    const char* capture = NULL;
+    const char* jsonl = NULL;
+    uint64_t start = 1700000000000ULL, step = 1000, t0 = 0, t1 = UINT64_MAX;
+    long dev = -1;
+    bool encrypted = false;
+
+    int opt;
+    optind = 2;
+    while ((opt = getopt(argc, argv, "D:i:j:t:s:ed:f:u:")) != -1) {
+        switch (opt) {
+            case 'D': dir = optarg; break;
+            case 'i': capture = optarg; break;
+            case 'j': jsonl = optarg; break;
+            case 't': start = strtoull(optarg, NULL, 10); break;
+            case 's': step = strtoull(optarg, NULL, 10); break;
+            case 'e': encrypted = true; break;
+            case 'd': dev = strtol(optarg, NULL, 10); break;
+            case 'f': t0 = strtoull(optarg, NULL, 10); break;
+            case 'u': t1 = strtoull(optarg, NULL, 10); break;
+            default: return usage();
+        }
+    }
+    if (!dir) return usage();
+
+    CosmicTsdb db;
+    if (cosmic_tsdb_open(&db, dir) != COSMIC_TSDB_OK) {
+        fprintf(stderr, "tsdb_tool: não foi possível abrir %s\n", dir);
+        return 1;
+    }
+
+    int rc;
+    if (strcmp(cmd, "ingest") == 0 && (!capture != !jsonl)) {
+        setCosmicKey(FLEET_KEY);
+        if (encrypted) enableEncryption(); else disableEncryption();
+        setCosmicMixedHeaders(true);       // Mesmo formato misto da frota (fleet_gen)
+        rc = capture ? ingest_capture(&db, capture, start, step, encrypted) : ingest_jsonl(&db, jsonl);
+    } else if (strcmp(cmd, "query") == 0 && dev >= 0 && dev < COSMIC_TSDB_MAX_DEVICES) {
+        uint64_t t = now_ns();
+        long n = cosmic_tsdb_query(&db, (uint16_t)dev, t0, t1, print_csv, NULL);
+        if (n < 0) fprintf(stderr, "tsdb_tool: erro %ld na consulta\n", n);
+        else fprintf(stderr, "tsdb_tool: %ld amostras em %.3f ms\n", n, (now_ns() - t) / 1e6);
+        rc = n < 0;
+    } else if (strcmp(cmd, "info") == 0) {
+        rc = info(&db);
+    } else {
+        rc = usage();
+    }
+    if (cosmic_tsdb_close(&db) != COSMIC_TSDB_OK && rc == 0) rc = 1;
+    return rc;
+}
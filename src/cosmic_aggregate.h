@@ -0,0 +1,233 @@
+#ifndef COSMIC_AGGREGATE_H
+#define COSMIC_AGGREGATE_H
+
+#include "cosmic_payload.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+
+// Payload de PKG_TYPE_AGGREGATE (logo após o cabeçalho):
+//   [0] número de registros
+//   [1..] registros (COMPRESS_NONE) ou LZ dos registros (COMPRESS_COSMIC)
+// Registro:
+//   dev_id varint | tipo (nibble alto) | modo (nibble baixo) | tamanho varint | payload
+// O payload de cada registro é o mesmo que viria após o cabeçalho de um
+// pacote individual, então uppkg_payload() decodifica registros de telemetria.
+#define COSMIC_AGG_RECORD_OVERHEAD 4       // Máx de bytes de controle por registro (dev_id 1-3 + tipo/modo)
+#define COSMIC_AGG_MAX_RECORDS     255
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+/**
+ * @brief Agregador de registros (repetidor ou nó que envia em lote)
+ *
+ * Os registros ficam em claro no buffer do agregador; o quadro agregado
+ * inteiro é cifrado uma vez por ppkg_aggregate(), com o contador de quem
+ * transmite.
+ */
+struct CosmicAggregator {
+    uint8_t data[MAX_COSMIC_BUFFER];       // Registros concatenados
+    uint8_t size;                          // Bytes usados em data
+    uint8_t capacity;                      // Limite de registros para caber no MTU
+    uint8_t count;                         // Registros acumulados
+};
+
+/**
+ * @brief Registro extraído de um agregado (aponta para o pacote ou o buffer de trabalho)
+ */
+struct CosmicRecord {
+    uint16_t dev_id;
+    uint8_t type;                          // PKG_TYPE_*
+    uint8_t mode;                          // COMPRESS_*
+    const uint8_t* payload;
+    uint8_t size;
+};
+
+/**
+ * @brief Cursor de leitura sobre os registros de um agregado
+ */
+struct CosmicAggReader {
+    const uint8_t* pos;
+    const uint8_t* end;
+    uint8_t remaining;
+};
+
+// =================================================================================
+// API PÚBLICA - MONTAGEM
+// =================================================================================
+
+/**
+ * @brief Inicializa o agregador
+ * @param agg Agregador
+ * @param mtu Tamanho máximo do quadro no ar (0 ou acima de COSMIC_MAX_PACKET = COSMIC_MAX_PACKET)
+ */
+void cosmic_agg_init(CosmicAggregator* agg, uint8_t mtu) {
+    int limit = (mtu && mtu < COSMIC_MAX_PACKET) ? mtu : COSMIC_MAX_PACKET;
+    limit -= HEADER_MAX_SIZE + 1;
+
+    agg->size = 0;
+    agg->count = 0;
+    agg->capacity = limit > 0 ? (uint8_t)limit : 0;
+}
+
+/**
+ * @brief Indica se um registro com esse payload ainda cabe no quadro
+ */
+bool cosmic_agg_fits(const CosmicAggregator* agg, uint8_t size) {
+    int needed = COSMIC_AGG_RECORD_OVERHEAD + (size < 0x80 ? 1 : 2) + size;
+    return agg->count < COSMIC_AGG_MAX_RECORDS && agg->size + needed <= agg->capacity;
+}
+
+/**
+ * @brief cosmic_agg_add - Acrescenta um registro
+ * @param agg Agregador
+ * @param dev_id Dispositivo de origem
+ * @param type Tipo (PKG_TYPE_*, exceto agregado)
+ * @param mode Modo de compressão do payload (COMPRESS_*, 0-15)
+ * @param payload Payload sem cabeçalho
+ * @param size Tamanho do payload
+ * @return 1 se adicionado, 0 se não cabe (transmitir o agregado e tentar de novo)
+ */
+int cosmic_agg_add(CosmicAggregator* agg, uint16_t dev_id, uint8_t type, uint8_t mode,
+                   const uint8_t* payload, uint8_t size) {
+    if (type == PKG_TYPE_AGGREGATE || mode > 0x0F) return 0;
+    if (!cosmic_agg_fits(agg, size)) return 0;
+
+    uint8_t* out = agg->data + agg->size;
+    int pos = _put_varint(out, dev_id);
+    out[pos++] = (type & 0xF0) | mode;
+    pos += _put_varint(out + pos, size);
+    memcpy(out + pos, payload, size);
+
+    agg->size += pos + size;
+    agg->count++;
+    return 1;
+}
+
+/**
+ * @brief cosmic_agg_add_packet - Acrescenta um pacote recebido (já descriptografado)
+ * @param agg Agregador
+ * @param packet Pacote individual com cabeçalho legado ou compacto
+ * @param packet_size Tamanho do pacote
+ * @return 1 se adicionado, 0 se não cabe ou pacote inválido
+ */
+int cosmic_agg_add_packet(CosmicAggregator* agg, const uint8_t* packet, uint8_t packet_size) {
+    CosmicHeader hdr;
+    if (!cosmic_parse_header(packet, packet_size, &hdr)) return 0;
+    return cosmic_agg_add(agg, hdr.dev_id, hdr.type, hdr.mode,
+                          packet + hdr.length, packet_size - hdr.length);
+}
+
+/**
+ * @brief ppkg_aggregate - Monta o quadro agregado e esvazia o agregador
+ * @param agg Agregador
+ * @param nid Network ID
+ * @param did Device ID de quem transmite (repetidor ou nó)
+ * @param compress true para LZ compartilhado entre os registros (usado só se reduzir)
+ * @return Pacote pronto para transmissão (size 0 se não havia registros)
+ */
+CosmicPacket ppkg_aggregate(CosmicAggregator* agg, uint8_t nid, uint16_t did, bool compress) {
+    if (agg->count == 0) {
+        CosmicPacket empty = { _c_buffer, 0, PKG_TYPE_AGGREGATE, COMPRESS_NONE };
+        return empty;
+    }
+
+    uint8_t mod = COMPRESS_NONE;
+    const uint8_t* body = agg->data;
+    int body_size = agg->size;
+
+    if (compress) {
+        int lz_size = fastlz_compress_level(1, agg->data, agg->size, _work_buffer);
+        if (lz_size > 0 && lz_size < agg->size) {
+            mod = COMPRESS_COSMIC;
+            body = _work_buffer;
+            body_size = lz_size;
+        }
+    }
+
+    uint8_t hlen = _prepare_header(nid, did, PKG_TYPE_AGGREGATE, mod);
+    _c_buffer[hlen] = agg->count;
+    memcpy(_c_buffer + hlen + 1, body, body_size);
+
+    agg->size = 0;
+    agg->count = 0;
+    return _finish_packet(nid, PKG_TYPE_AGGREGATE, mod, hlen + 1 + body_size);
+}
+
+// =================================================================================
+// API PÚBLICA - LEITURA
+// =================================================================================
+
+/**
+ * @brief cosmic_agg_open - Prepara a leitura dos registros de um agregado
+ *
+ * Em COMPRESS_NONE os registros apontam direto para o pacote (sem cópia);
+ * em COMPRESS_COSMIC o bloco é descomprimido uma vez em scratch. O pacote
+ * (ou scratch) deve continuar válido enquanto os registros forem usados.
+ *
+ * @param rd Cursor de leitura
+ * @param packet Pacote agregado (já descriptografado)
+ * @param packet_size Tamanho do pacote
+ * @param scratch Buffer para o bloco descomprimido (pode ser NULL se não comprimido)
+ * @param scratch_size Tamanho de scratch (MAX_COSMIC_BUFFER basta)
+ * @return Número de registros, ou -1 se inválido
+ */
+int cosmic_agg_open(CosmicAggReader* rd, const uint8_t* packet, uint8_t packet_size,
+                    uint8_t* scratch, uint16_t scratch_size) {
+    CosmicHeader hdr;
+    uint8_t hlen = cosmic_parse_header(packet, packet_size, &hdr);
+    if (hlen == 0 || hdr.type != PKG_TYPE_AGGREGATE || packet_size < hlen + 1) return -1;
+
+    const uint8_t* body = packet + hlen + 1;
+    int body_size = packet_size - hlen - 1;
+
+    if (hdr.mode == COMPRESS_COSMIC) {
+        if (!scratch) return -1;
+        body_size = fastlz_decompress(body, body_size, scratch, scratch_size);
+        if (body_size <= 0) return -1;
+        body = scratch;
+    } else if (hdr.mode != COMPRESS_NONE) {
+        return -1;
+    }
+
+    rd->pos = body;
+    rd->end = body + body_size;
+    rd->remaining = packet[hlen];
+    return rd->remaining;
+}
+
+/**
+ * @brief cosmic_agg_next - Próximo registro do agregado
+ * @param rd Cursor aberto por cosmic_agg_open
+ * @param rec Registro (saída; payload aponta para o pacote ou scratch)
+ * @return 1 se há registro, 0 no fim, -1 se o agregado está corrompido
+ */
+int cosmic_agg_next(CosmicAggReader* rd, CosmicRecord* rec) {
+    if (rd->remaining == 0) return 0;
+
+    uint32_t dev, size;
+    int avail = rd->end - rd->pos;
+    int used = _get_varint(rd->pos, avail, &dev);
+    if (used == 0 || dev > 0xFFFF || used >= avail) return -1;
+    uint8_t type_mode = rd->pos[used++];
+
+    int len_used = _get_varint(rd->pos + used, avail - used, &size);
+    if (len_used == 0) return -1;
+    used += len_used;
+    if (size > (uint32_t)(avail - used)) return -1;
+
+    rec->dev_id = (uint16_t)dev;
+    rec->type = type_mode & 0xF0;
+    rec->mode = type_mode & 0x0F;
+    rec->payload = rd->pos + used;
+    rec->size = (uint8_t)size;
+
+    rd->pos += used + size;
+    rd->remaining--;
+    return 1;
+}
+
+#endif // COSMIC_AGGREGATE_H
@@ -0,0 +1,206 @@
+#ifndef COSMIC_AIRTIME_H
+#define COSMIC_AIRTIME_H
+
+#include "cosmic_payload.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+
+#define LORA_CR_4_5 1                   // Coding rate 4/5 .. 4/8
+#define LORA_CR_4_6 2
+#define LORA_CR_4_7 3
+#define LORA_CR_4_8 4
+
+#define LORA_DEFAULT_PREAMBLE 8         // Símbolos de preâmbulo programados
+#define LORA_LDRO_SYMBOL_US 16000       // Low data rate optimize obrigatório acima disso
+
+#define COSMIC_NO_DICT 0xFF             // ppkg_auto: não avaliar modo com dicionário
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+/**
+ * @brief Parâmetros do rádio que definem o tempo no ar
+ */
+struct LoraRadioConfig {
+    uint8_t sf;                 // Spreading factor (6-12)
+    uint32_t bw_hz;             // Largura de banda (125000, 250000, 500000...)
+    uint8_t cr;                 // LORA_CR_4_5 .. LORA_CR_4_8
+    uint16_t preamble;          // Símbolos de preâmbulo
+    bool explicit_header;       // Cabeçalho LoRa explícito
+    bool crc;                   // CRC de payload habilitado
+    bool low_dr_opt;            // Low data rate optimize
+    uint16_t tx_power_mw;       // Potência elétrica consumida em TX (V * I)
+};
+
+/**
+ * @brief Custo estimado de um pacote no ar
+ */
+struct CosmicAirtime {
+    uint8_t mode;               // Modo escolhido (COMPRESS_*)
+    uint8_t size;               // Bytes do pacote
+    uint16_t symbols;           // Símbolos de payload (inclui cabeçalho LoRa)
+    uint32_t airtime_us;        // Tempo total no ar (preâmbulo + payload)
+    uint32_t energy_uj;         // Energia de TX estimada
+};
+
+// =================================================================================
+// API PÚBLICA - TEMPO NO AR
+// =================================================================================
+
+/**
+ * @brief Preenche configuração com valores usuais (preâmbulo 8, header explícito, CRC)
+ * @param cfg Configuração a preencher
+ * @param sf Spreading factor
+ * @param bw_hz Largura de banda em Hz
+ * @param cr Coding rate (LORA_CR_*)
+ * @param tx_power_mw Potência elétrica em TX (0 se energia não interessa)
+ */
+void lora_config_init(LoraRadioConfig* cfg, uint8_t sf, uint32_t bw_hz, uint8_t cr, uint16_t tx_power_mw) {
+    cfg->sf = sf;
+    cfg->bw_hz = bw_hz;
+    cfg->cr = cr;
+    cfg->preamble = LORA_DEFAULT_PREAMBLE;
+    cfg->explicit_header = true;
+    cfg->crc = true;
+    cfg->low_dr_opt = ((1000000UL << sf) / bw_hz) >= LORA_LDRO_SYMBOL_US;
+    cfg->tx_power_mw = tx_power_mw;
+}
+
+/**
+ * @brief Número de símbolos de payload (fórmula do datasheet SX127x)
+ * @param cfg Configuração do rádio
+ * @param len Bytes do pacote
+ * @return Símbolos após o preâmbulo
+ */
+uint16_t lora_payload_symbols(const LoraRadioConfig* cfg, uint8_t len) {
+    int32_t num = 8L * len - 4L * cfg->sf + 28 + (cfg->crc ? 16 : 0) - (cfg->explicit_header ? 0 : 20);
+    int32_t den = 4L * (cfg->sf - (cfg->low_dr_opt ? 2 : 0));
+    int32_t blocks = num > 0 ? (num + den - 1) / den : 0;
+    return (uint16_t)(8 + blocks * (cfg->cr + 4));
+}
+
+/**
+ * @brief Tempo no ar de um pacote
+ * @param cfg Configuração do rádio
+ * @param len Bytes do pacote
+ * @return Tempo em microssegundos
+ */
+uint32_t lora_time_on_air_us(const LoraRadioConfig* cfg, uint8_t len) {
+    // Em quartos de símbolo: preâmbulo + 4.25 de sincronismo + payload
+    uint32_t quarter_symbols = 4UL * cfg->preamble + 17 + 4UL * lora_payload_symbols(cfg, len);
+    return (uint32_t)(((uint64_t)quarter_symbols * (1000000ULL << cfg->sf)) / (4ULL * cfg->bw_hz));
+}
+
+/**
+ * @brief Preenche relatório de custo para um pacote já montado
+ */
+void lora_airtime_report(const LoraRadioConfig* cfg, uint8_t mode, uint8_t len, CosmicAirtime* report) {
+    report->mode = mode;
+    report->size = len;
+    report->symbols = lora_payload_symbols(cfg, len);
+    report->airtime_us = lora_time_on_air_us(cfg, len);
+    report->energy_uj = (uint32_t)(((uint64_t)report->airtime_us * cfg->tx_power_mw) / 1000);
+}
+
+// =================================================================================
+// API PÚBLICA - SELEÇÃO AUTOMÁTICA DE MODO
+// =================================================================================
+
+/**
+ * @brief Monta o candidato indicado (mesmo caminho das funções públicas)
+ */
+static CosmicPacket _auto_build(uint8_t mode, uint8_t nid, uint16_t did, float* pack, int n, uint8_t dict_id) {
+    switch (mode) {
+        case COMPRESS_COSMIC:      return ppkg(true, nid, did, PKG_TYPE_TELEMETRY, COMPRESS_COSMIC, pack, n);
+        case COMPRESS_COSMIC_HUFF: return ppkg_huff(0, nid, did, PKG_TYPE_TELEMETRY, pack, n);
+        case COMPRESS_COSMIC_DICT: return ppkg_dict(dict_id, nid, did, PKG_TYPE_TELEMETRY, pack, n);
+        default:                   return ppkg(false, nid, did, PKG_TYPE_TELEMETRY, COMPRESS_NONE, pack, n);
+    }
+}
+
+/**
+ * @brief Quantos floats o candidato carrega (mesmos limites de ppkg, ppkg_huff e ppkg_dict)
+ */
+static int _auto_capacity(uint8_t mode, uint8_t hlen) {
+    switch (mode) {
+        case COMPRESS_COSMIC:      return (COSMIC_MAX_PACKET - hlen) / 2;
+        case COMPRESS_COSMIC_HUFF: {
+            int max_floats = (COSMIC_MAX_PACKET - HEADER_MAX_SIZE - 2) / 2;
+            return max_floats > 255 ? 255 : max_floats;
+        }
+        case COMPRESS_COSMIC_DICT: return (COSMIC_MAX_PACKET - HEADER_MAX_SIZE - 1) / 2;
+        default:                   return (COSMIC_MAX_PACKET - hlen) / 4;
+    }
+}
+
+/**
+ * @brief ppkg_auto - Escolhe o modo de telemetria com menos símbolos no ar
+ *
+ * Avalia raw, COSMIC (LZ ou int16 cru), Huffman (tabela 0) e, se dict_id
+ * for dado, COSMIC com dicionário. Empates em símbolos ficam com o modo
+ * mais barato de CPU (ordem acima): bytes a menos no mesmo bloco de
+ * símbolos não reduzem o tempo no ar. O modo stream não entra porque
+ * avaliá-lo alteraria o estado do fluxo.
+ *
+ * Só concorrem os modos que carregam os n floats; se nenhum couber, n é
+ * cortado para o maior que couber (COSMIC) e o pacote leva menos leituras.
+ *
+ * @param radio Configuração do rádio
+ * @param nid Network ID
+ * @param did Device ID
+ * @param pack Array de floats
+ * @param n Número de floats
+ * @param dict_id Dicionário registrado, ou COSMIC_NO_DICT
+ * @param report Custo do pacote escolhido (opcional, pode ser NULL)
+ * @return Pacote pronto para transmissão (cifrado uma única vez se habilitado)
+ */
+CosmicPacket ppkg_auto(const LoraRadioConfig* radio, uint8_t nid, uint16_t did, float* pack, int n,
+                       uint8_t dict_id, CosmicAirtime* report) {
+    static const uint8_t candidates[] = {
+        COMPRESS_NONE, COMPRESS_COSMIC, COMPRESS_COSMIC_HUFF, COMPRESS_COSMIC_DICT
+    };
+    uint8_t n_candidates = sizeof(candidates) - (dict_id == COSMIC_NO_DICT ? 1 : 0);
+
+    // Um modo que cortasse n ganharia só por levar menos leituras
+    uint8_t hlen = _header_length(did);
+    int fit = 0;
+    for (uint8_t i = 0; i < n_candidates; i++) {
+        int capacity = _auto_capacity(candidates[i], hlen);
+        if (capacity > fit) fit = capacity;
+    }
+    if (n > fit) n = fit;
+
+    // Avaliação sem cifrar: CTR não muda o tamanho e o contador não pode avançar
+    // (nem a sequência da extensão do cabeçalho); os contadores só veem o escolhido.
+    // A cifra segue habilitada para o cabeçalho ser o mesmo do pacote final.
+    uint8_t seq = _header_seq;
+    COSMIC_STATS_SAVE(stats);
+    _cipher_dry_run = true;
+
+    uint8_t best = COMPRESS_COSMIC;
+    uint16_t best_symbols = 0xFFFF;
+    for (uint8_t i = 0; i < n_candidates; i++) {
+        if (_auto_capacity(candidates[i], hlen) < n) continue;
+        CosmicPacket trial = _auto_build(candidates[i], nid, did, pack, n, dict_id);
+        uint16_t symbols = lora_payload_symbols(radio, trial.size);
+        if (symbols < best_symbols) {
+            best_symbols = symbols;
+            best = candidates[i];
+        }
+    }
+
+    _cipher_dry_run = false;
+    _header_seq = seq;
+    COSMIC_STATS_RESTORE(stats);
+    CosmicPacket pkg = _auto_build(best, nid, did, pack, n, dict_id);
+
+    if (report) {
+        lora_airtime_report(radio, pkg.mode, pkg.size, report);
+    }
+    return pkg;
+}
+
+#endif // COSMIC_AIRTIME_H
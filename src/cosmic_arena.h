@@ -0,0 +1,49 @@
+#ifndef COSMIC_ARENA_H
+#define COSMIC_ARENA_H
+
+#include <stdint.h>
+#include "cosmic_config.h"
+
+// =================================================================================
+// ARENA COMPARTILHADA
+// =================================================================================
+//
+// Telemetria e imagem nunca processam ao mesmo tempo, então seus buffers de
+// trabalho ocupam a mesma memória. _c_buffer (saída) fica fora da arena
+// porque precisa sobreviver até a transmissão.
+
+typedef union {
+    // Fase de telemetria (ppkg*, uppkg)
+    struct {
+        uint8_t work[MAX_COSMIC_BUFFER + LZ_MARGIN];             // Saída do LZ / entrada do decodificador
+        int16_t raw_int[MAX_COSMIC_BUFFER / 2];                  // int16 quantizado + delta
+        uint8_t lz_window[COSMIC_MAX_DICT_SIZE + MAX_COSMIC_BUFFER];  // [dicionário | dados]
+    } tlm;
+
+    // Fase de imagem (img_compress)
+    struct {
+        uint8_t compress[IMG_COMPRESS_BUFFER_SIZE];              // Imagem comprimida
+        uint8_t temp[IMG_TEMP_BUFFER_SIZE];                      // Imagem reduzida (DOWN2)
+    } img;
+} CosmicArena;
+
+static COSMIC_THREAD_LOCAL CosmicArena _cosmic_arena;
+
+// Nomes históricos dos buffers, agora regiões da arena
+#define _work_buffer          (_cosmic_arena.tlm.work)
+#define _raw_int_buffer       (_cosmic_arena.tlm.raw_int)
+#define _lz_window            (_cosmic_arena.tlm.lz_window)
+#define _img_compress_buffer  (_cosmic_arena.img.compress)
+#define _img_temp_buffer      (_cosmic_arena.img.temp)
+
+// =================================================================================
+// RELATÓRIO ESTÁTICO DE RAM (bytes)
+// =================================================================================
+
+#define COSMIC_RAM_TELEMETRY  sizeof(((CosmicArena*)0)->tlm)
+#define COSMIC_RAM_IMAGE      sizeof(((CosmicArena*)0)->img)
+#define COSMIC_RAM_ARENA      sizeof(CosmicArena)
+#define COSMIC_RAM_OUTPUT     MAX_COSMIC_BUFFER
+#define COSMIC_RAM_LZ_HASH    (sizeof(uint16_t) << COSMIC_LZ_HASH_LOG)
+
+#endif // COSMIC_ARENA_H
@@ -0,0 +1,154 @@
+#ifndef COSMIC_CONFIG_H
+#define COSMIC_CONFIG_H
+
+// =================================================================================
+// PERFIS DE MEMÓRIA
+// =================================================================================
+//
+// O perfil define o tamanho de todos os buffers estáticos da biblioteca.
+// Selecione com -DCOSMIC_PROFILE=COSMIC_PROFILE_TINY (build_flags no
+// PlatformIO) ou editando o padrão abaixo. Cada tamanho pode ainda ser
+// sobrescrito individualmente com -D<NOME>=<valor>.
+//
+//   TINY     - AVR/Cortex-M0 com 2-8 KB de RAM (pacotes até 128 B, imagens 8x8)
+//   STANDARD - nós LoRa típicos (pacotes até 255 B, limite do campo size)
+//   GATEWAY  - gateway/host, buffers originais da biblioteca (512 B)
+//
+// O padrão é STANDARD. Antes dos perfis os buffers tinham sempre 512 B;
+// quem dependia disso deve selecionar COSMIC_PROFILE_GATEWAY.
+//
+// Picos de RAM estática por perfil: ver COSMIC_RAM_* em cosmic_arena.h e
+// extras/ram_report.
+
+#define COSMIC_PROFILE_TINY     1
+#define COSMIC_PROFILE_STANDARD 2
+#define COSMIC_PROFILE_GATEWAY  3
+
+#ifndef COSMIC_PROFILE
+#define COSMIC_PROFILE COSMIC_PROFILE_STANDARD
+#endif
+
+#if COSMIC_PROFILE == COSMIC_PROFILE_TINY
+  #define COSMIC_DEFAULT_BUFFER     128
+  #define COSMIC_DEFAULT_IMAGE_SIDE 8
+  #define COSMIC_DEFAULT_DICT_SIZE  64
+  #define COSMIC_DEFAULT_DICTS      1
+  #define COSMIC_DEFAULT_HUFF       1
+  #define COSMIC_DEFAULT_HASH_LOG   8
+  #define COSMIC_DEFAULT_DEDUP      16
+  #define COSMIC_DEFAULT_TXQ        2
+  #define COSMIC_DEFAULT_RING       2
+  #define COSMIC_DEFAULT_CACHE_LINE 4
+  #define COSMIC_DEFAULT_KS_PACKETS 1
+  #define COSMIC_DEFAULT_KS_BYTES   64
+#elif COSMIC_PROFILE == COSMIC_PROFILE_STANDARD
+  #define COSMIC_DEFAULT_BUFFER     255
+  #define COSMIC_DEFAULT_IMAGE_SIDE 16
+  #define COSMIC_DEFAULT_DICT_SIZE  128
+  #define COSMIC_DEFAULT_DICTS      2
+  #define COSMIC_DEFAULT_HUFF       2
+  #define COSMIC_DEFAULT_HASH_LOG   10
+  #define COSMIC_DEFAULT_DEDUP      64
+  #define COSMIC_DEFAULT_TXQ        4
+  #define COSMIC_DEFAULT_RING       4
+  #define COSMIC_DEFAULT_CACHE_LINE 32
+  #define COSMIC_DEFAULT_KS_PACKETS 2
+  #define COSMIC_DEFAULT_KS_BYTES   128
+#elif COSMIC_PROFILE == COSMIC_PROFILE_GATEWAY
+  #define COSMIC_DEFAULT_BUFFER     512
+  #define COSMIC_DEFAULT_IMAGE_SIDE 16
+  #define COSMIC_DEFAULT_DICT_SIZE  256
+  #define COSMIC_DEFAULT_DICTS      4
+  #define COSMIC_DEFAULT_HUFF       4
+  #define COSMIC_DEFAULT_HASH_LOG   13
+  #define COSMIC_DEFAULT_DEDUP      1024
+  #define COSMIC_DEFAULT_TXQ        16
+  #define COSMIC_DEFAULT_RING       64
+  #define COSMIC_DEFAULT_CACHE_LINE 64
+  #define COSMIC_DEFAULT_KS_PACKETS 4
+  #define COSMIC_DEFAULT_KS_BYTES   256
+#else
+  #error "COSMIC_PROFILE inválido"
+#endif
+
+// =================================================================================
+// TAMANHOS (sobrescrevíveis)
+// =================================================================================
+
+// Pacotes
+#ifndef MAX_COSMIC_BUFFER
+#define MAX_COSMIC_BUFFER COSMIC_DEFAULT_BUFFER
+#endif
+#define LZ_MARGIN (MAX_COSMIC_BUFFER / 32 + 1)  // Expansão máx do LZ em dados incompressíveis
+// Maior pacote montado: CosmicPacket.size e o payload LoRa são uint8_t
+#define COSMIC_MAX_PACKET (MAX_COSMIC_BUFFER < 255 ? MAX_COSMIC_BUFFER : 255)
+
+// Imagens
+#ifndef MAX_IMAGE_SIDE
+#define MAX_IMAGE_SIDE COSMIC_DEFAULT_IMAGE_SIDE
+#endif
+#ifndef MAX_IMAGE_SIZE
+#define MAX_IMAGE_SIZE (MAX_IMAGE_SIDE * MAX_IMAGE_SIDE)
+#endif
+#if COSMIC_PROFILE == COSMIC_PROFILE_GATEWAY
+  #define IMG_COMPRESS_BUFFER_SIZE 1024
+  #define IMG_TEMP_BUFFER_SIZE     1024
+#else
+  // Pior caso do RLE (2 bytes por pixel) + cabeçalho da imagem
+  #define IMG_COMPRESS_BUFFER_SIZE (2 * MAX_IMAGE_SIZE + 3)
+  #define IMG_TEMP_BUFFER_SIZE     MAX_IMAGE_SIZE
+#endif
+
+// Dicionários LZ pré-carregados (treinados com extras/dict_trainer)
+#ifndef COSMIC_MAX_DICTS
+#define COSMIC_MAX_DICTS COSMIC_DEFAULT_DICTS
+#endif
+#ifndef COSMIC_MAX_DICT_SIZE
+#define COSMIC_MAX_DICT_SIZE COSMIC_DEFAULT_DICT_SIZE
+#endif
+
+// Tabelas Huffman para resíduos (ID 0 = tabela padrão embutida)
+#ifndef COSMIC_MAX_HUFF_TABLES
+#define COSMIC_MAX_HUFF_TABLES COSMIC_DEFAULT_HUFF
+#endif
+
+// Tabela hash do FastLZ (2 bytes por entrada)
+#ifndef COSMIC_LZ_HASH_LOG
+#define COSMIC_LZ_HASH_LOG COSMIC_DEFAULT_HASH_LOG
+#endif
+
+// Cache de duplicatas do repetidor/gateway (8 bytes por entrada, múltiplo de 4)
+#ifndef COSMIC_DEDUP_ENTRIES
+#define COSMIC_DEDUP_ENTRIES COSMIC_DEFAULT_DEDUP
+#endif
+
+// Fila de transmissão (um pacote de MAX_COSMIC_BUFFER por posição)
+#ifndef COSMIC_TXQ_SLOTS
+#define COSMIC_TXQ_SLOTS COSMIC_DEFAULT_TXQ
+#endif
+
+// Anéis de quadros recebidos (potência de 2) e alinhamento dos índices
+#ifndef COSMIC_RING_SLOTS
+#define COSMIC_RING_SLOTS COSMIC_DEFAULT_RING
+#endif
+#ifndef COSMIC_CACHE_LINE
+#define COSMIC_CACHE_LINE COSMIC_DEFAULT_CACHE_LINE
+#endif
+
+// Keystream AES-CTR pré-calculado para os próximos contadores (0 desativa).
+// Bytes por pacote múltiplo de 16; o excedente é gerado na hora.
+#ifndef COSMIC_KS_CACHE_PACKETS
+#define COSMIC_KS_CACHE_PACKETS COSMIC_DEFAULT_KS_PACKETS
+#endif
+#ifndef COSMIC_KS_CACHE_BYTES
+#define COSMIC_KS_CACHE_BYTES COSMIC_DEFAULT_KS_BYTES
+#endif
+
+// Buffers de trabalho (arena e _c_buffer) por thread: gateway Linux com
+// vários threads decodificando (-DCOSMIC_THREAD_LOCAL=thread_local).
+// Vazio no MCU, onde só há um contexto de montagem.
+#ifndef COSMIC_THREAD_LOCAL
+#define COSMIC_THREAD_LOCAL
+#endif
+
+#endif // COSMIC_CONFIG_H
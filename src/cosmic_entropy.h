@@ -0,0 +1,243 @@
+#ifndef COSMIC_ENTROPY_H
+#define COSMIC_ENTROPY_H
+
+#include <stdint.h>
+#include <string.h>
+
+// =================================================================================
+// DEFINIÇÕES
+// =================================================================================
+
+// Alfabeto: resíduos zigzag 0..14 têm código próprio; 15 = escape + 16 bits crus
+#define COSMIC_HUFF_SYMBOLS  16
+#define COSMIC_HUFF_ESCAPE   15
+#define COSMIC_HUFF_MAX_LEN  12            // Comprimento máx de código
+#define COSMIC_HUFF_LUT_BITS 10            // Janela da tabela de decodificação rápida
+#define COSMIC_HUFF_LUT_SYMS 3             // Símbolos máx por entrada da tabela rápida
+
+// Tabela padrão (ID 0): Huffman de uma distribuição geométrica (a = 0.7),
+// adequada para resíduos de sensores lentos. Tabelas por rede são geradas
+// pelo extras/dict_trainer/train_dict.py --huffman.
+static const uint8_t cosmic_huff_default_lengths[COSMIC_HUFF_SYMBOLS] = {
+    2, 2, 3, 3, 4, 4, 5, 5, 6, 7, 7, 7, 8, 9, 9, 6
+};
+
+// Entrada da tabela de decodificação rápida (vários símbolos por consulta)
+typedef struct {
+    uint8_t nsym;                          // 0 = código maior que a janela
+    uint8_t sym[COSMIC_HUFF_LUT_SYMS];
+    uint8_t cum[COSMIC_HUFF_LUT_SYMS];     // Bits consumidos até cada símbolo
+} CosmicHuffLutEntry;
+
+typedef struct {
+    CosmicHuffLutEntry e[1 << COSMIC_HUFF_LUT_BITS];
+} CosmicHuffLut;
+
+// Tabela canônica (códigos derivados apenas dos comprimentos)
+typedef struct {
+    uint8_t id;
+    uint8_t len[COSMIC_HUFF_SYMBOLS];
+    uint16_t code[COSMIC_HUFF_SYMBOLS];
+    uint8_t count[COSMIC_HUFF_MAX_LEN + 1];   // Códigos por comprimento
+    uint8_t sorted[COSMIC_HUFF_SYMBOLS];      // Símbolos em ordem canônica
+    const CosmicHuffLut* lut;                 // Opcional (gateway)
+} CosmicHuffTable;
+
+// ---------------------------------------------------------------------------------
+// Funções internas
+// ---------------------------------------------------------------------------------
+
+/**
+ * @brief Leitor de bits MSB primeiro; além do fim lê zeros
+ */
+typedef struct {
+    const uint8_t* data;
+    uint16_t size;
+    uint32_t pos;                          // Posição em bits
+} _HuffBitReader;
+
+static inline uint32_t _huff_peek(const _HuffBitReader* br, uint8_t nbits) {
+    uint32_t v = 0;
+    uint32_t byte = br->pos >> 3;
+    // Carrega 4 bytes a partir do byte atual (zeros após o fim)
+    for (uint8_t i = 0; i < 4; i++) {
+        v = (v << 8) | (byte + i < br->size ? br->data[byte + i] : 0);
+    }
+    v <<= (br->pos & 7);
+    return v >> (32 - nbits);
+}
+
+/**
+ * @brief Decodifica um símbolo pelo método canônico (sem tabela auxiliar)
+ * @return Símbolo, ou -1 se código inválido
+ */
+static inline int _huff_decode_symbol(const CosmicHuffTable* t, _HuffBitReader* br) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (uint8_t l = 1; l <= COSMIC_HUFF_MAX_LEN; l++) {
+        code |= (int)_huff_peek(br, l) & 1;
+        int count = t->count[l];
+        if (code - first < count) {
+            br->pos += l;
+            return t->sorted[index + (code - first)];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------------------------------
+// Funções públicas
+// ---------------------------------------------------------------------------------
+
+/**
+ * @brief Constrói tabela canônica a partir dos comprimentos de código
+ * @return 1 se sucesso, 0 se comprimentos inválidos (Kraft > 1 ou > MAX_LEN)
+ */
+static inline int cosmic_huff_build(CosmicHuffTable* t, uint8_t id, const uint8_t* lengths) {
+    memset(t, 0, sizeof(*t));
+    t->id = id;
+
+    uint32_t kraft = 0;
+    for (uint8_t s = 0; s < COSMIC_HUFF_SYMBOLS; s++) {
+        uint8_t l = lengths[s];
+        if (l == 0 || l > COSMIC_HUFF_MAX_LEN) return 0;
+        t->len[s] = l;
+        t->count[l]++;
+        kraft += 1UL << (COSMIC_HUFF_MAX_LEN - l);
+    }
+    if (kraft > (1UL << COSMIC_HUFF_MAX_LEN)) return 0;
+
+    // Códigos canônicos: ordenados por (comprimento, símbolo)
+    uint16_t next[COSMIC_HUFF_MAX_LEN + 1];
+    uint16_t code = 0;
+    for (uint8_t l = 1; l <= COSMIC_HUFF_MAX_LEN; l++) {
+        code = (code + t->count[l - 1]) << 1;
+        next[l] = code;
+    }
+    uint8_t idx = 0;
+    for (uint8_t l = 1; l <= COSMIC_HUFF_MAX_LEN; l++) {
+        for (uint8_t s = 0; s < COSMIC_HUFF_SYMBOLS; s++) {
+            if (t->len[s] == l) {
+                t->code[s] = next[l]++;
+                t->sorted[idx++] = s;
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Gera tabela de decodificação multi-símbolo (uso no gateway, ~7 KB)
+ */
+static inline void cosmic_huff_build_lut(const CosmicHuffTable* t, CosmicHuffLut* lut) {
+    for (uint32_t i = 0; i < (1UL << COSMIC_HUFF_LUT_BITS); i++) {
+        CosmicHuffLutEntry* e = &lut->e[i];
+        uint8_t window[2] = { (uint8_t)(i >> (COSMIC_HUFF_LUT_BITS - 8)),
+                              (uint8_t)(i << (16 - COSMIC_HUFF_LUT_BITS)) };
+        _HuffBitReader br = { window, 2, 0 };
+        e->nsym = 0;
+
+        while (e->nsym < COSMIC_HUFF_LUT_SYMS) {
+            uint32_t start = br.pos;
+            int s = _huff_decode_symbol(t, &br);
+            if (s < 0 || br.pos > COSMIC_HUFF_LUT_BITS) {
+                br.pos = start;
+                break;
+            }
+            e->sym[e->nsym] = (uint8_t)s;
+            e->cum[e->nsym] = (uint8_t)br.pos;
+            e->nsym++;
+            if (s == COSMIC_HUFF_ESCAPE) break;   // Bits crus a seguir
+        }
+    }
+}
+
+/**
+ * @brief Codifica valores zigzag com a tabela
+ * @param t Tabela
+ * @param zz Resíduos em zigzag
+ * @param n Número de valores
+ * @param output Buffer de saída
+ * @param max_out Tamanho do buffer
+ * @return Bytes escritos, ou 0 se não couber
+ */
+static inline uint16_t cosmic_huff_encode(const CosmicHuffTable* t, const uint16_t* zz, uint16_t n,
+                                          uint8_t* output, uint16_t max_out) {
+    uint32_t acc = 0;
+    uint8_t bits = 0;
+    uint16_t out_idx = 0;
+
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t s = zz[i] < COSMIC_HUFF_ESCAPE ? zz[i] : COSMIC_HUFF_ESCAPE;
+        acc = (acc << t->len[s]) | t->code[s];
+        bits += t->len[s];
+        if (s == COSMIC_HUFF_ESCAPE) {
+            // Esvazia antes para caber os 16 bits crus no acumulador
+            while (bits >= 8) {
+                if (out_idx >= max_out) return 0;
+                output[out_idx++] = (uint8_t)(acc >> (bits - 8));
+                bits -= 8;
+            }
+            acc = (acc << 16) | zz[i];
+            bits += 16;
+        }
+        while (bits >= 8) {
+            if (out_idx >= max_out) return 0;
+            output[out_idx++] = (uint8_t)(acc >> (bits - 8));
+            bits -= 8;
+        }
+    }
+    if (bits > 0) {
+        if (out_idx >= max_out) return 0;
+        output[out_idx++] = (uint8_t)(acc << (8 - bits));
+    }
+    return out_idx;
+}
+
+/**
+ * @brief Decodifica n valores zigzag (usa a tabela rápida se anexada)
+ * @return 1 se sucesso, 0 se fluxo inválido ou truncado
+ */
+static inline int cosmic_huff_decode(const CosmicHuffTable* t, const uint8_t* input, uint16_t size,
+                                     uint16_t* zz, uint16_t n) {
+    _HuffBitReader br = { input, size, 0 };
+    uint32_t limit = (uint32_t)size * 8;
+    uint16_t i = 0;
+
+    while (i < n) {
+        int s = -1;
+        if (t->lut) {
+            const CosmicHuffLutEntry* e = &t->lut->e[_huff_peek(&br, COSMIC_HUFF_LUT_BITS)];
+            uint8_t k = 0;
+            uint8_t used = 0;
+            while (k < e->nsym && i < n) {
+                s = e->sym[k];
+                used = e->cum[k];
+                k++;
+                if (s == COSMIC_HUFF_ESCAPE) break;
+                zz[i++] = (uint16_t)s;
+            }
+            br.pos += used;
+            if (k == 0) s = _huff_decode_symbol(t, &br);
+            else if (s != COSMIC_HUFF_ESCAPE) s = -2;   // Já emitidos
+        } else {
+            s = _huff_decode_symbol(t, &br);
+        }
+
+        if (s == -1 || br.pos > limit) return 0;
+        if (s == COSMIC_HUFF_ESCAPE) {
+            if (br.pos + 16 > limit) return 0;
+            zz[i++] = (uint16_t)_huff_peek(&br, 16);
+            br.pos += 16;
+        } else if (s >= 0) {
+            zz[i++] = (uint16_t)s;
+        }
+    }
+    return 1;
+}
+
+#endif // COSMIC_ENTROPY_H
@@ -0,0 +1,624 @@
+#ifndef COSMIC_EXPORT_H
+#define COSMIC_EXPORT_H
+
+#include "cosmic_payload.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+//
+// Serializadores para dashboards, gravando direto num buffer do chamador
+// (sem alocação por registro). Um registro por chamada:
+//
+//   JSON (uma linha por registro, NDJSON):
+//     {"dev":42,"ts":1700000000000,"values":[21.5,-3.25]}
+//     {"dev":42,"ts":1700000000000,"w":16,"h":16,"pixels":"<base64>"}
+//   MessagePack (mapa por registro, concatenados):
+//     {"dev":uint,"ts":uint,"values":[float32...]}
+//     {"dev":uint,"ts":uint,"w":uint,"h":uint,"pixels":bin}
+//   InfluxDB line protocol (timestamp em ns):
+//     clora,dev=42 v0=21.5,v1=-3.25 1700000000000000000
+//     clora_image,dev=42 w=16i,h=16i,pixels="<base64>" 1700000000000000000
+//
+// ts é o timestamp do gateway em ms. Floats usam a menor representação
+// decimal que volta ao mesmo float (cosmic_ftoa, algoritmo Ryu para
+// float32). NaN e infinito viram null no JSON e são omitidos no Influx.
+//
+// Se o registro não cabe no espaço livre, nada é gravado e a função
+// retorna 0: o chamador envia/esvazia o buffer (cosmic_export_reset) e
+// repete. As tabelas do Ryu ocupam ~630 bytes (RAM em AVR sem PROGMEM);
+// o alvo é o gateway.
+
+#ifndef COSMIC_EXPORT_MEASUREMENT
+#define COSMIC_EXPORT_MEASUREMENT "clora"     // Measurement do Influx (imagens: <measurement>_image)
+#endif
+
+#define COSMIC_FTOA_MAX 24                     // Maior saída de cosmic_ftoa, com '\0'
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+/**
+ * @brief Buffer de saída reutilizável
+ */
+struct CosmicExportBuffer {
+    uint8_t* data;
+    uint32_t size;                         // Capacidade
+    uint32_t len;                          // Bytes já gravados
+    bool overflow;                         // Registro atual não coube
+};
+
+int cosmic_ftoa(float v, char* out);
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+// Ryu (Ulf Adams, 2018) para float32: 5^-q e 5^i com 59 e 61 bits
+#define _RYU_POW5_INV_BITCOUNT 59
+#define _RYU_POW5_BITCOUNT     61
+
+static const uint64_t _ryu_pow5_inv_split[31] = {
+    576460752303423489ULL, 461168601842738791ULL, 368934881474191033ULL,
+    295147905179352826ULL, 472236648286964522ULL, 377789318629571618ULL,
+    302231454903657294ULL, 483570327845851670ULL, 386856262276681336ULL,
+    309485009821345069ULL, 495176015714152110ULL, 396140812571321688ULL,
+    316912650057057351ULL, 507060240091291761ULL, 405648192073033409ULL,
+    324518553658426727ULL, 519229685853482763ULL, 415383748682786211ULL,
+    332306998946228969ULL, 531691198313966350ULL, 425352958651173080ULL,
+    340282366920938464ULL, 544451787073501542ULL, 435561429658801234ULL,
+    348449143727040987ULL, 557518629963265579ULL, 446014903970612463ULL,
+    356811923176489971ULL, 570899077082383953ULL, 456719261665907162ULL,
+    365375409332725730ULL
+};
+
+static const uint64_t _ryu_pow5_split[48] = {
+    1152921504606846976ULL, 1441151880758558720ULL, 1801439850948198400ULL,
+    2251799813685248000ULL, 1407374883553280000ULL, 1759218604441600000ULL,
+    2199023255552000000ULL, 1374389534720000000ULL, 1717986918400000000ULL,
+    2147483648000000000ULL, 1342177280000000000ULL, 1677721600000000000ULL,
+    2097152000000000000ULL, 1310720000000000000ULL, 1638400000000000000ULL,
+    2048000000000000000ULL, 1280000000000000000ULL, 1600000000000000000ULL,
+    2000000000000000000ULL, 1250000000000000000ULL, 1562500000000000000ULL,
+    1953125000000000000ULL, 1220703125000000000ULL, 1525878906250000000ULL,
+    1907348632812500000ULL, 1192092895507812500ULL, 1490116119384765625ULL,
+    1862645149230957031ULL, 1164153218269348144ULL, 1455191522836685180ULL,
+    1818989403545856475ULL, 2273736754432320594ULL, 1421085471520200371ULL,
+    1776356839400250464ULL, 2220446049250313080ULL, 1387778780781445675ULL,
+    1734723475976807094ULL, 2168404344971008868ULL, 1355252715606880542ULL,
+    1694065894508600678ULL, 2117582368135750847ULL, 1323488980084844279ULL,
+    1654361225106055349ULL, 2067951531382569187ULL, 1292469707114105741ULL,
+    1615587133892632177ULL, 2019483917365790221ULL, 1262177448353618888ULL
+};
+
+static inline int32_t _ryu_pow5bits(int32_t e) {
+    return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+static inline uint32_t _ryu_log10_pow2(int32_t e) {
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+static inline uint32_t _ryu_log10_pow5(int32_t e) {
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+static inline bool _ryu_multiple_of_pow5(uint32_t v, uint32_t p) {
+    uint32_t count = 0;
+    while (v % 5 == 0 && count < p) {
+        v /= 5;
+        count++;
+    }
+    return count >= p;
+}
+
+static inline uint32_t _ryu_mul_shift(uint32_t m, uint64_t factor, int32_t shift) {
+    uint64_t lo = (uint64_t)m * (uint32_t)factor;
+    uint64_t hi = (uint64_t)m * (uint32_t)(factor >> 32);
+    return (uint32_t)(((lo >> 32) + hi) >> (shift - 32));
+}
+
+/**
+ * @brief Menor decimal (mantissa * 10^exp) que volta ao mesmo float (finito)
+ */
+static void _ryu_f2d(uint32_t ieee_mantissa, uint32_t ieee_exponent, uint32_t* mantissa, int32_t* exponent) {
+    int32_t e2;
+    uint32_t m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - 127 - 23 - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (int32_t)ieee_exponent - 127 - 23 - 2;
+        m2 = (1u << 23) | ieee_mantissa;
+    }
+    bool accept_bounds = (m2 & 1) == 0;
+
+    // Intervalo que arredonda para o float: [mm, mp] em torno de mv (escala 4x)
+    uint32_t mv = 4 * m2;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+    uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vm_trailing_zeros = false, vr_trailing_zeros = false;
+    uint8_t last_removed = 0;
+
+    if (e2 >= 0) {
+        uint32_t q = _ryu_log10_pow2(e2);
+        e10 = (int32_t)q;
+        int32_t k = _RYU_POW5_INV_BITCOUNT + _ryu_pow5bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+        vr = _ryu_mul_shift(mv, _ryu_pow5_inv_split[q], i);
+        vp = _ryu_mul_shift(mp, _ryu_pow5_inv_split[q], i);
+        vm = _ryu_mul_shift(mm, _ryu_pow5_inv_split[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            int32_t l = _RYU_POW5_INV_BITCOUNT + _ryu_pow5bits((int32_t)q - 1) - 1;
+            last_removed = (uint8_t)(_ryu_mul_shift(mv, _ryu_pow5_inv_split[q - 1], -e2 + (int32_t)q - 1 + l) % 10);
+        }
+        if (q <= 9) {
+            if (mv % 5 == 0) vr_trailing_zeros = _ryu_multiple_of_pow5(mv, q);
+            else if (accept_bounds) vm_trailing_zeros = _ryu_multiple_of_pow5(mm, q);
+            else vp -= _ryu_multiple_of_pow5(mp, q);
+        }
+    } else {
+        uint32_t q = _ryu_log10_pow5(-e2);
+        e10 = (int32_t)q + e2;
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = _ryu_pow5bits(i) - _RYU_POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+        vr = _ryu_mul_shift(mv, _ryu_pow5_split[i], j);
+        vp = _ryu_mul_shift(mp, _ryu_pow5_split[i], j);
+        vm = _ryu_mul_shift(mm, _ryu_pow5_split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t)q - 1 - (_ryu_pow5bits(i + 1) - _RYU_POW5_BITCOUNT);
+            last_removed = (uint8_t)(_ryu_mul_shift(mv, _ryu_pow5_split[i + 1], j) % 10);
+        }
+        if (q <= 1) {
+            vr_trailing_zeros = true;
+            if (accept_bounds) vm_trailing_zeros = mm_shift == 1;
+            else vp--;
+        } else if (q < 31) {
+            vr_trailing_zeros = (mv & ((1u << (q - 1)) - 1)) == 0;
+        }
+    }
+
+    // Remove dígitos enquanto o intervalo ainda contém um decimal mais curto
+    int32_t removed = 0;
+    uint32_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = (uint8_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = (uint8_t)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) last_removed = 4;   // Empate: par
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    } else {
+        while (vp / 10 > vm / 10) {
+            last_removed = (uint8_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || last_removed >= 5);
+    }
+    *mantissa = output;
+    *exponent = e10 + removed;
+}
+
+static inline int _cosmic_decimal_length(uint32_t v) {
+    int n = 1;
+    while (v >= 10) {
+        v /= 10;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Inteiro sem sinal em decimal
+ * @return Caracteres escritos (máx. 20)
+ */
+static inline int _cosmic_utoa(uint64_t v, char* out) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    for (int i = 0; i < n; i++) out[i] = tmp[n - 1 - i];
+    return n;
+}
+
+static inline void _export_put(CosmicExportBuffer* b, const void* src, uint32_t n) {
+    if (b->overflow || b->size - b->len < n) {
+        b->overflow = true;
+        return;
+    }
+    memcpy(b->data + b->len, src, n);
+    b->len += n;
+}
+
+static inline void _export_str(CosmicExportBuffer* b, const char* s) {
+    _export_put(b, s, (uint32_t)strlen(s));
+}
+
+static inline void _export_byte(CosmicExportBuffer* b, uint8_t c) {
+    _export_put(b, &c, 1);
+}
+
+static inline void _export_uint(CosmicExportBuffer* b, uint64_t v) {
+    char tmp[20];
+    _export_put(b, tmp, (uint32_t)_cosmic_utoa(v, tmp));
+}
+
+static inline void _export_float(CosmicExportBuffer* b, float v) {
+    char tmp[COSMIC_FTOA_MAX];
+    _export_put(b, tmp, (uint32_t)cosmic_ftoa(v, tmp));
+}
+
+static const char _cosmic_b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static void _export_base64(CosmicExportBuffer* b, const uint8_t* in, uint32_t size) {
+    uint32_t need = 4 * ((size + 2) / 3);
+    if (b->overflow || b->size - b->len < need) {
+        b->overflow = true;
+        return;
+    }
+    uint8_t* o = b->data + b->len;
+    uint32_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2];
+        *o++ = _cosmic_b64[v >> 18];
+        *o++ = _cosmic_b64[(v >> 12) & 63];
+        *o++ = _cosmic_b64[(v >> 6) & 63];
+        *o++ = _cosmic_b64[v & 63];
+    }
+    if (i < size) {
+        uint32_t v = (uint32_t)in[i] << 16 | (i + 1 < size ? (uint32_t)in[i + 1] << 8 : 0);
+        *o++ = _cosmic_b64[v >> 18];
+        *o++ = _cosmic_b64[(v >> 12) & 63];
+        *o++ = i + 1 < size ? _cosmic_b64[(v >> 6) & 63] : '=';
+        *o++ = '=';
+    }
+    b->len += need;
+}
+
+/**
+ * @brief MessagePack: inteiro sem sinal no menor formato
+ */
+static void _msgpack_uint(CosmicExportBuffer* b, uint64_t v) {
+    uint8_t tmp[9];
+    uint32_t n;
+    if (v < 0x80) {
+        tmp[0] = (uint8_t)v;
+        n = 1;
+    } else if (v <= 0xFF) {
+        tmp[0] = 0xCC;
+        tmp[1] = (uint8_t)v;
+        n = 2;
+    } else if (v <= 0xFFFF) {
+        tmp[0] = 0xCD;
+        n = 3;
+    } else if (v <= 0xFFFFFFFFULL) {
+        tmp[0] = 0xCE;
+        n = 5;
+    } else {
+        tmp[0] = 0xCF;
+        n = 9;
+    }
+    for (uint32_t i = 1; n > 2 && i < n; i++) tmp[i] = (uint8_t)(v >> (8 * (n - 1 - i)));   // Big-endian
+    _export_put(b, tmp, n);
+}
+
+/**
+ * @brief MessagePack: chave curta (fixstr)
+ */
+static inline void _msgpack_key(CosmicExportBuffer* b, const char* key) {
+    uint8_t len = (uint8_t)strlen(key);
+    _export_byte(b, (uint8_t)(0xA0 | len));
+    _export_put(b, key, len);
+}
+
+static inline void _msgpack_float(CosmicExportBuffer* b, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    uint8_t tmp[5] = { 0xCA, (uint8_t)(bits >> 24), (uint8_t)(bits >> 16), (uint8_t)(bits >> 8), (uint8_t)bits };
+    _export_put(b, tmp, sizeof(tmp));
+}
+
+static inline bool _cosmic_finite(float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return ((bits >> 23) & 0xFF) != 0xFF;
+}
+
+/**
+ * @brief Início de um registro: zera o estado de estouro e marca a posição
+ */
+static inline uint32_t _export_begin(CosmicExportBuffer* b) {
+    b->overflow = false;
+    return b->len;
+}
+
+/**
+ * @brief Fim de um registro: desfaz tudo se algo não coube
+ * @return 1 se gravado, 0 se não coube
+ */
+static inline int _export_end(CosmicExportBuffer* b, uint32_t mark) {
+    if (!b->overflow) return 1;
+    b->len = mark;
+    return 0;
+}
+
+// =================================================================================
+// API PÚBLICA - EXPORTAÇÃO
+// =================================================================================
+
+/**
+ * @brief cosmic_ftoa - Float para a menor decimal que volta ao mesmo float
+ *
+ * Notação simples enquanto o ponto decimal fica a até 6 zeros do número
+ * (0.000001 a 999999999999999), senão científica (1.5e-7, 3.4028235e38).
+ * Válido como número em JSON e no line protocol.
+ *
+ * @param v Valor
+ * @param out Saída com pelo menos COSMIC_FTOA_MAX bytes (terminada em '\0')
+ * @return Caracteres escritos (sem o '\0'); "nan", "inf" ou "-inf" para não finitos
+ */
+int cosmic_ftoa(float v, char* out) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    uint32_t ieee_mantissa = bits & 0x7FFFFF;
+    uint32_t ieee_exponent = (bits >> 23) & 0xFF;
+    int pos = 0;
+
+    if (ieee_exponent == 0xFF) {
+        const char* s = ieee_mantissa ? "nan" : (bits >> 31) ? "-inf" : "inf";
+        strcpy(out, s);
+        return (int)strlen(s);
+    }
+    if (bits >> 31) out[pos++] = '-';
+    if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        out[pos++] = '0';
+        out[pos] = '\0';
+        return pos;
+    }
+
+    uint32_t m;
+    int32_t e;
+    _ryu_f2d(ieee_mantissa, ieee_exponent, &m, &e);
+
+    char digits[10];
+    int n = _cosmic_decimal_length(m);
+    for (int i = n - 1; i >= 0; i--) {
+        digits[i] = (char)('0' + m % 10);
+        m /= 10;
+    }
+
+    int point = n + e;                     // Posição do ponto decimal relativa aos dígitos
+    if (point > 0 && point <= 15) {
+        if (point >= n) {
+            // Inteiro: dígitos e zeros
+            memcpy(out + pos, digits, n);
+            pos += n;
+            for (int i = n; i < point; i++) out[pos++] = '0';
+        } else {
+            memcpy(out + pos, digits, point);
+            pos += point;
+            out[pos++] = '.';
+            memcpy(out + pos, digits + point, n - point);
+            pos += n - point;
+        }
+    } else if (point <= 0 && point > -6) {
+        out[pos++] = '0';
+        out[pos++] = '.';
+        for (int i = point; i < 0; i++) out[pos++] = '0';
+        memcpy(out + pos, digits, n);
+        pos += n;
+    } else {
+        out[pos++] = digits[0];
+        if (n > 1) {
+            out[pos++] = '.';
+            memcpy(out + pos, digits + 1, n - 1);
+            pos += n - 1;
+        }
+        int exp10 = point - 1;
+        out[pos++] = 'e';
+        if (exp10 < 0) {
+            out[pos++] = '-';
+            exp10 = -exp10;
+        }
+        pos += _cosmic_utoa((uint64_t)exp10, out + pos);
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+/**
+ * @brief cosmic_export_init - Associa um buffer do chamador
+ * @param b Buffer de exportação
+ * @param data Memória de saída
+ * @param size Tamanho de data
+ */
+void cosmic_export_init(CosmicExportBuffer* b, void* data, uint32_t size) {
+    b->data = (uint8_t*)data;
+    b->size = size;
+    b->len = 0;
+    b->overflow = false;
+}
+
+/**
+ * @brief cosmic_export_reset - Esvazia o buffer (após enviar b->data[0..len))
+ */
+void cosmic_export_reset(CosmicExportBuffer* b) {
+    b->len = 0;
+    b->overflow = false;
+}
+
+/**
+ * @brief cosmic_export_json - Telemetria como uma linha JSON
+ * @param b Buffer de saída
+ * @param dev_id Dispositivo
+ * @param ts_ms Timestamp (ms)
+ * @param values Valores (ex: saída de uppkg)
+ * @param n Número de valores
+ * @return 1 se gravado, 0 se não coube (buffer inalterado)
+ */
+int cosmic_export_json(CosmicExportBuffer* b, uint16_t dev_id, uint64_t ts_ms, const float* values, int n) {
+    uint32_t mark = _export_begin(b);
+    _export_str(b, "{\"dev\":");
+    _export_uint(b, dev_id);
+    _export_str(b, ",\"ts\":");
+    _export_uint(b, ts_ms);
+    _export_str(b, ",\"values\":[");
+    for (int i = 0; i < n; i++) {
+        if (i) _export_byte(b, ',');
+        if (_cosmic_finite(values[i])) _export_float(b, values[i]);
+        else _export_str(b, "null");
+    }
+    _export_str(b, "]}\n");
+    return _export_end(b, mark);
+}
+
+/**
+ * @brief cosmic_export_json_image - Imagem (pixels em base64) como uma linha JSON
+ * @return 1 se gravado, 0 se não coube
+ */
+int cosmic_export_json_image(CosmicExportBuffer* b, uint16_t dev_id, uint64_t ts_ms,
+                             const uint8_t* pixels, uint8_t width, uint8_t height) {
+    uint32_t mark = _export_begin(b);
+    _export_str(b, "{\"dev\":");
+    _export_uint(b, dev_id);
+    _export_str(b, ",\"ts\":");
+    _export_uint(b, ts_ms);
+    _export_str(b, ",\"w\":");
+    _export_uint(b, width);
+    _export_str(b, ",\"h\":");
+    _export_uint(b, height);
+    _export_str(b, ",\"pixels\":\"");
+    _export_base64(b, pixels, (uint32_t)width * height);
+    _export_str(b, "\"}\n");
+    return _export_end(b, mark);
+}
+
+/**
+ * @brief cosmic_export_msgpack - Telemetria como mapa MessagePack (valores float32)
+ * @return 1 se gravado, 0 se não coube
+ */
+int cosmic_export_msgpack(CosmicExportBuffer* b, uint16_t dev_id, uint64_t ts_ms, const float* values, int n) {
+    uint32_t mark = _export_begin(b);
+    _export_byte(b, 0x83);                 // fixmap, 3 pares
+    _msgpack_key(b, "dev");
+    _msgpack_uint(b, dev_id);
+    _msgpack_key(b, "ts");
+    _msgpack_uint(b, ts_ms);
+    _msgpack_key(b, "values");
+    if (n < 16) {
+        _export_byte(b, (uint8_t)(0x90 | n));
+    } else {
+        uint8_t hdr[3] = { 0xDC, (uint8_t)(n >> 8), (uint8_t)n };
+        _export_put(b, hdr, sizeof(hdr));
+    }
+    for (int i = 0; i < n; i++) _msgpack_float(b, values[i]);
+    return _export_end(b, mark);
+}
+
+/**
+ * @brief cosmic_export_msgpack_image - Imagem como mapa MessagePack (pixels em bin)
+ * @return 1 se gravado, 0 se não coube
+ */
+int cosmic_export_msgpack_image(CosmicExportBuffer* b, uint16_t dev_id, uint64_t ts_ms,
+                                const uint8_t* pixels, uint8_t width, uint8_t height) {
+    uint32_t size = (uint32_t)width * height;
+    uint32_t mark = _export_begin(b);
+    _export_byte(b, 0x85);                 // fixmap, 5 pares
+    _msgpack_key(b, "dev");
+    _msgpack_uint(b, dev_id);
+    _msgpack_key(b, "ts");
+    _msgpack_uint(b, ts_ms);
+    _msgpack_key(b, "w");
+    _msgpack_uint(b, width);
+    _msgpack_key(b, "h");
+    _msgpack_uint(b, height);
+    _msgpack_key(b, "pixels");
+    if (size < 256) {
+        uint8_t hdr[2] = { 0xC4, (uint8_t)size };
+        _export_put(b, hdr, sizeof(hdr));
+    } else {
+        uint8_t hdr[3] = { 0xC5, (uint8_t)(size >> 8), (uint8_t)size };
+        _export_put(b, hdr, sizeof(hdr));
+    }
+    _export_put(b, pixels, size);
+    return _export_end(b, mark);
+}
+
+/**
+ * @brief cosmic_export_influx - Telemetria no line protocol (campos v0, v1, ...)
+ *
+ * Valores não finitos são omitidos; sem nenhum campo válido o registro
+ * é descartado (retorna 1 sem gravar), já que o Influx exige um campo.
+ *
+ * @return 1 se gravado (ou descartado), 0 se não coube
+ */
+int cosmic_export_influx(CosmicExportBuffer* b, uint16_t dev_id, uint64_t ts_ms, const float* values, int n) {
+    uint32_t mark = _export_begin(b);
+    _export_str(b, COSMIC_EXPORT_MEASUREMENT ",dev=");
+    _export_uint(b, dev_id);
+    int fields = 0;
+    for (int i = 0; i < n; i++) {
+        if (!_cosmic_finite(values[i])) continue;
+        _export_str(b, fields++ ? ",v" : " v");
+        _export_uint(b, (uint64_t)i);
+        _export_byte(b, '=');
+        _export_float(b, values[i]);
+    }
+    if (fields == 0) {
+        b->len = mark;
+        return 1;
+    }
+    _export_byte(b, ' ');
+    _export_uint(b, ts_ms * 1000000ULL);
+    _export_byte(b, '\n');
+    return _export_end(b, mark);
+}
+
+/**
+ * @brief cosmic_export_influx_image - Imagem no line protocol (pixels em base64 num campo string)
+ * @return 1 se gravado, 0 se não coube
+ */
+int cosmic_export_influx_image(CosmicExportBuffer* b, uint16_t dev_id, uint64_t ts_ms,
+                               const uint8_t* pixels, uint8_t width, uint8_t height) {
+    uint32_t mark = _export_begin(b);
+    _export_str(b, COSMIC_EXPORT_MEASUREMENT "_image,dev=");
+    _export_uint(b, dev_id);
+    _export_str(b, " w=");
+    _export_uint(b, width);
+    _export_str(b, "i,h=");
+    _export_uint(b, height);
+    _export_str(b, "i,pixels=\"");
+    _export_base64(b, pixels, (uint32_t)width * height);
+    _export_str(b, "\" ");
+    _export_uint(b, ts_ms * 1000000ULL);
+    _export_byte(b, '\n');
+    return _export_end(b, mark);
+}
+
+#endif // COSMIC_EXPORT_H
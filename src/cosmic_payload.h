@@ -2,24 +2,54 @@
 #define COSMIC_PAYLOAD_H
 
 #include <Arduino.h>
+#include "cosmic_config.h"   // Perfil de memória e tamanhos dos buffers
+#include "cosmic_arena.h"    // Arena compartilhada dos buffers de trabalho
 #include "fastlz.h" 
 #include "mini_aes.h" 
 #include "img_compress.h"  // Nova biblioteca de compressão de imagem
+#include "cosmic_entropy.h"  // Codificação de entropia (Huffman estático)
+#include "cosmic_stats.h"    // Contadores e tempos por estágio (opcional, -DCOSMIC_STATS)
 
 // =================================================================================
 // CONFIGURAÇÕES
 // =================================================================================
 
-// Tamanhos dos buffers
-#define MAX_COSMIC_BUFFER 512          // Aumentado para suportar imagens
-#define HEADER_SIZE 4                  // Tamanho do cabeçalho (não alterar)
-#define MAX_IMAGE_SIZE 256             // Máx 256 pixels (ex: 16x16)
+// Tamanhos dos buffers: MAX_COSMIC_BUFFER, MAX_IMAGE_SIZE etc. vêm do perfil (cosmic_config.h)
+#define HEADER_SIZE 4                  // Tamanho do cabeçalho legado (não alterar)
+#define HEADER_MAX_SIZE 8              // Maior cabeçalho compacto (com rede, extensão e dev_id de 3 bytes)
+
+// Cabeçalho compacto:
+//   [0] 111 (marcador) | F_NET | F_EXT | versão (3 bits, 0)
+//   [1] tipo (nibble alto de PKG_TYPE_*) | modo (COMPRESS_*, 0-15)
+//   [net_id] se F_NET | [ext][seq] se F_EXT | dev_id varint (1-3 bytes)
+// No formato legado o byte 0 é o net_id: redes 0xE0-0xFF usam sempre o compacto
+#define HDR_COMPACT_MARKER 0xE0
+#define HDR_MARKER_MASK    0xE0
+#define HDR_FLAG_NET       0x10
+#define HDR_FLAG_EXT       0x08
+#define HDR_VERSION_MASK   0x07
+
+// Extensão (F_EXT): retransmissão por repetidores
+//   ext: bits 0-3 TTL restante | bits 4-7 saltos já feitos
+//   seq: sequência do nó, distingue leituras idênticas no cache de duplicatas
+#define RELAY_TTL_MASK     0x0F
+#define RELAY_HOPS_SHIFT   4
+
+// Quantização COSMIC: valores transmitidos em centésimos (x100)
+#define COSMIC_QUANT_SCALE 100
+
+// Multiplicador Q(shift) para ppkg_i16/ppkg_i32: valor físico por contagem -> centésimos.
+// Com argumentos constantes o compilador resolve a conta; nada de float em tempo de execução.
+// Ex: ADC 12 bits em 3.3 V -> COSMIC_FIXED_MUL(3.3 / 4096, 12)
+#define COSMIC_FIXED_MUL(units_per_count, shift) \
+    ((int32_t)((units_per_count) * COSMIC_QUANT_SCALE * (1L << (shift)) + 0.5))
 
 // Tipos de pacote
 #define PKG_TYPE_TELEMETRY 0x10        // Telemetria (floats)
 #define PKG_TYPE_IMAGE     0x20        // Imagem (8-bit grayscale)
 #define PKG_TYPE_COMMAND   0x30        // Comandos/controle
 #define PKG_TYPE_STATUS    0x40        // Status do dispositivo
+#define PKG_TYPE_AGGREGATE 0x50        // Vários registros em um quadro (cosmic_aggregate.h)
 
 // Modos de compressão
 #define COMPRESS_NONE      0x00        // Sem compressão
@@ -27,20 +57,41 @@
 #define COMPRESS_IMG_RLE   0x02        // Imagem: Run-Length Encoding
 #define COMPRESS_IMG_BLOCK 0x03        // Imagem: Compressão por blocos
 #define COMPRESS_IMG_DOWN2 0x04        // Imagem: Downsample 2:1
+#define COMPRESS_STREAM    0x05        // Telemetria: delta temporal entre pacotes (cosmic_stream.h)
+#define COMPRESS_COSMIC_DICT 0x06      // COSMIC com dicionário LZ pré-carregado
+#define COMPRESS_COSMIC_HUFF 0x07      // COSMIC com Huffman estático nos resíduos
+#define COMPRESS_COSMIC_RAW16 0x08     // COSMIC sem LZ (int16 delta cru, quando o LZ não reduz)
+#define COMPRESS_COSMIC_VARINT 0x09    // COSMIC com resíduos zigzag varint (cosmic_writer.h)
+#define COMPRESS_IMG_PROG  0x0A        // Imagem progressiva: base + refinos + ROI (cosmic_progressive.h)
 
 // =================================================================================
 // BUFFERS INTERNOS
 // =================================================================================
 
-// Buffers para processamento geral
-static uint8_t _c_buffer[MAX_COSMIC_BUFFER];      // Buffer Final (Header + Payload)
-static uint8_t _work_buffer[MAX_COSMIC_BUFFER];   // Buffer Temporário de Trabalho
+// Buffer Final (Header + Payload); fica fora da arena até a transmissão
+static COSMIC_THREAD_LOCAL uint8_t _c_buffer[MAX_COSMIC_BUFFER];
 
-// Buffer para conversão int16 (usado na compressão COSMIC)
-static int16_t _raw_int_buffer[MAX_COSMIC_BUFFER / 2]; 
+// _work_buffer, _raw_int_buffer e _lz_window são regiões de _cosmic_arena (cosmic_arena.h)
 
-// Buffer para processamento de imagem
-static uint8_t _img_buffer[MAX_IMAGE_SIZE];       // Buffer para imagens
+// =================================================================================
+// ESTADO DO CABEÇALHO
+// =================================================================================
+
+static bool _header_compact = false;              // Formato dos pacotes gerados
+static bool _header_with_net = true;              // Compacto: inclui net_id
+static uint8_t _header_ttl = 0;                   // Compacto: TTL de retransmissão (0 = sem extensão)
+static uint8_t _header_seq = 0;                   // Compacto: próximo byte de sequência da extensão
+static bool _header_mixed = false;                // Formato misto: receptor decide pelo marcador (opt-in)
+static uint8_t _c_header_len = HEADER_SIZE;       // Tamanho do cabeçalho em _c_buffer
+static uint8_t _c_mode_pos = 3;                   // Posição do modo em _c_buffer
+
+// Layout do cabeçalho compacto por flags (F_NET, F_EXT): offsets de net, ext e dev_id
+static const uint8_t _hdr_layout[4][3] = {
+    { 0xFF, 0xFF, 2 },     // sem rede, sem extensão
+    { 0xFF, 2,    4 },     // extensão
+    { 2,    0xFF, 3 },     // rede
+    { 2,    3,    5 },     // rede + extensão
+};
 
 // =================================================================================
 // ESTADO DA CRIPTOGRAFIA
@@ -49,11 +100,36 @@ static uint8_t _img_buffer[MAX_IMAGE_SIZE];       // Buffer para imagens
 static uint8_t _cosmic_key[16] = {0};
 static bool _encryption_enabled = false;
 static uint32_t _packet_counter = 0;              // Contador de pacotes para IV único
+static bool _cipher_dry_run = false;              // ppkg_auto: candidatos sem cifrar nem avançar o contador
+
+#if COSMIC_KS_CACHE_PACKETS > 0
+#if COSMIC_KS_CACHE_BYTES % 16 || COSMIC_KS_CACHE_BYTES > 255 * 16
+#error "COSMIC_KS_CACHE_BYTES deve ser múltiplo de 16"
+#endif
+
+// Keystream do contador c fica na posição c % COSMIC_KS_CACHE_PACKETS
+struct CosmicKsEntry {
+    uint32_t counter;
+    uint8_t net_id;
+    uint8_t blocks;                               // Blocos de 16 bytes já calculados (0 = vazio)
+    uint8_t ks[COSMIC_KS_CACHE_BYTES];
+};
+static CosmicKsEntry _ks_cache[COSMIC_KS_CACHE_PACKETS];
+#endif
 
 // =================================================================================
 // ESTRUTURAS DE DADOS
 // =================================================================================
 
+/**
+ * @brief Dicionário LZ pré-carregado (mesmo conteúdo no nó e no gateway)
+ */
+struct CosmicDict {
+    const uint8_t* data;   // Conteúdo (memória endereçável; em AVR, copiar da flash antes)
+    uint16_t size;
+    uint8_t id;
+};
+
 /**
  * @brief Pacote COSMIC genérico
  */
@@ -64,6 +140,22 @@ struct CosmicPacket {
     uint8_t mode;
 };
 
+/**
+ * @brief Cabeçalho decodificado (legado ou compacto)
+ */
+struct CosmicHeader {
+    uint8_t net_id;        // 0 se omitido no cabeçalho compacto
+    uint16_t dev_id;
+    uint8_t type;
+    uint8_t mode;
+    uint8_t ext;           // Byte de extensão (0 se ausente)
+    uint8_t seq;           // Sequência da extensão (0 se ausente)
+    uint8_t length;        // Bytes de cabeçalho; o payload começa aqui
+    bool compact;
+    bool has_net;
+    bool has_ext;
+};
+
 /**
  * @brief Pacote de imagem especializado
  */
@@ -75,18 +167,62 @@ struct CosmicImagePacket {
     uint8_t compress_mode;
 };
 
+// =================================================================================
+// ESTADO DOS DICIONÁRIOS
+// =================================================================================
+
+static CosmicDict _cosmic_dicts[COSMIC_MAX_DICTS];
+static uint8_t _cosmic_dict_count = 0;
+
+static CosmicHuffTable _cosmic_huff_tables[COSMIC_MAX_HUFF_TABLES];
+static uint8_t _cosmic_huff_count = 0;
+
 // =================================================================================
 // FUNÇÕES INTERNAS
 // =================================================================================
 
 /**
- * @brief Prepara o cabeçalho do pacote
+ * @brief Codifica inteiro com sinal em zigzag (valores próximos de zero -> códigos pequenos)
+ */
+static inline uint32_t _zigzag_encode(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+/**
+ * @brief Decodifica inteiro zigzag
+ */
+static inline int32_t _zigzag_decode(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/**
+ * @brief Escreve inteiro sem sinal como varint (7 bits por byte, LSB primeiro)
+ * @return Número de bytes escritos
  */
-static void _prepare_header(uint8_t net_id, uint8_t dev_id, uint8_t pkg_type, uint8_t mod) {
-    _c_buffer[0] = net_id;
-    _c_buffer[1] = dev_id;
-    _c_buffer[2] = pkg_type;
-    _c_buffer[3] = mod;
+static inline int _put_varint(uint8_t* out, uint32_t v) {
+    int len = 0;
+    while (v >= 0x80) {
+        out[len++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[len++] = (uint8_t)v;
+    return len;
+}
+
+/**
+ * @brief Lê varint
+ * @return Número de bytes consumidos, ou 0 se truncado/inválido
+ */
+static inline int _get_varint(const uint8_t* in, int avail, uint32_t* v) {
+    uint32_t result = 0;
+    for (int i = 0; i < avail && i < 5; i++) {
+        result |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if (!(in[i] & 0x80)) {
+            *v = result;
+            return i + 1;
+        }
+    }
+    return 0;
 }
 
 /**
@@ -95,7 +231,7 @@ static void _prepare_header(uint8_t net_id, uint8_t dev_id, uint8_t pkg_type, ui
  * @param net_id Network ID
  * @param counter Contador de pacotes (evita reutilização)
  */
-static void _prepare_iv(uint8_t iv[16], uint8_t net_id, uint32_t counter) {
+static void _build_iv(uint8_t iv[16], uint8_t net_id, uint32_t counter) {
     memset(iv, 0, 16);
     iv[0] = net_id;                    // Byte 0: Network ID
     
@@ -104,8 +240,262 @@ static void _prepare_iv(uint8_t iv[16], uint8_t net_id, uint32_t counter) {
     iv[13] = (counter >> 16) & 0xFF;
     iv[14] = (counter >> 8) & 0xFF;
     iv[15] = counter & 0xFF;
-    
-    _packet_counter++;                 // Incrementa para próximo pacote
+}
+
+/**
+ * @brief Bloco b do keystream do pacote (mesma sequência de maes_ctr_process)
+ */
+static void _ks_block(uint8_t out[16], uint8_t net_id, uint32_t counter, uint16_t b) {
+    _build_iv(out, net_id, counter);
+    out[15] ^= (b & 0xFF);
+    out[14] ^= ((b >> 8) & 0xFF);
+    maes_encrypt_block(out, _cosmic_key);
+}
+
+/**
+ * @brief O byte 0 de um cabeçalho legado pareceria o marcador compacto?
+ *
+ * Em claro o byte 0 é o próprio net_id: as redes 0xE0-0xFF seriam lidas
+ * como cabeçalho compacto, então sempre saem com ele. No formato misto
+ * (setCosmicMixedHeaders) o receptor decide pelo marcador se o cabeçalho
+ * veio em claro (compacto) ou cifrado (legado); nesses casos (1 pacote
+ * em 8) o pacote também sai com o cabeçalho compacto. O bloco calculado
+ * fica no cache de keystream.
+ */
+static bool _legacy_looks_compact(uint8_t net_id) {
+    if ((net_id & HDR_MARKER_MASK) == HDR_COMPACT_MARKER) return true;
+    if (!_encryption_enabled || !_header_mixed) return false;
+
+#if COSMIC_KS_CACHE_PACKETS > 0
+    CosmicKsEntry* entry = &_ks_cache[_packet_counter % COSMIC_KS_CACHE_PACKETS];
+    if (!entry->blocks || entry->counter != _packet_counter || entry->net_id != net_id) {
+        entry->counter = _packet_counter;
+        entry->net_id = net_id;
+        _ks_block(entry->ks, net_id, _packet_counter, 0);
+        entry->blocks = 1;
+    }
+    uint8_t ks0 = entry->ks[0];
+#else
+    uint8_t ks[16];
+    _ks_block(ks, net_id, _packet_counter, 0);
+    uint8_t ks0 = ks[0];
+#endif
+    return ((net_id ^ ks0) & HDR_MARKER_MASK) == HDR_COMPACT_MARKER;
+}
+
+/**
+ * @brief Tamanho do cabeçalho que _prepare_header escreveria para esse dev_id
+ */
+static inline uint8_t _header_length(uint16_t dev_id) {
+    if (!_header_compact && dev_id <= 0xFF) return HEADER_SIZE;
+    return 2 + (_header_with_net ? 1 : 0) + (_header_ttl ? 2 : 0) +
+           (dev_id < 0x80 ? 1 : (dev_id < 0x4000 ? 2 : 3));
+}
+
+/**
+ * @brief Prepara o cabeçalho do pacote (legado ou compacto, conforme setCosmicHeaderFormat)
+ * @return Tamanho do cabeçalho escrito em _c_buffer
+ */
+static uint8_t _prepare_header(uint8_t net_id, uint16_t dev_id, uint8_t pkg_type, uint8_t mod) {
+    // dev_id acima de 255 só cabe no cabeçalho compacto
+    bool legacy = !_header_compact && dev_id <= 0xFF;
+    if (legacy && !_legacy_looks_compact(net_id)) {
+        _c_buffer[0] = net_id;
+        _c_buffer[1] = (uint8_t)dev_id;
+        _c_buffer[2] = pkg_type;
+        _c_buffer[3] = mod;
+        _c_mode_pos = 3;
+        _c_header_len = HEADER_SIZE;
+        return _c_header_len;
+    }
+
+    // No lugar do legado: sem rede nem TTL, nunca maior que HEADER_SIZE
+    bool with_net = _header_with_net && !legacy;
+    uint8_t ttl = legacy ? 0 : _header_ttl;
+
+    uint8_t pos = 0;
+    _c_buffer[pos++] = HDR_COMPACT_MARKER | (with_net ? HDR_FLAG_NET : 0) | (ttl ? HDR_FLAG_EXT : 0);
+    _c_buffer[pos++] = (pkg_type & 0xF0) | (mod & 0x0F);
+    if (with_net) _c_buffer[pos++] = net_id;
+    if (ttl) {
+        _c_buffer[pos++] = ttl;                           // Saltos = 0
+        _c_buffer[pos++] = _header_seq++;
+    }
+    pos += _put_varint(_c_buffer + pos, dev_id);
+
+    _c_mode_pos = 1;
+    _c_header_len = pos;
+    return _c_header_len;
+}
+
+/**
+ * @brief Troca o modo no cabeçalho já escrito (ex: fallback para COMPRESS_COSMIC_RAW16)
+ */
+static void _set_header_mode(uint8_t mod) {
+    if (_c_mode_pos == 1) {
+        _c_buffer[1] = (_c_buffer[1] & 0xF0) | (mod & 0x0F);
+    } else {
+        _c_buffer[_c_mode_pos] = mod;
+    }
+}
+
+/**
+ * @brief Bytes iniciais de _c_buffer que não são cifrados
+ *
+ * Com setCosmicHeaderFormat(true, ...) o cabeçalho vai em claro para que
+ * repetidores leiam/atualizem o TTL sem a chave; o legado vai cifrado como
+ * sempre, inclusive quando cai no compacto (dev_id > 255). No formato
+ * misto todo cabeçalho compacto vai em claro e o receptor decide pelo
+ * marcador (cosmic_decrypt).
+ */
+static inline uint8_t _c_clear_len() {
+    return _c_mode_pos == 1 && (_header_compact || _header_mixed) ? _c_header_len : 0;
+}
+
+/**
+ * @brief Quantiza um float para centésimos (precisão simples)
+ */
+static inline int16_t _quantize(float v) {
+    return (int16_t)(v * (float)COSMIC_QUANT_SCALE);
+}
+
+/**
+ * @brief Satura para a faixa int16
+ */
+static inline int16_t _saturate_i16(int32_t v) {
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+/**
+ * @brief Converte contagem int16 em centésimos: (raw * mul) >> shift, arredondado
+ * @note |mul| deve caber em 16 bits para o produto não estourar 32 bits
+ */
+static inline int16_t _quantize_fixed16(int16_t raw, int32_t mul, uint8_t shift) {
+    int32_t v = (int32_t)raw * mul;
+    if (shift) v = (v + ((int32_t)1 << (shift - 1))) >> shift;
+    return _saturate_i16(v);
+}
+
+/**
+ * @brief Converte contagem int32 em centésimos (produto em 64 bits)
+ */
+static inline int16_t _quantize_fixed32(int32_t raw, int32_t mul, uint8_t shift) {
+    int64_t v = (int64_t)raw * mul;
+    if (shift) v = (v + ((int64_t)1 << (shift - 1))) >> shift;
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+/**
+ * @brief Quantiza (x100) e aplica delta nos floats, gravando em _raw_int_buffer
+ */
+static void _quantize_delta(const float* pack, int n) {
+    int16_t prev = 0;
+    for (int i = 0; i < n; i++) {
+        int16_t q = _quantize(pack[i]);
+        _raw_int_buffer[i] = (int16_t)(q - prev);
+        prev = q;
+    }
+}
+
+/**
+ * @brief Versão inteira de _quantize_delta para contagens int16 (sem ponto flutuante)
+ */
+static void _quantize_delta_i16(const int16_t* raw, int n, int32_t mul, uint8_t shift) {
+    int16_t prev = 0;
+    for (int i = 0; i < n; i++) {
+        int16_t q = _quantize_fixed16(raw[i], mul, shift);
+        _raw_int_buffer[i] = (int16_t)(q - prev);
+        prev = q;
+    }
+}
+
+/**
+ * @brief Versão inteira de _quantize_delta para contagens int32 (sem ponto flutuante)
+ */
+static void _quantize_delta_i32(const int32_t* raw, int n, int32_t mul, uint8_t shift) {
+    int16_t prev = 0;
+    for (int i = 0; i < n; i++) {
+        int16_t q = _quantize_fixed32(raw[i], mul, shift);
+        _raw_int_buffer[i] = (int16_t)(q - prev);
+        prev = q;
+    }
+}
+
+/**
+ * @brief Desfaz delta (em inteiro, mesma aritmética módulo 2^16 do codificador) e quantização
+ */
+static void _dequantize_delta(const int16_t* int_data, int n, float* output) {
+    int16_t cumulative = 0;
+    for (int i = 0; i < n; i++) {
+        cumulative = (int16_t)(cumulative + int_data[i]);
+        output[i] = cumulative / (float)COSMIC_QUANT_SCALE;
+    }
+}
+
+/**
+ * @brief Procura dicionário registrado pelo ID
+ * @return Ponteiro para o dicionário, ou NULL se não registrado
+ */
+static const CosmicDict* _find_dict(uint8_t id) {
+    for (uint8_t i = 0; i < _cosmic_dict_count; i++) {
+        if (_cosmic_dicts[i].id == id) return &_cosmic_dicts[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Registra (ou substitui) tabela Huffman construída a partir dos comprimentos
+ * @return Tabela registrada, ou NULL se tabela cheia ou comprimentos inválidos
+ */
+static CosmicHuffTable* _add_huff_table(uint8_t id, const uint8_t* lengths) {
+    CosmicHuffTable* slot = NULL;
+    for (uint8_t i = 0; i < _cosmic_huff_count; i++) {
+        if (_cosmic_huff_tables[i].id == id) slot = &_cosmic_huff_tables[i];
+    }
+    if (!slot) {
+        if (_cosmic_huff_count >= COSMIC_MAX_HUFF_TABLES) return NULL;
+        slot = &_cosmic_huff_tables[_cosmic_huff_count];
+        if (!cosmic_huff_build(slot, id, lengths)) return NULL;
+        _cosmic_huff_count++;
+        return slot;
+    }
+    return cosmic_huff_build(slot, id, lengths) ? slot : NULL;
+}
+
+/**
+ * @brief Procura tabela Huffman pelo ID (a tabela padrão, ID 0, é criada sob demanda)
+ */
+static CosmicHuffTable* _find_huff_table(uint8_t id) {
+    for (uint8_t i = 0; i < _cosmic_huff_count; i++) {
+        if (_cosmic_huff_tables[i].id == id) return &_cosmic_huff_tables[i];
+    }
+    if (id == 0) return _add_huff_table(0, cosmic_huff_default_lengths);
+    return NULL;
+}
+
+/**
+ * @brief Comprime _raw_int_buffer com LZ em _work_buffer (int16 cru se não houver ganho)
+ * @param n Número de int16
+ * @param mod Modo do pacote; vira COMPRESS_COSMIC_RAW16 quando o LZ não reduz
+ * @return Tamanho do payload em _work_buffer
+ */
+static int _lz_payload(int n, uint8_t* mod) {
+    int raw_int_size = n * sizeof(int16_t);
+    COSMIC_TIMER_START(t);
+    int lz_size = fastlz_compress_level(1, _raw_int_buffer, raw_int_size, _work_buffer);
+    COSMIC_TIMER_STOP(COSMIC_STAGE_LZ, t);
+
+    if (lz_size <= 0 || lz_size >= raw_int_size) {
+        memcpy(_work_buffer, _raw_int_buffer, raw_int_size);
+        *mod = COMPRESS_COSMIC_RAW16;
+        COSMIC_STAT_INC(fallbacks);
+        return raw_int_size;
+    }
+    return lz_size;
 }
 
 /**
@@ -116,14 +506,58 @@ static void _prepare_iv(uint8_t iv[16], uint8_t net_id, uint32_t counter) {
  * @return 1 se criptografado, 0 se não
  */
 static int _apply_encryption(uint8_t* buffer, uint8_t size, uint8_t net_id) {
-    if (!_encryption_enabled) return 0;
+    if (!_encryption_enabled || _cipher_dry_run) return 0;
     
-    uint8_t iv[16];
-    _prepare_iv(iv, net_id, _packet_counter);
-    maes_ctr_process(buffer, size, iv, _cosmic_key);
+    COSMIC_TIMER_START(t);
+    uint32_t counter = _packet_counter++;
+    uint16_t pos = 0;
+    uint16_t block = 0;
+
+#if COSMIC_KS_CACHE_PACKETS > 0
+    // Parte pré-calculada: só XOR
+    CosmicKsEntry* entry = &_ks_cache[counter % COSMIC_KS_CACHE_PACKETS];
+    if (entry->blocks && entry->counter == counter && entry->net_id == net_id) {
+        uint16_t cached = (uint16_t)entry->blocks * 16;
+        if (cached > size) cached = size;
+        for (; pos < cached; pos++) {
+            buffer[pos] ^= entry->ks[pos];
+        }
+        block = entry->blocks;
+    }
+    entry->blocks = 0;                 // Keystream nunca é reutilizado
+#endif
+
+    // Restante gerado na hora
+    uint8_t ks[16];
+    for (; pos < size; block++) {
+        _ks_block(ks, net_id, counter, block);
+        for (uint8_t i = 0; i < 16 && pos < size; i++, pos++) {
+            buffer[pos] ^= ks[i];
+        }
+    }
+    COSMIC_TIMER_STOP(COSMIC_STAGE_CIPHER, t);
     return 1;
 }
 
+/**
+ * @brief Finaliza pacote já montado em _c_buffer: cifra e preenche a estrutura
+ */
+static CosmicPacket _finish_packet(uint8_t nid, uint8_t type, uint8_t mod, int total_packet_size) {
+    uint8_t clear = _c_clear_len();
+    _apply_encryption(_c_buffer + clear, total_packet_size - clear, nid);
+
+    COSMIC_STAT_INC(packets_tx);
+    COSMIC_STAT_ADD(bytes_out, total_packet_size);
+    COSMIC_STAT_INC(mode_count[mod & 0x0F]);
+
+    CosmicPacket pkg;
+    pkg.data = _c_buffer;
+    pkg.size = total_packet_size;
+    pkg.type = type;
+    pkg.mode = mod;
+    return pkg;
+}
+
 // =================================================================================
 // API PÚBLICA - GERAL
 // =================================================================================
@@ -136,6 +570,54 @@ void setCosmicKey(const uint8_t key[16]) {
     memcpy(_cosmic_key, key, 16);
     _encryption_enabled = true;
     _packet_counter = 0;  // Reinicia contador ao mudar chave
+#if COSMIC_KS_CACHE_PACKETS > 0
+    for (uint8_t i = 0; i < COSMIC_KS_CACHE_PACKETS; i++) {
+        _ks_cache[i].blocks = 0;       // Keystream da chave antiga
+    }
+#endif
+}
+
+/**
+ * @brief cosmic_precompute_keystream - Adianta o AES dos próximos pacotes
+ *
+ * Chamar em tempo ocioso (ex: enquanto o sensor estabiliza). Calcula o
+ * keystream dos próximos COSMIC_KS_CACHE_PACKETS contadores; na
+ * transmissão a cifra vira só XOR. Pode ser chamada várias vezes com um
+ * limite pequeno para dividir o trabalho.
+ *
+ * @param net_id Network ID dos próximos pacotes
+ * @param max_blocks Máximo de blocos AES nesta chamada (0 = sem limite)
+ * @return Blocos que ainda faltam calcular
+ */
+int cosmic_precompute_keystream(uint8_t net_id, uint8_t max_blocks) {
+#if COSMIC_KS_CACHE_PACKETS > 0
+    if (!_encryption_enabled) return 0;
+
+    const uint8_t per_packet = COSMIC_KS_CACHE_BYTES / 16;
+    int budget = max_blocks ? max_blocks : COSMIC_KS_CACHE_PACKETS * per_packet;
+    int missing = 0;
+
+    for (uint8_t k = 0; k < COSMIC_KS_CACHE_PACKETS; k++) {
+        uint32_t counter = _packet_counter + k;
+        CosmicKsEntry* entry = &_ks_cache[counter % COSMIC_KS_CACHE_PACKETS];
+        if (entry->counter != counter || entry->net_id != net_id) {
+            entry->counter = counter;
+            entry->net_id = net_id;
+            entry->blocks = 0;
+        }
+        while (entry->blocks < per_packet && budget > 0) {
+            _ks_block(entry->ks + entry->blocks * 16, net_id, counter, entry->blocks);
+            entry->blocks++;
+            budget--;
+        }
+        missing += per_packet - entry->blocks;
+    }
+    return missing;
+#else
+    (void)net_id;
+    (void)max_blocks;
+    return 0;
+#endif
 }
 
 /**
@@ -160,6 +642,95 @@ bool isEncryptionEnabled() {
     return _encryption_enabled;
 }
 
+/**
+ * @brief Seleciona o formato de cabeçalho dos pacotes gerados
+ * @param compact true para o cabeçalho compacto (2-3 bytes), false para o legado (4 bytes)
+ * @param include_net Compacto: inclui net_id (desnecessário se o sync word já separa redes)
+ * @note Decodificadores aceitam os dois formatos misturados; com cifra o receptor
+ *       usa o mesmo formato do nó (ou setCosmicMixedHeaders dos dois lados).
+ *       dev_id > 255 sempre usa o compacto
+ */
+void setCosmicHeaderFormat(bool compact, bool include_net) {
+    _header_compact = compact;
+    _header_with_net = include_net;
+}
+
+/**
+ * @brief Habilita a extensão de retransmissão (TTL + sequência, 2 bytes) no cabeçalho compacto
+ * @param ttl Número máximo de repetições (1-15), 0 para não incluir o campo
+ * @note Só tem efeito com setCosmicHeaderFormat(true, ...); ver cosmic_relay.h
+ */
+void setCosmicRelayTtl(uint8_t ttl) {
+    _header_ttl = ttl & RELAY_TTL_MASK;
+}
+
+/**
+ * @brief Formato misto: nós legados e compactos cifrados no mesmo receptor
+ *
+ * O cabeçalho compacto passa a ir sempre em claro e cosmic_decrypt decide
+ * pelo marcador no byte 0. Para o marcador nunca confundir um pacote
+ * legado, o nó legado manda com cabeçalho compacto (sem rede) os pacotes
+ * cujo primeiro byte cifrado pareceria o marcador (1 em 8).
+ *
+ * @param enable true para habilitar (padrão false: formato de cada lado)
+ * @warning Muda o formato no ar do nó legado cifrado: receptores sem a opção
+ *          perdem esses pacotes, e neles dispositivo e tipo vão em claro.
+ *          Habilitar em todos os nós e gateways da rede ao mesmo tempo.
+ */
+void setCosmicMixedHeaders(bool enable) {
+    _header_mixed = enable;
+}
+
+/**
+ * @brief cosmic_parse_header - Decodifica cabeçalho legado ou compacto
+ * @param packet Pacote (já descriptografado se necessário)
+ * @param packet_size Tamanho do pacote
+ * @param hdr Cabeçalho decodificado (saída)
+ * @return Tamanho do cabeçalho, ou 0 se inválido
+ */
+uint8_t cosmic_parse_header(const uint8_t* packet, uint8_t packet_size, CosmicHeader* hdr) {
+    if (!packet || packet_size < 2) return 0;
+    memset(hdr, 0, sizeof(*hdr));
+
+    uint8_t b0 = packet[0];
+    if ((b0 & HDR_MARKER_MASK) != HDR_COMPACT_MARKER) {
+        // Formato legado: net | dev | tipo | modo
+        if (packet_size < HEADER_SIZE) return 0;
+        hdr->net_id = b0;
+        hdr->dev_id = packet[1];
+        hdr->type = packet[2];
+        hdr->mode = packet[3];
+        hdr->has_net = true;
+        hdr->length = HEADER_SIZE;
+        return hdr->length;
+    }
+
+    if (b0 & HDR_VERSION_MASK) return 0;      // Versão desconhecida
+
+    const uint8_t* layout = _hdr_layout[(b0 >> 3) & 0x03];
+    hdr->compact = true;
+    hdr->type = packet[1] & 0xF0;
+    hdr->mode = packet[1] & 0x0F;
+    if (layout[0] != 0xFF) {
+        if (layout[0] >= packet_size) return 0;
+        hdr->net_id = packet[layout[0]];
+        hdr->has_net = true;
+    }
+    if (layout[1] != 0xFF) {
+        if (layout[1] + 1 >= packet_size) return 0;
+        hdr->ext = packet[layout[1]];
+        hdr->seq = packet[layout[1] + 1];
+        hdr->has_ext = true;
+    }
+
+    uint32_t dev;
+    int used = _get_varint(packet + layout[2], packet_size - layout[2], &dev);
+    if (used == 0 || used > 3 || dev > 0xFFFF) return 0;
+    hdr->dev_id = (uint16_t)dev;
+    hdr->length = layout[2] + used;
+    return hdr->length;
+}
+
 // =================================================================================
 // API PÚBLICA - TELEMETRIA (FUNÇÕES ORIGINAIS)
 // =================================================================================
@@ -175,27 +746,20 @@ bool isEncryptionEnabled() {
  * @param n Número de floats no array
  * @return Pacote pronto para transmissão
  */
-CosmicPacket ppkg(bool compress, uint8_t nid, uint8_t did, uint8_t type, uint8_t mod, float* pack, int n) {
+CosmicPacket ppkg(bool compress, uint8_t nid, uint16_t did, uint8_t type, uint8_t mod, float* pack, int n) {
     // 1. Escreve Cabeçalho no buffer final
-    _prepare_header(nid, did, type, mod);
+    uint8_t hlen = _prepare_header(nid, did, type, mod);
 
-    int max_floats = (MAX_COSMIC_BUFFER - HEADER_SIZE) / (compress ? 2 : 4);
+    int max_floats = (COSMIC_MAX_PACKET - hlen) / (compress ? 2 : 4);
     if (n > max_floats) n = max_floats;
     
     // Tratamento para pacote vazio (apenas Header)
     if (n <= 0) {
-        CosmicPacket pkg; 
-        pkg.data = _c_buffer; 
-        pkg.size = HEADER_SIZE;
-        pkg.type = type;
-        pkg.mode = mod;
-        
-        // Aplica criptografia se habilitada
-        _apply_encryption(_c_buffer, HEADER_SIZE, nid);
-        return pkg;
+        return _finish_packet(nid, type, mod, hlen);
     }
 
     int payload_size = 0;
+    COSMIC_STAT_ADD(bytes_in, n * sizeof(float));
 
     // 2. Processamento dos Dados (Compressão ou Raw)
     if (!compress) {
@@ -205,57 +769,96 @@ CosmicPacket ppkg(bool compress, uint8_t nid, uint8_t did, uint8_t type, uint8_t
     } 
     else {
         // --- MODO COSMIC (Quant + Delta + LZ77) ---
-        _raw_int_buffer[0] = (int16_t)(pack[0] * 100.0);
-        for(int i = 1; i < n; i++) {
-            _raw_int_buffer[i] = (int16_t)(pack[i] * 100.0) - (int16_t)(pack[i-1] * 100.0);
-        }
-
-        int raw_int_size = n * sizeof(int16_t);
-        int lz_size = fastlz_compress_level(1, _raw_int_buffer, raw_int_size, _work_buffer);
-
-        if (lz_size <= 0 || lz_size >= raw_int_size) {
-            memcpy(_work_buffer, _raw_int_buffer, raw_int_size);
-            payload_size = raw_int_size;
-        } else {
-            payload_size = lz_size;
-        }
+        COSMIC_TIMER_START(t);
+        _quantize_delta(pack, n);
+        COSMIC_TIMER_STOP(COSMIC_STAGE_QUANT, t);
+        payload_size = _lz_payload(n, &mod);
+        _set_header_mode(mod);
     }
 
     // 3. Montagem: Coloca o Payload logo após o Cabeçalho
-    memcpy(_c_buffer + HEADER_SIZE, _work_buffer, payload_size);
-    int total_packet_size = HEADER_SIZE + payload_size;
+    memcpy(_c_buffer + hlen, _work_buffer, payload_size);
 
     // 4. Aplica criptografia se habilitada
-    _apply_encryption(_c_buffer, total_packet_size, nid);
+    return _finish_packet(nid, type, mod, hlen + payload_size);
+}
 
-    CosmicPacket pkg;
-    pkg.data = _c_buffer;
-    pkg.size = total_packet_size;
-    pkg.type = type;
-    pkg.mode = mod;
-    return pkg;
+/**
+ * @brief Monta pacote COSMIC a partir de _raw_int_buffer já preenchido
+ */
+static CosmicPacket _pack_cosmic_ints(uint8_t nid, uint16_t did, uint8_t type, int n) {
+    uint8_t hlen = _prepare_header(nid, did, type, COMPRESS_COSMIC);
+    if (n <= 0) {
+        return _finish_packet(nid, type, COMPRESS_COSMIC, hlen);
+    }
+
+    uint8_t mod = COMPRESS_COSMIC;
+    int payload_size = _lz_payload(n, &mod);
+    _set_header_mode(mod);
+    memcpy(_c_buffer + hlen, _work_buffer, payload_size);
+    return _finish_packet(nid, type, mod, hlen + payload_size);
 }
 
 /**
- * @brief uppkg (Unpack Floats) - Desempacota dados de telemetria
- * @param packet Pacote recebido (já descriptografado se necessário)
- * @param packet_size Tamanho do pacote
+ * @brief ppkg_i16 - Empacota contagens int16 (ex: ADC) em modo COSMIC sem ponto flutuante
+ * @param nid Network ID
+ * @param did Device ID
+ * @param type Tipo de pacote (usar PKG_TYPE_TELEMETRY)
+ * @param raw Contagens cruas
+ * @param n Número de contagens
+ * @param mul Multiplicador Q(shift) para centésimos (usar COSMIC_FIXED_MUL; |mul| < 65536)
+ * @param shift Bits fracionários de mul
+ * @return Pacote COMPRESS_COSMIC (ou COMPRESS_COSMIC_RAW16), decodificado normalmente por uppkg
+ */
+CosmicPacket ppkg_i16(uint8_t nid, uint16_t did, uint8_t type, const int16_t* raw, int n,
+                      int32_t mul, uint8_t shift) {
+    int max_ints = (COSMIC_MAX_PACKET - HEADER_MAX_SIZE) / 2;
+    if (n > max_ints) n = max_ints;
+    if (n > 0) {
+        COSMIC_STAT_ADD(bytes_in, n * sizeof(int16_t));
+        COSMIC_TIMER_START(t);
+        _quantize_delta_i16(raw, n, mul, shift);
+        COSMIC_TIMER_STOP(COSMIC_STAGE_QUANT, t);
+    }
+    return _pack_cosmic_ints(nid, did, type, n);
+}
+
+/**
+ * @brief ppkg_i32 - Empacota contagens int32 em modo COSMIC sem ponto flutuante
+ * @param nid Network ID
+ * @param did Device ID
+ * @param type Tipo de pacote (usar PKG_TYPE_TELEMETRY)
+ * @param raw Contagens cruas
+ * @param n Número de contagens
+ * @param mul Multiplicador Q(shift) para centésimos (usar COSMIC_FIXED_MUL)
+ * @param shift Bits fracionários de mul
+ * @return Pacote COMPRESS_COSMIC (ou COMPRESS_COSMIC_RAW16), decodificado normalmente por uppkg
+ */
+CosmicPacket ppkg_i32(uint8_t nid, uint16_t did, uint8_t type, const int32_t* raw, int n,
+                      int32_t mul, uint8_t shift) {
+    int max_ints = (COSMIC_MAX_PACKET - HEADER_MAX_SIZE) / 2;
+    if (n > max_ints) n = max_ints;
+    if (n > 0) {
+        COSMIC_STAT_ADD(bytes_in, n * sizeof(int32_t));
+        COSMIC_TIMER_START(t);
+        _quantize_delta_i32(raw, n, mul, shift);
+        COSMIC_TIMER_STOP(COSMIC_STAGE_QUANT, t);
+    }
+    return _pack_cosmic_ints(nid, did, type, n);
+}
+
+/**
+ * @brief uppkg_payload - Decodifica payload de telemetria já separado do cabeçalho
+ * @param mode Modo de compressão (COMPRESS_*)
+ * @param payload Payload (após o cabeçalho, ou registro de um agregado)
+ * @param payload_size Tamanho do payload
  * @param output Buffer para floats desempacotados
  * @param max_output Número máximo de floats no buffer
  * @return Número de floats desempacotados, ou -1 em caso de erro
  */
-int uppkg(const uint8_t* packet, uint8_t packet_size, float* output, int max_output) {
-    if (packet_size < HEADER_SIZE) return -1;
-    
-    uint8_t type = packet[2];
-    uint8_t mode = packet[3];
-    
-    // Verifica se é pacote de telemetria
-    if (type != PKG_TYPE_TELEMETRY) return -1;
-    
-    int payload_size = packet_size - HEADER_SIZE;
-    const uint8_t* payload = packet + HEADER_SIZE;
-    
+int uppkg_payload(uint8_t mode, const uint8_t* payload, int payload_size, float* output, int max_output) {
+    if (!payload || payload_size < 0) return -1;
+
     if (mode == COMPRESS_NONE) {
         // Modo RAW: copia floats diretamente
         int num_floats = payload_size / sizeof(float);
@@ -272,23 +875,235 @@ int uppkg(const uint8_t* packet, uint8_t packet_size, float* output, int max_out
         int num_ints = decompressed_size / sizeof(int16_t);
         if (num_ints > max_output) num_ints = max_output;
         
-        int16_t* int_data = (int16_t*)_work_buffer;
-        
         // Processa delta encoding inverso
-        float cumulative = int_data[0] / 100.0;
-        output[0] = cumulative;
-        
-        for (int i = 1; i < num_ints; i++) {
-            cumulative += int_data[i] / 100.0;
-            output[i] = cumulative;
+        _dequantize_delta((int16_t*)_work_buffer, num_ints, output);
+        return num_ints;
+    }
+    else if (mode == COMPRESS_COSMIC_RAW16) {
+        // Modo COSMIC sem LZ: int16 delta direto (cópia alinhada)
+        int num_ints = payload_size / sizeof(int16_t);
+        if (num_ints > max_output) num_ints = max_output;
+        if (num_ints > (int)(sizeof(_work_buffer) / sizeof(int16_t))) return -1;
+
+        memcpy(_work_buffer, payload, num_ints * sizeof(int16_t));
+        _dequantize_delta((int16_t*)_work_buffer, num_ints, output);
+        return num_ints;
+    }
+    else if (mode == COMPRESS_COSMIC_VARINT) {
+        // Modo COSMIC incremental: varints zigzag do delta int16, até o fim do payload
+        int16_t cumulative = 0;
+        int num_ints = 0;
+        int pos = 0;
+        while (pos < payload_size && num_ints < max_output) {
+            uint32_t zz;
+            int used = _get_varint(payload + pos, payload_size - pos, &zz);
+            if (used == 0) return -1;
+            pos += used;
+            cumulative = (int16_t)(cumulative + (int16_t)_zigzag_decode(zz));
+            output[num_ints++] = cumulative / (float)COSMIC_QUANT_SCALE;
         }
-        
+        return num_ints;
+    }
+    else if (mode == COMPRESS_COSMIC_DICT) {
+        // Modo COSMIC com dicionário: [dict_id | LZ com prefixo]
+        if (payload_size < 2) return -1;
+        const CosmicDict* dict = _find_dict(payload[0]);
+        if (!dict) return -1;
+
+        memcpy(_lz_window, dict->data, dict->size);
+        int decompressed_size = fastlz_decompress_prefix(payload + 1, payload_size - 1,
+                                                         _lz_window, dict->size, MAX_COSMIC_BUFFER);
+        if (decompressed_size <= 0) return -1;
+
+        int num_ints = decompressed_size / sizeof(int16_t);
+        if (num_ints > max_output) num_ints = max_output;
+
+        // Copia para buffer alinhado antes de interpretar como int16
+        memcpy(_work_buffer, _lz_window + dict->size, num_ints * sizeof(int16_t));
+        _dequantize_delta((int16_t*)_work_buffer, num_ints, output);
+        return num_ints;
+    }
+    
+    else if (mode == COMPRESS_COSMIC_HUFF) {
+        // Modo COSMIC com Huffman: [table_id | n | bits]
+        if (payload_size < 3) return -1;
+        const CosmicHuffTable* table = _find_huff_table(payload[0]);
+        int n = payload[1];
+        if (!table || n == 0 || n * sizeof(uint16_t) > sizeof(_work_buffer)) return -1;
+
+        uint16_t* zz = (uint16_t*)_work_buffer;
+        if (!cosmic_huff_decode(table, payload + 2, payload_size - 2, zz, n)) return -1;
+
+        int16_t* int_data = (int16_t*)_work_buffer;
+        for (int i = 0; i < n; i++) {
+            int_data[i] = (int16_t)_zigzag_decode(zz[i]);
+        }
+
+        int num_ints = n > max_output ? max_output : n;
+        _dequantize_delta(int_data, num_ints, output);
         return num_ints;
     }
     
     return -1; // Modo não reconhecido
 }
 
+/**
+ * @brief uppkg (Unpack Floats) - Desempacota dados de telemetria
+ * @param packet Pacote recebido (já descriptografado se necessário)
+ * @param packet_size Tamanho do pacote
+ * @param output Buffer para floats desempacotados
+ * @param max_output Número máximo de floats no buffer
+ * @return Número de floats desempacotados, ou -1 em caso de erro
+ */
+int uppkg(const uint8_t* packet, uint8_t packet_size, float* output, int max_output) {
+    CosmicHeader hdr;
+    if (!cosmic_parse_header(packet, packet_size, &hdr) || hdr.type != PKG_TYPE_TELEMETRY) {
+        COSMIC_STAT_INC(decode_errors);
+        return -1;
+    }
+    
+    int n = uppkg_payload(hdr.mode, packet + hdr.length, packet_size - hdr.length, output, max_output);
+    if (n < 0) COSMIC_STAT_INC(decode_errors);
+    else COSMIC_STAT_INC(packets_rx);
+    return n;
+}
+
+/**
+ * @brief registerCosmicDict - Registra dicionário LZ pré-carregado
+ * @param id Identificador transmitido no pacote (deve ser igual no nó e no gateway)
+ * @param data Conteúdo do dicionário (gerado pelo extras/dict_trainer)
+ * @param size Tamanho em bytes (máx COSMIC_MAX_DICT_SIZE)
+ * @return 1 se registrado, 0 se tabela cheia ou tamanho inválido
+ */
+int registerCosmicDict(uint8_t id, const uint8_t* data, uint16_t size) {
+    if (!data || size == 0 || size > COSMIC_MAX_DICT_SIZE) return 0;
+
+    CosmicDict* slot = (CosmicDict*)_find_dict(id);
+    if (!slot) {
+        if (_cosmic_dict_count >= COSMIC_MAX_DICTS) return 0;
+        slot = &_cosmic_dicts[_cosmic_dict_count++];
+    }
+    slot->data = data;
+    slot->size = size;
+    slot->id = id;
+    return 1;
+}
+
+/**
+ * @brief ppkg_dict - Empacota floats em modo COSMIC usando dicionário pré-carregado
+ * @param dict_id ID de um dicionário registrado com registerCosmicDict
+ * @param nid Network ID
+ * @param did Device ID
+ * @param type Tipo de pacote (usar PKG_TYPE_TELEMETRY)
+ * @param pack Array de floats
+ * @param n Número de floats no array
+ * @return Pacote COMPRESS_COSMIC_DICT, ou ppkg COSMIC comum se o dicionário não ajudar
+ */
+CosmicPacket ppkg_dict(uint8_t dict_id, uint8_t nid, uint16_t did, uint8_t type, float* pack, int n) {
+    const CosmicDict* dict = _find_dict(dict_id);
+    int max_floats = (COSMIC_MAX_PACKET - HEADER_MAX_SIZE - 1) / 2;
+    if (n > max_floats) n = max_floats;
+
+    if (!dict || n <= 0) {
+        return ppkg(true, nid, did, type, COMPRESS_COSMIC, pack, n);
+    }
+
+    COSMIC_TIMER_START(tq);
+    _quantize_delta(pack, n);
+    COSMIC_TIMER_STOP(COSMIC_STAGE_QUANT, tq);
+    int raw_int_size = n * sizeof(int16_t);
+
+    // Dicionário e dados lado a lado: o LZ referencia o dicionário como histórico
+    memcpy(_lz_window, dict->data, dict->size);
+    memcpy(_lz_window + dict->size, _raw_int_buffer, raw_int_size);
+    COSMIC_TIMER_START(tz);
+    int lz_size = fastlz_compress_prefix(_lz_window, dict->size, dict->size + raw_int_size, _work_buffer);
+    COSMIC_TIMER_STOP(COSMIC_STAGE_LZ, tz);
+
+    if (lz_size <= 0 || lz_size + 1 >= raw_int_size) {
+        COSMIC_STAT_INC(fallbacks);
+        return ppkg(true, nid, did, type, COMPRESS_COSMIC, pack, n);
+    }
+
+    COSMIC_STAT_ADD(bytes_in, n * sizeof(float));
+    uint8_t hlen = _prepare_header(nid, did, type, COMPRESS_COSMIC_DICT);
+    _c_buffer[hlen] = dict_id;
+    memcpy(_c_buffer + hlen + 1, _work_buffer, lz_size);
+    return _finish_packet(nid, type, COMPRESS_COSMIC_DICT, hlen + 1 + lz_size);
+}
+
+/**
+ * @brief registerCosmicHuffTable - Registra tabela Huffman treinada para a rede
+ * @param id Identificador transmitido no pacote (0 substitui a tabela padrão)
+ * @param lengths Comprimentos de código dos 16 símbolos (gerado pelo extras/dict_trainer)
+ * @return 1 se registrada, 0 se tabela cheia ou comprimentos inválidos
+ */
+int registerCosmicHuffTable(uint8_t id, const uint8_t lengths[COSMIC_HUFF_SYMBOLS]) {
+    return _add_huff_table(id, lengths) != NULL;
+}
+
+/**
+ * @brief attachCosmicHuffLut - Anexa tabela de decodificação multi-símbolo (gateway)
+ * @param id ID da tabela Huffman
+ * @param lut Memória para a tabela rápida (~7 KB), mantida pelo chamador
+ * @return 1 se anexada, 0 se tabela não registrada
+ */
+int attachCosmicHuffLut(uint8_t id, CosmicHuffLut* lut) {
+    CosmicHuffTable* table = _find_huff_table(id);
+    if (!table || !lut) return 0;
+    cosmic_huff_build_lut(table, lut);
+    table->lut = lut;
+    return 1;
+}
+
+/**
+ * @brief ppkg_huff - Empacota floats com quantização, delta e Huffman estático
+ * @param table_id ID da tabela Huffman (0 = padrão)
+ * @param nid Network ID
+ * @param did Device ID
+ * @param type Tipo de pacote (usar PKG_TYPE_TELEMETRY)
+ * @param pack Array de floats
+ * @param n Número de floats no array (máx 255)
+ * @return Pacote COMPRESS_COSMIC_HUFF, ou ppkg COSMIC comum se não houver ganho
+ */
+CosmicPacket ppkg_huff(uint8_t table_id, uint8_t nid, uint16_t did, uint8_t type, float* pack, int n) {
+    const CosmicHuffTable* table = _find_huff_table(table_id);
+    int max_floats = (COSMIC_MAX_PACKET - HEADER_MAX_SIZE - 2) / 2;
+    if (n > max_floats) n = max_floats;
+    if (n > 255) n = 255;
+
+    if (!table || n <= 0) {
+        return ppkg(true, nid, did, type, COMPRESS_COSMIC, pack, n);
+    }
+
+    COSMIC_TIMER_START(tq);
+    _quantize_delta(pack, n);
+    COSMIC_TIMER_STOP(COSMIC_STAGE_QUANT, tq);
+    int raw_int_size = n * sizeof(int16_t);
+
+    // Resíduos em zigzag, no próprio buffer
+    uint16_t* zz = (uint16_t*)_raw_int_buffer;
+    for (int i = 0; i < n; i++) {
+        zz[i] = (uint16_t)_zigzag_encode(_raw_int_buffer[i]);
+    }
+
+    // Só vale a pena se ficar menor que o int16 cru
+    COSMIC_TIMER_START(te);
+    uint16_t bits_size = cosmic_huff_encode(table, zz, n, _work_buffer, raw_int_size - 2);
+    COSMIC_TIMER_STOP(COSMIC_STAGE_ENTROPY, te);
+    if (bits_size == 0) {
+        COSMIC_STAT_INC(fallbacks);
+        return ppkg(true, nid, did, type, COMPRESS_COSMIC, pack, n);
+    }
+
+    COSMIC_STAT_ADD(bytes_in, n * sizeof(float));
+    uint8_t hlen = _prepare_header(nid, did, type, COMPRESS_COSMIC_HUFF);
+    _c_buffer[hlen] = table_id;
+    _c_buffer[hlen + 1] = (uint8_t)n;
+    memcpy(_c_buffer + hlen + 2, _work_buffer, bits_size);
+    return _finish_packet(nid, type, COMPRESS_COSMIC_HUFF, hlen + 2 + bits_size);
+}
+
 // =================================================================================
 // API PÚBLICA - IMAGENS (NOVAS FUNÇÕES)
 // =================================================================================
@@ -304,7 +1119,7 @@ int uppkg(const uint8_t* packet, uint8_t packet_size, float* output, int max_out
  * @param height Altura da imagem (1-255)
  * @return Pacote de imagem pronto para transmissão
  */
-CosmicImagePacket ppkg_image(uint8_t nid, uint8_t did, uint8_t type, uint8_t compress_mode,
+CosmicImagePacket ppkg_image(uint8_t nid, uint16_t did, uint8_t type, uint8_t compress_mode,
                              const uint8_t* pixels, uint8_t width, uint8_t height) {
     CosmicImagePacket img_pkt = {0};
     
@@ -312,9 +1127,9 @@ CosmicImagePacket ppkg_image(uint8_t nid, uint8_t did, uint8_t type, uint8_t com
     uint16_t img_size = width * height;
     if (img_size == 0 || img_size > MAX_IMAGE_SIZE) {
         // Reduz automaticamente se muito grande
-        width = 16;
-        height = 16;
-        img_size = 256;
+        width = MAX_IMAGE_SIDE;
+        height = MAX_IMAGE_SIDE;
+        img_size = MAX_IMAGE_SIZE;
     }
     
     // 1. Comprime a imagem usando a biblioteca img_compress
@@ -326,21 +1141,29 @@ CosmicImagePacket ppkg_image(uint8_t nid, uint8_t did, uint8_t type, uint8_t com
         default:                 img_mode = IMG_COMPRESS_NONE; break;
     }
     
+    COSMIC_TIMER_START(t);
     CompressedImage cimg = img_compress(pixels, width, height, img_mode);
+    COSMIC_TIMER_STOP(COSMIC_STAGE_IMAGE, t);
     
     // 2. Prepara cabeçalho (igual aos outros pacotes)
-    _prepare_header(nid, did, type, compress_mode);
+    uint8_t hlen = _prepare_header(nid, did, type, compress_mode);
     
     // 3. Copia dados comprimidos após o header
-    int total_size = HEADER_SIZE + cimg.size;
-    if (total_size > MAX_COSMIC_BUFFER) {
-        total_size = MAX_COSMIC_BUFFER;
+    int total_size = hlen + cimg.size;
+    if (total_size > COSMIC_MAX_PACKET) {
+        total_size = COSMIC_MAX_PACKET;
     }
     
-    memcpy(_c_buffer + HEADER_SIZE, cimg.data, cimg.size);
+    memcpy(_c_buffer + hlen, cimg.data, total_size - hlen);
     
     // 4. Aplica criptografia se habilitada
-    _apply_encryption(_c_buffer, total_size, nid);
+    uint8_t clear = _c_clear_len();
+    _apply_encryption(_c_buffer + clear, total_size - clear, nid);
+
+    COSMIC_STAT_INC(packets_tx);
+    COSMIC_STAT_ADD(bytes_in, img_size);
+    COSMIC_STAT_ADD(bytes_out, total_size);
+    COSMIC_STAT_INC(mode_count[compress_mode & 0x0F]);
     
     // 5. Preenche estrutura de retorno
     img_pkt.data = _c_buffer;
@@ -362,20 +1185,24 @@ CosmicImagePacket ppkg_image(uint8_t nid, uint8_t did, uint8_t type, uint8_t com
  */
 int uppkg_image(const uint8_t* packet, uint8_t packet_size, 
                 uint8_t* output, uint16_t max_output) {
-    if (packet_size < HEADER_SIZE + 3) {
+    CosmicHeader hdr;
+    uint8_t hlen = cosmic_parse_header(packet, packet_size, &hdr);
+    if (hlen == 0 || packet_size < hlen + 3) {
         return 0;  // Pacote muito pequeno
     }
     
     // Verifica se é pacote de imagem
-    uint8_t type = packet[2];
-    if (type != PKG_TYPE_IMAGE) {
+    if (hdr.type != PKG_TYPE_IMAGE) {
         return 0;  // Não é pacote de imagem
     }
+    if (hdr.mode == COMPRESS_IMG_PROG) {
+        return 0;  // Fragmento progressivo: uppkg_prog (cosmic_progressive.h)
+    }
     
     // Extrai informações da imagem do payload
-    uint8_t width = packet[HEADER_SIZE];
-    uint8_t height = packet[HEADER_SIZE + 1];
-    uint8_t mode = packet[HEADER_SIZE + 2];
+    uint8_t width = packet[hlen];
+    uint8_t height = packet[hlen + 1];
+    uint8_t mode = packet[hlen + 2];
     
     uint16_t expected_size = width * height;
     if (expected_size == 0 || expected_size > max_output) {
@@ -384,14 +1211,19 @@ int uppkg_image(const uint8_t* packet, uint8_t packet_size,
     
     // Cria estrutura CompressedImage para a biblioteca img_compress
     CompressedImage cimg;
-    cimg.data = (uint8_t*)(packet + HEADER_SIZE);
-    cimg.size = packet_size - HEADER_SIZE;
+    cimg.data = (uint8_t*)(packet + hlen);
+    cimg.size = packet_size - hlen;
     cimg.mode = mode;
     cimg.original_width = width;
     cimg.original_height = height;
     
     // Descomprime usando a biblioteca img_compress
-    return img_decompress(&cimg, output);
+    COSMIC_TIMER_START(t);
+    int ok = img_decompress(&cimg, output);
+    COSMIC_TIMER_STOP(COSMIC_STAGE_IMAGE, t);
+    if (ok) COSMIC_STAT_INC(packets_rx);
+    else COSMIC_STAT_INC(decode_errors);
+    return ok;
 }
 
 /**
@@ -419,34 +1251,64 @@ void create_test_image(uint8_t width, uint8_t height, uint8_t* buffer) {
 // =================================================================================
 
 /**
- * @brief decrypt_packet - Descriptografa pacote recebido
+ * @brief cosmic_decrypt - Descriptografa pacote recebido sem tocar no contador local
+ *
+ * Só lê a chave global, então pode ser usada por vários threads
+ * decodificadores no gateway. O cabeçalho em claro segue o formato
+ * configurado, ou o marcador do próprio pacote no formato misto.
+ *
  * @param packet Pacote a ser descriptografado
  * @param size Tamanho do pacote
  * @param net_id Network ID esperado (para IV)
- * @param counter Contador de pacotes esperado
+ * @param counter Contador de pacotes do emissor
  * @return 1 se descriptografado, 0 se não
  */
-int decrypt_packet(uint8_t* packet, uint8_t size, uint8_t net_id, uint32_t counter) {
+int cosmic_decrypt(uint8_t* packet, uint8_t size, uint8_t net_id, uint32_t counter) {
     if (!_encryption_enabled) return 0;
     
+    // Cabeçalho compacto trafega em claro, o legado cifrado (ver _c_clear_len)
+    uint8_t clear = 0;
+    bool clear_header = _header_mixed ? size > 0 && (packet[0] & HDR_MARKER_MASK) == HDR_COMPACT_MARKER
+                                      : _header_compact;
+    if (clear_header) {
+        CosmicHeader hdr;
+        clear = cosmic_parse_header(packet, size, &hdr);
+        if (clear == 0) return 0;
+    }
+    
     uint8_t iv[16];
-    _prepare_iv(iv, net_id, counter);
+    _build_iv(iv, net_id, counter);
     
     // Aplica operação XOR novamente para descriptografar (CTR é simétrico)
-    maes_ctr_process(packet, size, iv, _cosmic_key);
+    maes_ctr_process(packet + clear, size - clear, iv, _cosmic_key);
+    return 1;
+}
+
+/**
+ * @brief decrypt_packet - Descriptografa pacote recebido e avança o contador local
+ * @param packet Pacote a ser descriptografado
+ * @param size Tamanho do pacote
+ * @param net_id Network ID esperado (para IV)
+ * @param counter Contador de pacotes esperado
+ * @return 1 se descriptografado, 0 se não
+ */
+int decrypt_packet(uint8_t* packet, uint8_t size, uint8_t net_id, uint32_t counter) {
+    if (!cosmic_decrypt(packet, size, net_id, counter)) return 0;
+    _packet_counter++;                 // Incrementa para próximo pacote
     return 1;
 }
 
 /**
  * @brief get_packet_info - Extrai informações do cabeçalho do pacote
  * @param packet Pacote (criptografado ou não)
+ * @param packet_size Tamanho do pacote (o cabeçalho compacto tem tamanho variável)
  * @param net_id Ponteiro para Network ID (saída)
  * @param dev_id Ponteiro para Device ID (saída)
  * @param type Ponteiro para tipo de pacote (saída)
  * @param mode Ponteiro para modo (saída)
- * @return 1 se sucesso, 0 se erro
+ * @return 1 se sucesso, 0 se erro (inclusive pacote truncado)
  */
-int get_packet_info(const uint8_t* packet, uint8_t* net_id, uint8_t* dev_id, 
+int get_packet_info(const uint8_t* packet, uint8_t packet_size, uint8_t* net_id, uint8_t* dev_id, 
                     uint8_t* type, uint8_t* mode) {
     if (!packet) return 0;
     
@@ -457,10 +1319,13 @@ int get_packet_info(const uint8_t* packet, uint8_t* net_id, uint8_t* dev_id,
         return 0;
     }
     
-    *net_id = packet[0];
-    *dev_id = packet[1];
-    *type = packet[2];
-    *mode = packet[3];
+    CosmicHeader hdr;
+    if (!cosmic_parse_header(packet, packet_size, &hdr)) return 0;
+    
+    *net_id = hdr.net_id;
+    *dev_id = (uint8_t)hdr.dev_id;   // Use cosmic_parse_header para dev_id > 255
+    *type = hdr.type;
+    *mode = hdr.mode;
     
     return 1;
 }
@@ -486,4 +1351,26 @@ uint8_t calculate_crc8(const uint8_t* data, uint8_t length) {
     return crc;
 }
 
+// =================================================================================
+// ORÇAMENTO DE RAM
+// =================================================================================
+
+// Total estático da biblioteca (arena + saída + hash LZ + tabelas + criptografia).
+// A S-box entra na conta: const sem PROGMEM fica na RAM do AVR.
+#define COSMIC_RAM_TABLES (sizeof(_cosmic_dicts) + sizeof(_cosmic_huff_tables))
+#if COSMIC_KS_CACHE_PACKETS > 0
+#define COSMIC_RAM_KS     sizeof(_ks_cache)
+#else
+#define COSMIC_RAM_KS     0
+#endif
+#define COSMIC_RAM_CRYPTO (sizeof(_cosmic_key) + sizeof(sbox) + COSMIC_RAM_KS)
+#define COSMIC_RAM_TOTAL  (COSMIC_RAM_ARENA + COSMIC_RAM_OUTPUT + COSMIC_RAM_LZ_HASH + \
+                           COSMIC_RAM_TABLES + COSMIC_RAM_CRYPTO)
+
+// Defina COSMIC_RAM_BUDGET (bytes) para falhar a compilação se o perfil não couber
+#ifdef COSMIC_RAM_BUDGET
+static_assert(COSMIC_RAM_TOTAL <= COSMIC_RAM_BUDGET,
+              "CLoRa: RAM estática excede COSMIC_RAM_BUDGET; use um perfil menor");
+#endif
+
 #endif // COSMIC_PAYLOAD_H
\ No newline at end of file
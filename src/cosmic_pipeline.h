@@ -0,0 +1,166 @@
+#ifndef COSMIC_PIPELINE_H
+#define COSMIC_PIPELINE_H
+
+#include "cosmic_payload.h"
+#include "cosmic_ring.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+//
+// Montagem e transmissão em paralelo (ESP32 dual-core, downlink do gateway):
+//
+//   núcleo/thread de montagem:  ppkg* -> cosmic_pipe_submit()
+//   núcleo/thread do rádio:     cosmic_pipe_tx_begin() -> transmite -> cosmic_pipe_tx_done()
+//
+// ppkg* usa _c_buffer e a arena estática, então toda montagem (inclusive
+// uppkg) deve ficar em um único núcleo/thread. O pacote pronto é copiado
+// para uma posição da pipeline, liberando _c_buffer para o pacote N+1
+// enquanto o pacote N está no ar.
+
+#ifndef COSMIC_PIPELINE_DEPTH
+#define COSMIC_PIPELINE_DEPTH 2            // 2 = buffer duplo, 3 = triplo
+#endif
+#if COSMIC_PIPELINE_DEPTH < 2 || COSMIC_PIPELINE_DEPTH > 8
+#error "COSMIC_PIPELINE_DEPTH deve estar entre 2 e 8"
+#endif
+
+// Status de transmissão repassado ao callback
+#define COSMIC_TX_OK       0
+#define COSMIC_TX_FAILED  -1               // Timeout do rádio, canal ocupado etc.
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+/**
+ * @brief Callback de fim de transmissão (chamado no contexto do rádio)
+ * @param pkg Pacote transmitido (válido só durante a chamada)
+ * @param status COSMIC_TX_OK ou COSMIC_TX_FAILED
+ * @param user Ponteiro registrado em cosmic_pipe_init
+ */
+typedef void (*CosmicTxDoneCallback)(const CosmicPacket* pkg, int status, void* user);
+
+struct CosmicPipeSlot {
+    uint8_t data[MAX_COSMIC_BUFFER];
+    CosmicPacket pkg;                      // pkg.data aponta para data
+};
+
+/**
+ * @brief Pipeline de pacotes prontos (produtor: montagem, consumidor: rádio)
+ *
+ * Índices de 0 a 2*DEPTH-1 distinguem cheio de vazio com qualquer
+ * profundidade; tail só é escrito pela montagem e head só pelo rádio.
+ */
+struct CosmicPipeline {
+    COSMIC_ALIGNED uint8_t head;           // Próximo a transmitir
+    COSMIC_ALIGNED uint8_t tail;           // Próximo a montar
+    CosmicTxDoneCallback on_done;
+    void* user;
+    CosmicPipeSlot slots[COSMIC_PIPELINE_DEPTH];
+};
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+static inline uint8_t _pipe_advance(uint8_t i) {
+    return (uint8_t)(i + 1 == 2 * COSMIC_PIPELINE_DEPTH ? 0 : i + 1);
+}
+
+static inline CosmicPipeSlot* _pipe_slot(CosmicPipeline* p, uint8_t i) {
+    return &p->slots[i >= COSMIC_PIPELINE_DEPTH ? i - COSMIC_PIPELINE_DEPTH : i];
+}
+
+static inline uint8_t _pipe_used(uint8_t head, uint8_t tail) {
+    return (uint8_t)(tail >= head ? tail - head : tail + 2 * COSMIC_PIPELINE_DEPTH - head);
+}
+
+// =================================================================================
+// API PÚBLICA
+// =================================================================================
+
+/**
+ * @brief Inicializa a pipeline
+ * @param p Pipeline
+ * @param on_done Callback de fim de transmissão (pode ser NULL)
+ * @param user Repassado ao callback
+ */
+void cosmic_pipe_init(CosmicPipeline* p, CosmicTxDoneCallback on_done, void* user) {
+    p->head = 0;
+    p->tail = 0;
+    p->on_done = on_done;
+    p->user = user;
+    for (uint8_t i = 0; i < COSMIC_PIPELINE_DEPTH; i++) {
+        p->slots[i].pkg.data = p->slots[i].data;
+        p->slots[i].pkg.size = 0;
+    }
+}
+
+/**
+ * @brief Montagem: indica se há posição livre (senão aguardar tx_done)
+ */
+bool cosmic_pipe_can_submit(CosmicPipeline* p) {
+    return _pipe_used(COSMIC_LOAD_ACQUIRE(&p->head), p->tail) < COSMIC_PIPELINE_DEPTH;
+}
+
+/**
+ * @brief cosmic_pipe_submit - Montagem: publica um pacote pronto (já cifrado)
+ * @param p Pipeline
+ * @param pkg Pacote de ppkg* (copiado; _c_buffer fica livre para o próximo)
+ * @return 1 se publicado, 0 se todas as posições estão ocupadas
+ */
+int cosmic_pipe_submit(CosmicPipeline* p, const CosmicPacket* pkg) {
+    if (!pkg || pkg->size == 0 || !cosmic_pipe_can_submit(p)) return 0;
+
+    CosmicPipeSlot* slot = _pipe_slot(p, p->tail);
+    memcpy(slot->data, pkg->data, pkg->size);
+    slot->pkg.size = pkg->size;
+    slot->pkg.type = pkg->type;
+    slot->pkg.mode = pkg->mode;
+    COSMIC_STORE_RELEASE(&p->tail, _pipe_advance(p->tail));
+    return 1;
+}
+
+/**
+ * @brief cosmic_pipe_ppkg - Montagem: ppkg direto para a pipeline
+ * @return 1 se publicado, 0 se a pipeline está cheia (nada é montado)
+ */
+int cosmic_pipe_ppkg(CosmicPipeline* p, bool compress, uint8_t nid, uint16_t did,
+                     uint8_t type, uint8_t mod, float* pack, int n) {
+    if (!cosmic_pipe_can_submit(p)) return 0;
+    CosmicPacket pkg = ppkg(compress, nid, did, type, mod, pack, n);
+    return cosmic_pipe_submit(p, &pkg);
+}
+
+/**
+ * @brief cosmic_pipe_tx_begin - Rádio: próximo pacote a transmitir
+ * @return Pacote (permanece válido até cosmic_pipe_tx_done), ou NULL se vazio
+ */
+const CosmicPacket* cosmic_pipe_tx_begin(CosmicPipeline* p) {
+    if (p->head == COSMIC_LOAD_ACQUIRE(&p->tail)) return NULL;
+    return &_pipe_slot(p, p->head)->pkg;
+}
+
+/**
+ * @brief cosmic_pipe_tx_done - Rádio: fim da transmissão do pacote de tx_begin
+ * @param p Pipeline
+ * @param status COSMIC_TX_OK ou COSMIC_TX_FAILED (repassado ao callback)
+ */
+void cosmic_pipe_tx_done(CosmicPipeline* p, int status) {
+    if (p->head == COSMIC_LOAD_ACQUIRE(&p->tail)) return;
+
+    if (p->on_done) {
+        p->on_done(&_pipe_slot(p, p->head)->pkg, status, p->user);
+    }
+    COSMIC_STORE_RELEASE(&p->head, _pipe_advance(p->head));
+}
+
+/**
+ * @brief Pacotes montados aguardando ou em transmissão
+ */
+uint8_t cosmic_pipe_pending(CosmicPipeline* p) {
+    return _pipe_used(COSMIC_LOAD_ACQUIRE(&p->head), COSMIC_LOAD_ACQUIRE(&p->tail));
+}
+
+#endif // COSMIC_PIPELINE_H
@@ -0,0 +1,445 @@
+#ifndef COSMIC_PROGRESSIVE_H
+#define COSMIC_PROGRESSIVE_H
+
+#include "cosmic_payload.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+//
+// Imagem progressiva (modo COMPRESS_IMG_PROG): em vez de um quadro inteiro
+// numa qualidade fixa, o nó envia camadas e o gateway refina a imagem a
+// cada pacote.
+//
+//   base       Médias de células 2^L x 2^L (a ideia do downsample2, L vezes):
+//              prévia da imagem inteira em poucos pacotes
+//   refino     Um nível mais fino (célula menor), como resíduo contra o que o
+//              gateway já reconstruiu, quantizado com passo q: resíduos
+//              menores que q/2 somem, detalhe de pouco valor não custa nada
+//   ROI        Retângulo no nível 0 com passo 1: pixels exatos só onde importa
+//
+// O nó mantém um espelho da reconstrução do gateway (canvas), então cada
+// resíduo é calculado contra exatamente o que o gateway tem. A transmissão
+// pode parar em qualquer pacote; o que chegou já é uma imagem completa.
+//
+// Payload (logo após o cabeçalho), um fragmento de uma camada:
+//   [0] img_id  [1] largura  [2] altura
+//   [3] bit7 = base | bits 0-2 nível L   [4] passo q
+//   [5] x [6] y [7] w [8] h             retângulo da camada, em células do nível
+//   [9-10] primeira célula, [11-12] células cobertas (LE; ordem raster no retângulo)
+//   tokens: bits MSB primeiro, Exp-Golomb de ordem 0 (EG: k zeros e n+1 em k+1 bits)
+//           por célula não nula: EG(zeros antes) + sinal (1 = negativo) + EG(|resíduo / q| - 1)
+//           até o fim do pacote; o preenchimento do último byte é zero. Células
+//           restantes até "cobertas" têm resíduo 0
+// Um resíduo ±1 colado no anterior custa 3 bits e uma faixa sem resíduo só o
+// EG da corrida, então um refino denso fica abaixo de 1 byte por célula.
+// Predição: base = célula anterior do fragmento (128 na primeira); refino e
+// ROI = valor atual do canvas no canto superior esquerdo da célula.
+//
+// Cada fragmento é independente: um pacote perdido só deixa aquela faixa
+// na qualidade anterior (e os refinos sobre ela ficam aproximados).
+
+#define COSMIC_PROG_MAX_LAYERS 8           // Camadas por imagem (base + refinos + ROIs)
+#define COSMIC_PROG_MAX_LEVEL  4           // Base de até 16x16 pixels por célula
+#define COSMIC_PROG_HEADER     13          // Bytes fixos do payload
+#define COSMIC_PROG_MIN_MTU    (HEADER_MAX_SIZE + COSMIC_PROG_HEADER + 8)
+
+#define PROG_FLAG_BASE         0x80
+#define PROG_LEVEL_MASK        0x07
+
+// Códigos de retorno de uppkg_prog
+#define COSMIC_PROG_NEED_BASE  -2          // Refino de uma imagem cuja base não chegou
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+/**
+ * @brief Uma camada do plano de envio; retângulo em células do nível
+ */
+struct CosmicProgLayer {
+    uint8_t level;
+    uint8_t step;
+    uint8_t x, y, w, h;
+    bool base;
+};
+
+/**
+ * @brief Estado do nó durante o envio de uma imagem
+ *
+ * pixels precisa continuar válido até o último ppkg_prog da imagem.
+ */
+struct CosmicProgEncoder {
+    const uint8_t* pixels;
+    uint8_t width;
+    uint8_t height;
+    uint8_t img_id;                        // Incrementado a cada cosmic_prog_begin
+    uint8_t mtu;                           // Maior pacote gerado
+    uint8_t layers;                        // Camadas planejadas
+    uint8_t layer;                         // Camada em envio
+    uint16_t next;                         // Próxima célula da camada em envio
+    CosmicProgLayer plan[COSMIC_PROG_MAX_LAYERS];
+    uint8_t canvas[MAX_IMAGE_SIZE];        // Espelho da reconstrução do gateway
+};
+
+/**
+ * @brief Reconstrução no gateway (uma por dispositivo)
+ */
+struct CosmicProgImage {
+    uint8_t img_id;
+    uint8_t width;
+    uint8_t height;
+    bool have_base;                        // Algum fragmento da base desta imagem chegou
+    uint8_t level;                         // Nível mais fino já aplicado
+    uint16_t packets;                      // Fragmentos aplicados desta imagem
+    uint8_t pixels[MAX_IMAGE_SIZE];
+};
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+static inline uint8_t _prog_cells(uint8_t dim, uint8_t level) {
+    return (uint8_t)((dim + (1 << level) - 1) >> level);
+}
+
+/**
+ * @brief Média arredondada dos pixels de uma célula (cortada na borda)
+ */
+static uint8_t _prog_cell_mean(const uint8_t* pixels, uint8_t width, uint8_t height,
+                               uint8_t level, uint8_t cx, uint8_t cy) {
+    uint16_t x0 = (uint16_t)cx << level, y0 = (uint16_t)cy << level;
+    uint16_t x1 = x0 + (1 << level), y1 = y0 + (1 << level);
+    if (x1 > width) x1 = width;
+    if (y1 > height) y1 = height;
+    uint32_t sum = 0;
+    for (uint16_t y = y0; y < y1; y++) {
+        const uint8_t* row = pixels + y * width;
+        for (uint16_t x = x0; x < x1; x++) sum += row[x];
+    }
+    uint16_t count = (uint16_t)((x1 - x0) * (y1 - y0));
+    return (uint8_t)((sum + count / 2) / count);
+}
+
+static void _prog_fill(uint8_t* canvas, uint8_t width, uint8_t height, uint8_t level,
+                       uint8_t cx, uint8_t cy, uint8_t v) {
+    uint16_t x0 = (uint16_t)cx << level, y0 = (uint16_t)cy << level;
+    uint16_t x1 = x0 + (1 << level), y1 = y0 + (1 << level);
+    if (x1 > width) x1 = width;
+    if (y1 > height) y1 = height;
+    for (uint16_t y = y0; y < y1; y++) memset(canvas + y * width + x0, v, x1 - x0);
+}
+
+/**
+ * @brief Resíduo dividido pelo passo, arredondado ao mais próximo
+ */
+static inline int16_t _prog_quant(int16_t d, uint8_t step) {
+    return d >= 0 ? (int16_t)((d + step / 2) / step) : (int16_t)-((-d + step / 2) / step);
+}
+
+static inline uint8_t _prog_clamp(int16_t v) {
+    return v < 0 ? 0 : v > 255 ? 255 : (uint8_t)v;
+}
+
+/**
+ * @brief Tamanho em bits de n em Exp-Golomb de ordem 0
+ */
+static inline uint8_t _prog_eg_bits(uint32_t n) {
+    uint8_t k = 0;
+    while ((n + 1) >> (k + 1)) k++;
+    return (uint8_t)(2 * k + 1);
+}
+
+/**
+ * @brief Escreve os nbits mais baixos de v, MSB primeiro (out já zerado)
+ */
+static void _prog_put_bits(uint8_t* out, uint32_t* bit, uint32_t v, uint8_t nbits) {
+    while (nbits--) {
+        if ((v >> nbits) & 1) out[*bit >> 3] |= (uint8_t)(0x80 >> (*bit & 7));
+        (*bit)++;
+    }
+}
+
+static void _prog_put_eg(uint8_t* out, uint32_t* bit, uint32_t n) {
+    uint8_t k = _prog_eg_bits(n) / 2;
+    *bit += k;                             // Prefixo de zeros
+    _prog_put_bits(out, bit, n + 1, k + 1);
+}
+
+/**
+ * @brief Lê um Exp-Golomb de ordem 0
+ * @return 1 se lido, 0 no fim do fluxo (só zeros até limit), -1 se truncado
+ */
+static int _prog_get_eg(_HuffBitReader* br, uint32_t limit, uint32_t* n) {
+    uint8_t k = 0;
+    while (br->pos < limit && !_huff_peek(br, 1)) {
+        br->pos++;
+        if (++k > 16) return -1;
+    }
+    if (br->pos >= limit) return 0;
+    if (br->pos + k + 1 > limit) return -1;
+    *n = _huff_peek(br, k + 1) - 1;
+    br->pos += k + 1;
+    return 1;
+}
+
+/**
+ * @brief Aplica o resíduo r à célula i da camada (igual no nó e no gateway)
+ * @param prev Predição da base (atualizada); ignorada nos refinos
+ */
+static void _prog_apply(uint8_t* canvas, uint8_t width, uint8_t height, const CosmicProgLayer* l,
+                        uint16_t i, int16_t r, uint8_t* prev) {
+    uint8_t cx = (uint8_t)(l->x + i % l->w), cy = (uint8_t)(l->y + i / l->w);
+    if (l->base) {
+        *prev = _prog_clamp(*prev + r);
+        _prog_fill(canvas, width, height, l->level, cx, cy, *prev);
+    } else if (r) {
+        uint8_t* p = canvas + ((uint16_t)cy << l->level) * width + ((uint16_t)cx << l->level);
+        _prog_fill(canvas, width, height, l->level, cx, cy, _prog_clamp(*p + r * l->step));
+    }
+}
+
+static bool _prog_add(CosmicProgEncoder* enc, uint8_t level, uint8_t step, uint8_t x, uint8_t y,
+                      uint8_t w, uint8_t h, bool base) {
+    if (enc->layers >= COSMIC_PROG_MAX_LAYERS || level > COSMIC_PROG_MAX_LEVEL || step == 0 || !w || !h) return false;
+    CosmicProgLayer* l = &enc->plan[enc->layers++];
+    l->level = level;
+    l->step = step;
+    l->x = x;
+    l->y = y;
+    l->w = w;
+    l->h = h;
+    l->base = base;
+    return true;
+}
+
+// =================================================================================
+// API PÚBLICA - NÓ
+// =================================================================================
+
+/**
+ * @brief cosmic_prog_init - Estado inicial do nó (nenhuma imagem em envio)
+ */
+void cosmic_prog_init(CosmicProgEncoder* enc) {
+    memset(enc, 0, sizeof(*enc));
+}
+
+/**
+ * @brief cosmic_prog_begin - Começa uma imagem e planeja a camada base
+ * @param enc Estado do nó (img_id continua da imagem anterior)
+ * @param pixels Imagem 8-bit (mantida pelo chamador durante o envio)
+ * @param width Largura
+ * @param height Altura (width * height <= MAX_IMAGE_SIZE)
+ * @param base_level Células da base com 2^base_level pixels de lado (0-COSMIC_PROG_MAX_LEVEL)
+ * @param mtu Maior pacote (0 = COSMIC_MAX_PACKET; mínimo COSMIC_PROG_MIN_MTU)
+ * @return 1 se ok, 0 se parâmetros inválidos
+ */
+int cosmic_prog_begin(CosmicProgEncoder* enc, const uint8_t* pixels, uint8_t width, uint8_t height,
+                      uint8_t base_level, uint8_t mtu) {
+    if (mtu == 0) mtu = COSMIC_MAX_PACKET;
+#if COSMIC_MAX_PACKET < 255
+    if (mtu > COSMIC_MAX_PACKET) mtu = COSMIC_MAX_PACKET;
+#endif
+    if (!width || !height || (uint16_t)width * height > MAX_IMAGE_SIZE || mtu < COSMIC_PROG_MIN_MTU) return 0;
+    enc->pixels = pixels;
+    enc->width = width;
+    enc->height = height;
+    enc->img_id++;
+    enc->mtu = mtu;
+    enc->layers = 0;
+    enc->layer = 0;
+    enc->next = 0;
+    memset(enc->canvas, 128, sizeof(enc->canvas));
+    return _prog_add(enc, base_level, 1, 0, 0, _prog_cells(width, base_level), _prog_cells(height, base_level), true);
+}
+
+/**
+ * @brief cosmic_prog_add_refine - Acrescenta um refino da imagem inteira
+ * @param level Nível do refino (menor que o das camadas anteriores; 0 = pixel)
+ * @param step Passo de quantização do resíduo (1 = exato)
+ * @return 1 se ok, 0 se o plano está cheio ou parâmetros inválidos
+ */
+int cosmic_prog_add_refine(CosmicProgEncoder* enc, uint8_t level, uint8_t step) {
+    return _prog_add(enc, level, step, 0, 0, _prog_cells(enc->width, level), _prog_cells(enc->height, level), false);
+}
+
+/**
+ * @brief cosmic_prog_add_roi - Acrescenta um retângulo em resolução total e exato
+ *
+ * Deve vir depois dos refinos da imagem inteira (um refino posterior
+ * sobrescreveria o detalhe da região).
+ *
+ * @return 1 se ok, 0 se o plano está cheio ou o retângulo fica fora da imagem
+ */
+int cosmic_prog_add_roi(CosmicProgEncoder* enc, uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+    if (x >= enc->width || y >= enc->height) return 0;
+    if (w > enc->width - x) w = enc->width - x;
+    if (h > enc->height - y) h = enc->height - y;
+    return _prog_add(enc, 0, 1, x, y, w, h, false);
+}
+
+/**
+ * @brief cosmic_prog_done - Todas as camadas planejadas já foram empacotadas?
+ */
+bool cosmic_prog_done(const CosmicProgEncoder* enc) {
+    return enc->layer >= enc->layers;
+}
+
+/**
+ * @brief ppkg_prog - Empacota o próximo fragmento do plano
+ *
+ * Cada chamada gera um pacote de até enc->mtu bytes com o máximo de
+ * células da camada atual. Parar antes do fim só perde detalhe.
+ *
+ * @param enc Estado do nó
+ * @param nid Network ID
+ * @param did Device ID
+ * @return Pacote (PKG_TYPE_IMAGE, COMPRESS_IMG_PROG); size 0 quando o plano acabou
+ */
+CosmicPacket ppkg_prog(CosmicProgEncoder* enc, uint8_t nid, uint16_t did) {
+    CosmicPacket none = { _c_buffer, 0, PKG_TYPE_IMAGE, COMPRESS_IMG_PROG };
+    if (cosmic_prog_done(enc)) return none;
+
+    COSMIC_TIMER_START(t);
+    const CosmicProgLayer* l = &enc->plan[enc->layer];
+    uint8_t hlen = _prepare_header(nid, did, PKG_TYPE_IMAGE, COMPRESS_IMG_PROG);
+    uint8_t* out = _c_buffer + hlen;
+    uint8_t* tokens = out + COSMIC_PROG_HEADER;
+    int room = enc->mtu - hlen - COSMIC_PROG_HEADER;
+    uint32_t bit = 0;
+    memset(tokens, 0, room);
+
+    uint16_t total = (uint16_t)l->w * l->h;
+    uint16_t first = enc->next, i = first, run = 0;
+    uint8_t prev = 128;
+    while (i < total) {
+        uint8_t cx = (uint8_t)(l->x + i % l->w), cy = (uint8_t)(l->y + i / l->w);
+        uint8_t target = _prog_cell_mean(enc->pixels, enc->width, enc->height, l->level, cx, cy);
+        uint8_t pred = l->base ? prev
+                               : enc->canvas[((uint16_t)cy << l->level) * enc->width + ((uint16_t)cx << l->level)];
+        int16_t r = _prog_quant((int16_t)target - pred, l->step);
+        if (r) {
+            uint16_t mag = (uint16_t)(r < 0 ? -r : r);
+            if (bit + _prog_eg_bits(run) + 1 + _prog_eg_bits(mag - 1) > (uint32_t)room * 8) break;
+            _prog_put_eg(tokens, &bit, run);
+            _prog_put_bits(tokens, &bit, r < 0, 1);
+            _prog_put_eg(tokens, &bit, mag - 1);
+            run = 0;
+        } else {
+            run++;
+        }
+        _prog_apply(enc->canvas, enc->width, enc->height, l, i, r, &prev);
+        i++;
+    }
+
+    out[0] = enc->img_id;
+    out[1] = enc->width;
+    out[2] = enc->height;
+    out[3] = (l->base ? PROG_FLAG_BASE : 0) | l->level;
+    out[4] = l->step;
+    out[5] = l->x;
+    out[6] = l->y;
+    out[7] = l->w;
+    out[8] = l->h;
+    out[9] = (uint8_t)first;
+    out[10] = (uint8_t)(first >> 8);
+    out[11] = (uint8_t)(i - first);
+    out[12] = (uint8_t)((i - first) >> 8);
+
+    enc->next = i;
+    if (i == total) {
+        enc->layer++;
+        enc->next = 0;
+    }
+    COSMIC_TIMER_STOP(COSMIC_STAGE_IMAGE, t);
+    return _finish_packet(nid, PKG_TYPE_IMAGE, COMPRESS_IMG_PROG, hlen + COSMIC_PROG_HEADER + (bit + 7) / 8);
+}
+
+// =================================================================================
+// API PÚBLICA - GATEWAY
+// =================================================================================
+
+/**
+ * @brief cosmic_prog_image_init - Reconstrução vazia (nenhuma imagem)
+ */
+void cosmic_prog_image_init(CosmicProgImage* img) {
+    memset(img, 0, sizeof(*img));
+}
+
+/**
+ * @brief uppkg_prog - Aplica um fragmento à reconstrução do dispositivo
+ *
+ * Um fragmento da base com img_id novo começa outra imagem (canvas em
+ * 128). img->pixels é sempre uma imagem completa width x height.
+ *
+ * @param img Reconstrução mantida pelo gateway para este dispositivo
+ * @param packet Pacote recebido (já descriptografado se necessário)
+ * @param packet_size Tamanho do pacote
+ * @return Células atualizadas, -1 se inválido, ou COSMIC_PROG_NEED_BASE
+ */
+int uppkg_prog(CosmicProgImage* img, const uint8_t* packet, uint8_t packet_size) {
+    CosmicHeader hdr;
+    uint8_t hlen = cosmic_parse_header(packet, packet_size, &hdr);
+    if (hlen == 0 || packet_size < hlen + COSMIC_PROG_HEADER) return -1;
+    if (hdr.type != PKG_TYPE_IMAGE || hdr.mode != COMPRESS_IMG_PROG) return -1;
+
+    const uint8_t* in = packet + hlen;
+    int avail = packet_size - hlen;
+    CosmicProgLayer l;
+    uint8_t id = in[0], width = in[1], height = in[2];
+    l.base = (in[3] & PROG_FLAG_BASE) != 0;
+    l.level = in[3] & PROG_LEVEL_MASK;
+    l.step = in[4];
+    l.x = in[5];
+    l.y = in[6];
+    l.w = in[7];
+    l.h = in[8];
+    uint16_t first = in[9] | (in[10] << 8);
+    uint16_t count = in[11] | (in[12] << 8);
+    uint16_t total = (uint16_t)l.w * l.h;
+    if (!width || !height || (uint16_t)width * height > MAX_IMAGE_SIZE || l.level > COSMIC_PROG_MAX_LEVEL ||
+        l.step == 0 || l.x + l.w > _prog_cells(width, l.level) || l.y + l.h > _prog_cells(height, l.level) ||
+        first + count > total) {
+        return -1;
+    }
+
+    bool same = img->have_base && id == img->img_id && width == img->width && height == img->height;
+    if (!same) {
+        if (!l.base) return COSMIC_PROG_NEED_BASE;
+        img->img_id = id;
+        img->width = width;
+        img->height = height;
+        img->have_base = true;
+        img->level = l.level;
+        img->packets = 0;
+        memset(img->pixels, 128, sizeof(img->pixels));
+    }
+
+    COSMIC_TIMER_START(t);
+    _HuffBitReader br = { in + COSMIC_PROG_HEADER, (uint16_t)(avail - COSMIC_PROG_HEADER), 0 };
+    uint32_t limit = (uint32_t)br.size * 8;
+    uint16_t i = first, end = first + count;
+    uint8_t prev = 128;
+    uint32_t run, mag;
+    int rc;
+    while ((rc = _prog_get_eg(&br, limit, &run)) == 1) {
+        if (run > (uint32_t)(end - i)) return -1;
+        for (uint16_t k = i + run; i < k; i++) _prog_apply(img->pixels, width, height, &l, i, 0, &prev);
+        if (i >= end || br.pos >= limit) return -1;
+        bool negative = _huff_peek(&br, 1);
+        br.pos++;
+        if (_prog_get_eg(&br, limit, &mag) != 1 || mag > 255) return -1;
+        int16_t r = (int16_t)(mag + 1);
+        _prog_apply(img->pixels, width, height, &l, i++, negative ? -r : r, &prev);
+    }
+    if (rc < 0) return -1;
+    for (; i < end; i++) _prog_apply(img->pixels, width, height, &l, i, 0, &prev);
+    COSMIC_TIMER_STOP(COSMIC_STAGE_IMAGE, t);
+
+    if (l.level < img->level) img->level = l.level;
+    img->packets++;
+    COSMIC_STAT_INC(packets_rx);
+    return count;
+}
+
+#endif // COSMIC_PROGRESSIVE_H
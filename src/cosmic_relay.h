@@ -0,0 +1,177 @@
+#ifndef COSMIC_RELAY_H
+#define COSMIC_RELAY_H
+
+#include "cosmic_payload.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+//
+// Retransmissão: o nó gera pacotes com setCosmicHeaderFormat(true, ...) e
+// setCosmicRelayTtl(n). O repetidor chama cosmic_relay_forward() sobre o
+// buffer recebido e, se retornar COSMIC_RELAY_FORWARD, transmite o mesmo
+// buffer: só o byte de extensão muda, payload e cifra ficam intactos.
+// Gateways usam cosmic_relay_accept() para descartar cópias que chegam por
+// vários repetidores.
+
+#define COSMIC_DEDUP_WAYS      4           // Entradas por conjunto (LRU dentro do conjunto)
+#define COSMIC_DEDUP_WINDOW_MS 30000       // Janela padrão em que o mesmo pacote é duplicata
+
+#define COSMIC_DEDUP_SETS (COSMIC_DEDUP_ENTRIES / COSMIC_DEDUP_WAYS)
+#if (COSMIC_DEDUP_SETS == 0) || (COSMIC_DEDUP_SETS & (COSMIC_DEDUP_SETS - 1))
+#error "COSMIC_DEDUP_ENTRIES / COSMIC_DEDUP_WAYS deve ser potência de 2"
+#endif
+
+// Códigos de retorno de cosmic_relay_forward
+#define COSMIC_RELAY_FORWARD    1          // TTL atualizado: retransmitir o buffer
+#define COSMIC_RELAY_DUPLICATE -2          // Já visto dentro da janela
+#define COSMIC_RELAY_EXPIRED   -3          // TTL esgotado
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+struct CosmicDedupEntry {
+    uint32_t fingerprint;                  // 0 = vazio
+    uint32_t seen_ms;
+};
+
+/**
+ * @brief Cache de pacotes já vistos (associativo por conjunto, O(1))
+ *
+ * O contador de pacotes não trafega no ar, então a identidade do pacote é
+ * um hash de cabeçalho + payload (sem o byte de TTL). Com criptografia
+ * cada pacote já é único; sem ela, o byte de sequência da extensão separa
+ * leituras idênticas do mesmo dispositivo. Pacotes sem extensão e sem
+ * cifra só se distinguem pelo conteúdo dentro da janela.
+ */
+struct CosmicDedupCache {
+    CosmicDedupEntry entries[COSMIC_DEDUP_ENTRIES];
+    uint32_t window_ms;
+};
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+/**
+ * @brief Posição do byte de extensão no pacote, ou 0 se não houver
+ */
+static uint8_t _relay_ext_offset(const uint8_t* packet, uint8_t packet_size) {
+    if (packet_size < 2) return 0;
+    uint8_t b0 = packet[0];
+    if ((b0 & HDR_MARKER_MASK) != HDR_COMPACT_MARKER || !(b0 & HDR_FLAG_EXT)) return 0;
+
+    uint8_t pos = _hdr_layout[(b0 >> 3) & 0x03][1];
+    return pos < packet_size ? pos : 0;
+}
+
+// =================================================================================
+// API PÚBLICA - CACHE DE DUPLICATAS
+// =================================================================================
+
+/**
+ * @brief Inicializa o cache
+ * @param cache Cache a inicializar
+ * @param window_ms Janela de duplicata (0 = COSMIC_DEDUP_WINDOW_MS)
+ */
+void cosmic_dedup_init(CosmicDedupCache* cache, uint32_t window_ms) {
+    memset(cache->entries, 0, sizeof(cache->entries));
+    cache->window_ms = window_ms ? window_ms : COSMIC_DEDUP_WINDOW_MS;
+}
+
+/**
+ * @brief Identidade do pacote para o cache (FNV-1a, ignora o byte de TTL, inclui a sequência)
+ * @param packet Pacote como recebido (cifrado ou não)
+ * @param packet_size Tamanho do pacote
+ * @return Hash diferente de zero
+ */
+uint32_t cosmic_packet_fingerprint(const uint8_t* packet, uint8_t packet_size) {
+    uint8_t skip = _relay_ext_offset(packet, packet_size);
+    uint32_t h = 2166136261UL;
+    for (uint8_t i = 0; i < packet_size; i++) {
+        if (skip && i == skip) continue;
+        h = (h ^ packet[i]) * 16777619UL;
+    }
+    return h ? h : 1;
+}
+
+/**
+ * @brief cosmic_dedup_seen - Consulta e registra uma identidade
+ * @param cache Cache
+ * @param fingerprint Valor de cosmic_packet_fingerprint
+ * @return true se já foi vista dentro da janela (duplicata)
+ */
+bool cosmic_dedup_seen(CosmicDedupCache* cache, uint32_t fingerprint) {
+    uint32_t now = millis();
+    CosmicDedupEntry* set = cache->entries + (fingerprint & (COSMIC_DEDUP_SETS - 1)) * COSMIC_DEDUP_WAYS;
+
+    uint8_t hit = COSMIC_DEDUP_WAYS - 1;   // Sem acerto: descarta o menos recente
+    bool seen = false;
+    for (uint8_t i = 0; i < COSMIC_DEDUP_WAYS; i++) {
+        if (set[i].fingerprint == fingerprint) {
+            seen = (now - set[i].seen_ms) < cache->window_ms;
+            hit = i;
+            break;
+        }
+    }
+
+    // Move para a frente do conjunto (mais recente)
+    for (uint8_t i = hit; i > 0; i--) {
+        set[i] = set[i - 1];
+    }
+    set[0].fingerprint = fingerprint;
+    set[0].seen_ms = now;
+    return seen;
+}
+
+// =================================================================================
+// API PÚBLICA - RETRANSMISSÃO
+// =================================================================================
+
+/**
+ * @brief cosmic_relay_forward - Decide a retransmissão e atualiza o TTL no próprio buffer
+ * @param cache Cache de duplicatas do repetidor
+ * @param packet Pacote recebido (não é descriptografado nem copiado)
+ * @param packet_size Tamanho do pacote
+ * @return COSMIC_RELAY_FORWARD, COSMIC_RELAY_DUPLICATE, COSMIC_RELAY_EXPIRED,
+ *         ou -1 se o pacote não tem campo de retransmissão
+ */
+int cosmic_relay_forward(CosmicDedupCache* cache, uint8_t* packet, uint8_t packet_size) {
+    uint8_t pos = _relay_ext_offset(packet, packet_size);
+    if (pos == 0) return -1;
+
+    if (cosmic_dedup_seen(cache, cosmic_packet_fingerprint(packet, packet_size))) {
+        return COSMIC_RELAY_DUPLICATE;
+    }
+
+    uint8_t ext = packet[pos];
+    uint8_t ttl = ext & RELAY_TTL_MASK;
+    uint8_t hops = ext >> RELAY_HOPS_SHIFT;
+    if (ttl == 0) return COSMIC_RELAY_EXPIRED;
+
+    if (hops < (0xFF >> RELAY_HOPS_SHIFT)) hops++;
+    packet[pos] = (uint8_t)((hops << RELAY_HOPS_SHIFT) | (ttl - 1));
+    return COSMIC_RELAY_FORWARD;
+}
+
+/**
+ * @brief cosmic_relay_accept - Filtro do gateway: aceita cada pacote uma única vez
+ * @param cache Cache de duplicatas do gateway
+ * @param packet Pacote recebido (antes de decrypt_packet)
+ * @param packet_size Tamanho do pacote
+ * @return true se é a primeira cópia e deve ser processada
+ */
+bool cosmic_relay_accept(CosmicDedupCache* cache, const uint8_t* packet, uint8_t packet_size) {
+    return !cosmic_dedup_seen(cache, cosmic_packet_fingerprint(packet, packet_size));
+}
+
+/**
+ * @brief Número de repetições já feitas (0 se veio direto do nó ou sem campo)
+ */
+uint8_t cosmic_relay_hops(const uint8_t* packet, uint8_t packet_size) {
+    uint8_t pos = _relay_ext_offset(packet, packet_size);
+    return pos ? (packet[pos] >> RELAY_HOPS_SHIFT) : 0;
+}
+
+#endif // COSMIC_RELAY_H
@@ -0,0 +1,291 @@
+#ifndef COSMIC_RING_H
+#define COSMIC_RING_H
+
+#include "cosmic_payload.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+//
+// Anéis de quadros de tamanho fixo entre a recepção do rádio e a
+// decodificação, sem travas:
+//
+//   CosmicSpscRing - nó: um produtor (ISR de RX) e um consumidor (loop).
+//                    Índices de 8 bits, atômicos em qualquer MCU.
+//   CosmicMpmcRing - gateway Linux: vários produtores (threads do
+//                    concentrador) e vários consumidores (decodificadores),
+//                    fila limitada com número de sequência por posição.
+//
+// Os dois permitem gravar/ler o quadro direto na posição (reserve/commit e
+// peek/release), sem cópia intermediária, e consumir em lote.
+
+#if MAX_COSMIC_BUFFER > 255
+#define COSMIC_FRAME_SIZE 255              // Maior quadro LoRa
+#else
+#define COSMIC_FRAME_SIZE MAX_COSMIC_BUFFER
+#endif
+
+#if (COSMIC_RING_SLOTS & (COSMIC_RING_SLOTS - 1)) || COSMIC_RING_SLOTS > 128
+#error "COSMIC_RING_SLOTS deve ser potência de 2 (máx 128)"
+#endif
+#define COSMIC_RING_MASK (COSMIC_RING_SLOTS - 1)
+
+#define COSMIC_ALIGNED __attribute__((aligned(COSMIC_CACHE_LINE)))
+
+// Ordem de memória entre ISR/threads: no AVR (núcleo único, acesso de 8 bits
+// atômico) basta impedir o compilador de reordenar
+#if defined(__AVR__)
+#define COSMIC_LOAD_ACQUIRE(p)     (*(volatile __typeof__(*(p))*)(p))
+#define COSMIC_STORE_RELEASE(p, v) do { __asm__ __volatile__("" ::: "memory"); \
+                                        *(volatile __typeof__(*(p))*)(p) = (v); } while (0)
+#else
+#define COSMIC_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define COSMIC_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+/**
+ * @brief Quadro recebido com metadados do rádio
+ */
+struct CosmicFrame {
+    uint8_t size;
+    int8_t snr;                            // SNR em dB
+    int16_t rssi;                          // RSSI em dBm
+    uint8_t data[COSMIC_FRAME_SIZE];
+};
+
+/**
+ * @brief Anel produtor único / consumidor único (ISR -> loop principal)
+ *
+ * tail só é escrito pelo produtor e head só pelo consumidor; cada um fica
+ * na sua linha de cache para não haver compartilhamento falso.
+ */
+struct CosmicSpscRing {
+    COSMIC_ALIGNED uint8_t head;           // Próximo a consumir
+    COSMIC_ALIGNED uint8_t tail;           // Próximo a produzir
+    uint16_t dropped;                      // Quadros perdidos com o anel cheio (produtor)
+    COSMIC_ALIGNED CosmicFrame slots[COSMIC_RING_SLOTS];
+};
+
+// =================================================================================
+// API PÚBLICA - SPSC (NÓ)
+// =================================================================================
+
+/**
+ * @brief Inicializa o anel
+ */
+void cosmic_spsc_init(CosmicSpscRing* r) {
+    r->head = 0;
+    r->tail = 0;
+    r->dropped = 0;
+}
+
+/**
+ * @brief cosmic_spsc_reserve - Produtor: posição livre para gravar o quadro
+ *
+ * Na ISR: frame = reserve(); lê o FIFO do rádio em frame->data; preenche
+ * size/rssi/snr; commit(). Sem posição livre o quadro é contado em dropped.
+ *
+ * @return Posição a preencher, ou NULL se o anel está cheio
+ */
+CosmicFrame* cosmic_spsc_reserve(CosmicSpscRing* r) {
+    uint8_t tail = r->tail;
+    if ((uint8_t)(tail - COSMIC_LOAD_ACQUIRE(&r->head)) >= COSMIC_RING_SLOTS) {
+        r->dropped++;
+        return NULL;
+    }
+    return &r->slots[tail & COSMIC_RING_MASK];
+}
+
+/**
+ * @brief Produtor: publica o quadro reservado
+ */
+void cosmic_spsc_commit(CosmicSpscRing* r) {
+    COSMIC_STORE_RELEASE(&r->tail, (uint8_t)(r->tail + 1));
+}
+
+/**
+ * @brief cosmic_spsc_push - Produtor: copia um quadro para o anel
+ * @return 1 se enfileirado, 0 se o anel está cheio
+ */
+int cosmic_spsc_push(CosmicSpscRing* r, const uint8_t* data, uint8_t size, int16_t rssi, int8_t snr) {
+#if COSMIC_FRAME_SIZE < 255
+    if (size > COSMIC_FRAME_SIZE) return 0;
+#endif
+    CosmicFrame* frame = cosmic_spsc_reserve(r);
+    if (!frame) return 0;
+
+    memcpy(frame->data, data, size);
+    frame->size = size;
+    frame->rssi = rssi;
+    frame->snr = snr;
+    cosmic_spsc_commit(r);
+    return 1;
+}
+
+/**
+ * @brief cosmic_spsc_peek_batch - Consumidor: quadros prontos, sem copiar
+ * @param r Anel
+ * @param frames Ponteiros para os quadros (saída, em ordem)
+ * @param max Máximo de quadros
+ * @return Número de quadros; liberar com cosmic_spsc_release(r, n) após o uso
+ */
+uint8_t cosmic_spsc_peek_batch(CosmicSpscRing* r, CosmicFrame** frames, uint8_t max) {
+    uint8_t head = r->head;
+    uint8_t avail = (uint8_t)(COSMIC_LOAD_ACQUIRE(&r->tail) - head);
+    if (avail > max) avail = max;
+    for (uint8_t i = 0; i < avail; i++) {
+        frames[i] = &r->slots[(uint8_t)(head + i) & COSMIC_RING_MASK];
+    }
+    return avail;
+}
+
+/**
+ * @brief Consumidor: próximo quadro pronto, ou NULL se vazio
+ */
+CosmicFrame* cosmic_spsc_peek(CosmicSpscRing* r) {
+    CosmicFrame* frame;
+    return cosmic_spsc_peek_batch(r, &frame, 1) ? frame : NULL;
+}
+
+/**
+ * @brief Consumidor: devolve n posições ao produtor
+ */
+void cosmic_spsc_release(CosmicSpscRing* r, uint8_t n) {
+    COSMIC_STORE_RELEASE(&r->head, (uint8_t)(r->head + n));
+}
+
+#if !defined(__AVR__)
+
+// =================================================================================
+// API PÚBLICA - MPMC (GATEWAY)
+// =================================================================================
+
+#ifndef COSMIC_MPMC_SLOTS
+#define COSMIC_MPMC_SLOTS 1024             // Potência de 2
+#endif
+#if COSMIC_MPMC_SLOTS & (COSMIC_MPMC_SLOTS - 1)
+#error "COSMIC_MPMC_SLOTS deve ser potência de 2"
+#endif
+
+/**
+ * @brief Posição do anel MPMC: seq indica de quem é a vez
+ *
+ * seq == pos: livre para o produtor da volta pos;
+ * seq == pos + 1: pronta para o consumidor.
+ */
+struct CosmicMpmcSlot {
+    uint32_t seq;
+    CosmicFrame frame;
+};
+
+struct CosmicMpmcRing {
+    COSMIC_ALIGNED uint32_t head;          // Disputado pelos consumidores
+    COSMIC_ALIGNED uint32_t tail;          // Disputado pelos produtores
+    COSMIC_ALIGNED uint32_t dropped;
+    COSMIC_ALIGNED CosmicMpmcSlot slots[COSMIC_MPMC_SLOTS];
+};
+
+/**
+ * @brief Inicializa o anel (chamar antes de iniciar as threads)
+ */
+void cosmic_mpmc_init(CosmicMpmcRing* r) {
+    for (uint32_t i = 0; i < COSMIC_MPMC_SLOTS; i++) {
+        r->slots[i].seq = i;
+    }
+    r->head = 0;
+    r->tail = 0;
+    r->dropped = 0;
+}
+
+/**
+ * @brief cosmic_mpmc_push - Produtor: copia um quadro para o anel
+ * @return 1 se enfileirado, 0 se o anel está cheio
+ */
+int cosmic_mpmc_push(CosmicMpmcRing* r, const uint8_t* data, uint8_t size, int16_t rssi, int8_t snr) {
+#if COSMIC_FRAME_SIZE < 255
+    if (size > COSMIC_FRAME_SIZE) return 0;
+#endif
+
+    uint32_t pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+    CosmicMpmcSlot* slot;
+    for (;;) {
+        slot = &r->slots[pos & (COSMIC_MPMC_SLOTS - 1)];
+        int32_t diff = (int32_t)(COSMIC_LOAD_ACQUIRE(&slot->seq) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&r->tail, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (diff < 0) {
+            __atomic_fetch_add(&r->dropped, 1, __ATOMIC_RELAXED);
+            return 0;
+        } else {
+            pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(slot->frame.data, data, size);
+    slot->frame.size = size;
+    slot->frame.rssi = rssi;
+    slot->frame.snr = snr;
+    COSMIC_STORE_RELEASE(&slot->seq, pos + 1);
+    return 1;
+}
+
+/**
+ * @brief cosmic_mpmc_claim - Consumidor: reserva até max quadros consecutivos prontos
+ *
+ * Os quadros ficam em cosmic_mpmc_frame(r, first + i) até
+ * cosmic_mpmc_release(r, first, n).
+ *
+ * @param r Anel
+ * @param first Posição do primeiro quadro reservado (saída)
+ * @param max Máximo de quadros
+ * @return Número de quadros reservados (0 se vazio)
+ */
+uint32_t cosmic_mpmc_claim(CosmicMpmcRing* r, uint32_t* first, uint32_t max) {
+    uint32_t pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+    for (;;) {
+        uint32_t n = 0;
+        while (n < max) {
+            const CosmicMpmcSlot* slot = &r->slots[(pos + n) & (COSMIC_MPMC_SLOTS - 1)];
+            if (COSMIC_LOAD_ACQUIRE(&slot->seq) != pos + n + 1) break;
+            n++;
+        }
+        if (n == 0) {
+            // Vazio, ou outro consumidor avançou head: recarrega e confere
+            uint32_t cur = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+            if (cur == pos) return 0;
+            pos = cur;
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&r->head, &pos, pos + n, true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            *first = pos;
+            return n;
+        }
+    }
+}
+
+/**
+ * @brief Quadro na posição reservada por cosmic_mpmc_claim
+ */
+CosmicFrame* cosmic_mpmc_frame(CosmicMpmcRing* r, uint32_t pos) {
+    return &r->slots[pos & (COSMIC_MPMC_SLOTS - 1)].frame;
+}
+
+/**
+ * @brief Consumidor: devolve as posições reservadas aos produtores
+ */
+void cosmic_mpmc_release(CosmicMpmcRing* r, uint32_t first, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        CosmicMpmcSlot* slot = &r->slots[(first + i) & (COSMIC_MPMC_SLOTS - 1)];
+        COSMIC_STORE_RELEASE(&slot->seq, first + i + COSMIC_MPMC_SLOTS);
+    }
+}
+
+#endif // !__AVR__
+
+#endif // COSMIC_RING_H
@@ -0,0 +1,365 @@
+#ifndef COSMIC_SCHEDULER_H
+#define COSMIC_SCHEDULER_H
+
+#include "cosmic_payload.h"
+#include "cosmic_airtime.h"
+#include "cosmic_aggregate.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+//
+// Fila de transmissão com prioridade por tipo e controle de duty cycle.
+// Todas as funções recebem o instante atual (now_ms) em vez de chamar
+// millis(), então a mesma lógica roda no nó e em simulação no Linux.
+//
+// Duty cycle: balde de fichas em microssegundos de tempo no ar. A cada ms
+// entram duty_permille µs (1% = 10 -> 10 µs por ms); o balde guarda no
+// máximo COSMIC_DUTY_WINDOW_MS de crédito. Um pacote só sai se houver
+// fichas para todo o seu tempo no ar.
+//
+// Cifra: cosmic_sched_ppkg enfileira o pacote em claro e a cifra é
+// aplicada em cosmic_sched_poll, depois da agregação, com o contador na
+// ordem de transmissão. Pacotes de ppkg* passados a cosmic_sched_push já
+// vêm cifrados quando a cifra está habilitada: saem como estão e não são
+// agregados.
+
+#define COSMIC_DUTY_WINDOW_MS   3600000UL  // Janela regulatória (1 h)
+
+// Prioridades (menor sai primeiro)
+#define COSMIC_PRIO_URGENT      0
+#define COSMIC_PRIO_HIGH        1
+#define COSMIC_PRIO_NORMAL      2
+#define COSMIC_PRIO_BULK        3
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+struct CosmicTxSlot {
+    uint8_t data[MAX_COSMIC_BUFFER];
+    uint8_t size;                          // 0 = posição livre
+    uint8_t type;
+    uint8_t mode;
+    uint8_t prio;
+    bool plain;                            // Enfileirado sem cifra (pode ser agregado; cifrado no poll)
+    uint8_t nid;                           // Network ID do IV da cifra
+    uint32_t seq;                          // Ordem de chegada (FIFO dentro da prioridade)
+};
+
+/**
+ * @brief Estado do escalonador (memória fixa: COSMIC_TXQ_SLOTS pacotes)
+ */
+struct CosmicScheduler {
+    CosmicTxSlot slots[COSMIC_TXQ_SLOTS];
+    CosmicAggregator agg;                  // Agrupamento de telemetria com canal ocupado
+    LoraRadioConfig radio;
+    uint8_t prio_by_type[16];              // Indexado pelo nibble alto de PKG_TYPE_*
+    uint8_t nid;                           // Cabeçalho dos quadros agregados
+    uint16_t did;
+    uint16_t duty_permille;
+    uint32_t tokens_us;
+    uint32_t bucket_us;
+    uint32_t last_ms;
+    uint32_t next_seq;
+    uint8_t sent_slot;                     // Posição entregue por cosmic_sched_poll
+};
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+/**
+ * @brief Credita as fichas do tempo decorrido
+ */
+static void _sched_refill(CosmicScheduler* s, uint32_t now_ms) {
+    uint32_t elapsed = now_ms - s->last_ms;
+    s->last_ms = now_ms;
+
+    uint32_t room = s->bucket_us - s->tokens_us;
+    if (s->duty_permille == 0) return;
+    if (elapsed >= room / s->duty_permille) {
+        s->tokens_us = s->bucket_us;
+    } else {
+        s->tokens_us += elapsed * s->duty_permille;
+    }
+}
+
+/**
+ * @brief Posição com maior prioridade (e mais antiga), ou -1 se vazia
+ */
+static int _sched_head(const CosmicScheduler* s) {
+    int best = -1;
+    for (int i = 0; i < COSMIC_TXQ_SLOTS; i++) {
+        const CosmicTxSlot* slot = &s->slots[i];
+        if (slot->size == 0) continue;
+        if (best < 0 || slot->prio < s->slots[best].prio ||
+            (slot->prio == s->slots[best].prio && (int32_t)(slot->seq - s->slots[best].seq) < 0)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Cifra um pacote enfileirado em claro com o contador atual
+ *
+ * No formato misto o teste do marcador depende do contador, que só agora
+ * é conhecido: um cabeçalho legado pode virar compacto (nunca cresce).
+ * @return 0 se o cabeçalho é inválido (o pacote não pode sair em claro)
+ */
+static int _sched_encrypt(CosmicTxSlot* slot) {
+    if (!slot->plain || !_encryption_enabled) return 1;
+    CosmicHeader hdr;
+    if (!cosmic_parse_header(slot->data, slot->size, &hdr)) return 0;
+
+    if (!hdr.compact && _legacy_looks_compact(slot->nid)) {
+        uint8_t head[HEADER_SIZE];
+        uint8_t len = 0;
+        head[len++] = HDR_COMPACT_MARKER;
+        head[len++] = (hdr.type & 0xF0) | (hdr.mode & 0x0F);
+        len += _put_varint(head + len, hdr.dev_id);
+        memmove(slot->data + len, slot->data + HEADER_SIZE, slot->size - HEADER_SIZE);
+        memcpy(slot->data, head, len);
+        slot->size = slot->size - HEADER_SIZE + len;
+        hdr.compact = true;
+        hdr.length = len;
+    }
+
+    // Mesma regra de _c_clear_len
+    uint8_t clear = hdr.compact && (_header_compact || _header_mixed) ? hdr.length : 0;
+    _apply_encryption(slot->data + clear, slot->size - clear, slot->nid);
+    slot->plain = false;
+    return 1;
+}
+
+/**
+ * @brief Copia o pacote para a fila
+ * @return 1 se enfileirado, 0 se recusado
+ */
+static int _sched_enqueue(CosmicScheduler* s, const CosmicPacket* pkg, uint8_t nid, bool plain) {
+    if (!pkg || pkg->size == 0) return 0;
+#if MAX_COSMIC_BUFFER < 255
+    if (pkg->size > MAX_COSMIC_BUFFER) return 0;
+#endif
+
+    uint8_t prio = s->prio_by_type[pkg->type >> 4];
+    int target = -1;
+    for (int i = 0; i < COSMIC_TXQ_SLOTS; i++) {
+        if (s->slots[i].size == 0 && i != s->sent_slot) { target = i; break; }
+    }
+    if (target < 0) {
+        // Vítima: menor prioridade, mais nova
+        for (int i = 0; i < COSMIC_TXQ_SLOTS; i++) {
+            const CosmicTxSlot* slot = &s->slots[i];
+            if (slot->size == 0 || slot->prio <= prio) continue;
+            if (target < 0 || slot->prio > s->slots[target].prio ||
+                (slot->prio == s->slots[target].prio && (int32_t)(slot->seq - s->slots[target].seq) > 0)) {
+                target = i;
+            }
+        }
+        if (target < 0) return 0;
+    }
+
+    CosmicTxSlot* slot = &s->slots[target];
+    memcpy(slot->data, pkg->data, pkg->size);
+    slot->size = pkg->size;
+    slot->type = pkg->type;
+    slot->mode = pkg->mode;
+    slot->prio = prio;
+    slot->plain = plain;
+    slot->nid = nid;
+    slot->seq = s->next_seq++;
+    return 1;
+}
+
+/**
+ * @brief Junta a telemetria em claro da fila em um único quadro agregado
+ * @return Número de pacotes agrupados (0 se menos de dois couberam; a fila fica intacta)
+ */
+static int _sched_coalesce(CosmicScheduler* s) {
+    int candidates = 0;
+    for (int i = 0; i < COSMIC_TXQ_SLOTS; i++) {
+        if (s->slots[i].size && s->slots[i].plain && s->slots[i].type == PKG_TYPE_TELEMETRY) candidates++;
+    }
+    if (candidates < 2) return 0;
+
+    cosmic_agg_init(&s->agg, 0);
+    uint8_t taken[COSMIC_TXQ_SLOTS];
+    int merged = 0;
+    uint32_t first_seq = 0;
+    for (int i = 0; i < COSMIC_TXQ_SLOTS; i++) {
+        CosmicTxSlot* slot = &s->slots[i];
+        if (!slot->size || !slot->plain || slot->type != PKG_TYPE_TELEMETRY) continue;
+        if (!cosmic_agg_add_packet(&s->agg, slot->data, slot->size)) continue;
+
+        if (merged == 0 || (int32_t)(slot->seq - first_seq) < 0) first_seq = slot->seq;
+        taken[merged++] = (uint8_t)i;
+    }
+    // Um registro só: o pacote original sai como está, sem o custo do agregado
+    if (merged < 2) {
+        cosmic_agg_init(&s->agg, 0);
+        return 0;
+    }
+    for (int i = 0; i < merged; i++) s->slots[taken[i]].size = 0;
+
+    // O quadro agregado ocupa a primeira posição liberada e herda a vez do mais
+    // antigo e a prioridade da telemetria que carrega; também é cifrado no poll
+    _cipher_dry_run = true;
+    CosmicPacket pkg = ppkg_aggregate(&s->agg, s->nid, s->did, true);
+    _cipher_dry_run = false;
+    CosmicTxSlot* out = &s->slots[taken[0]];
+    memcpy(out->data, pkg.data, pkg.size);
+    out->size = pkg.size;
+    out->type = pkg.type;
+    out->mode = pkg.mode;
+    out->prio = s->prio_by_type[PKG_TYPE_TELEMETRY >> 4];
+    out->plain = true;
+    out->nid = s->nid;
+    out->seq = first_seq;
+    return merged;
+}
+
+// =================================================================================
+// API PÚBLICA
+// =================================================================================
+
+/**
+ * @brief cosmic_sched_init - Inicializa fila e balde de duty cycle (balde cheio)
+ * @param s Escalonador
+ * @param radio Configuração do rádio (para o tempo no ar)
+ * @param duty_permille Duty cycle em milésimos (10 = 1%, 1 = 0.1%), 0 = sem limite
+ * @param nid Network ID dos quadros agregados
+ * @param did Device ID dos quadros agregados
+ * @param now_ms Instante atual
+ */
+void cosmic_sched_init(CosmicScheduler* s, const LoraRadioConfig* radio, uint16_t duty_permille,
+                       uint8_t nid, uint16_t did, uint32_t now_ms) {
+    memset(s, 0, sizeof(*s));
+    s->radio = *radio;
+    s->nid = nid;
+    s->did = did;
+    s->duty_permille = duty_permille;
+    s->bucket_us = duty_permille ? COSMIC_DUTY_WINDOW_MS * duty_permille : 0;
+    s->tokens_us = s->bucket_us;
+    s->last_ms = now_ms;
+    s->sent_slot = 0xFF;
+
+    memset(s->prio_by_type, COSMIC_PRIO_NORMAL, sizeof(s->prio_by_type));
+    s->prio_by_type[PKG_TYPE_COMMAND >> 4] = COSMIC_PRIO_URGENT;
+    s->prio_by_type[PKG_TYPE_STATUS >> 4] = COSMIC_PRIO_HIGH;
+    s->prio_by_type[PKG_TYPE_IMAGE >> 4] = COSMIC_PRIO_BULK;
+}
+
+/**
+ * @brief Altera a prioridade de um tipo de pacote
+ */
+void cosmic_sched_set_priority(CosmicScheduler* s, uint8_t type, uint8_t prio) {
+    s->prio_by_type[type >> 4] = prio;
+}
+
+/**
+ * @brief cosmic_sched_push - Enfileira uma cópia do pacote
+ *
+ * Com a fila cheia o pacote substitui o mais novo de prioridade
+ * estritamente menor; se não houver, é recusado. Com a cifra habilitada
+ * o pacote já vem cifrado de ppkg*: sai como está e não é agregado
+ * (ver cosmic_sched_ppkg).
+ *
+ * @param s Escalonador
+ * @param pkg Pacote de ppkg* (copiado; _c_buffer pode ser reutilizado em seguida)
+ * @return 1 se enfileirado, 0 se recusado
+ */
+int cosmic_sched_push(CosmicScheduler* s, const CosmicPacket* pkg) {
+    return _sched_enqueue(s, pkg, s->nid, !_encryption_enabled);
+}
+
+/**
+ * @brief cosmic_sched_ppkg - ppkg direto para a fila, cifrado só em cosmic_sched_poll
+ *
+ * O pacote fica em claro na fila: a telemetria pode ser agregada com o
+ * canal ocupado mesmo com a cifra habilitada, e o contador da cifra segue
+ * a ordem de transmissão.
+ *
+ * @return 1 se enfileirado, 0 se recusado
+ */
+int cosmic_sched_ppkg(CosmicScheduler* s, bool compress, uint8_t nid, uint16_t did,
+                      uint8_t type, uint8_t mod, float* pack, int n) {
+    _cipher_dry_run = true;
+    CosmicPacket pkg = ppkg(compress, nid, did, type, mod, pack, n);
+    _cipher_dry_run = false;
+    return _sched_enqueue(s, &pkg, nid, true);
+}
+
+/**
+ * @brief cosmic_sched_poll - Entrega o próximo quadro a transmitir, se permitido agora
+ *
+ * Com o canal ocupado (CAD/LBT) nada é transmitido e a telemetria em claro
+ * da fila é agrupada em um quadro agregado, gastando um preâmbulo só quando
+ * o canal liberar. O quadro entregue em claro é cifrado aqui.
+ *
+ * @param s Escalonador
+ * @param now_ms Instante atual
+ * @param channel_busy true se o canal está ocupado
+ * @param out Quadro a transmitir (aponta para a fila; válido até o próximo poll)
+ * @return 1 se há quadro em out, 0 caso contrário
+ */
+int cosmic_sched_poll(CosmicScheduler* s, uint32_t now_ms, bool channel_busy, CosmicPacket* out) {
+    _sched_refill(s, now_ms);
+    s->sent_slot = 0xFF;
+
+    if (channel_busy) {
+        _sched_coalesce(s);
+        return 0;
+    }
+
+    int head = _sched_head(s);
+    if (head < 0) return 0;
+
+    CosmicTxSlot* slot = &s->slots[head];
+    if (s->duty_permille) {
+        // Tamanho antes da cifra: igual, ou maior se o cabeçalho virar compacto
+        uint32_t airtime = lora_time_on_air_us(&s->radio, slot->size);
+        if (airtime > s->tokens_us) return 0;
+        s->tokens_us -= airtime;
+    }
+    if (!_sched_encrypt(slot)) {
+        slot->size = 0;
+        return 0;
+    }
+
+    out->data = slot->data;
+    out->size = slot->size;
+    out->type = slot->type;
+    out->mode = slot->mode;
+    slot->size = 0;                        // Livre, mas preservado até o próximo poll
+    s->sent_slot = head;
+    return 1;
+}
+
+/**
+ * @brief Tempo até o próximo quadro da fila poder sair pelo duty cycle
+ * @return ms a esperar (0 se pode transmitir já ou se a fila está vazia)
+ */
+uint32_t cosmic_sched_wait_ms(CosmicScheduler* s, uint32_t now_ms) {
+    _sched_refill(s, now_ms);
+    int head = _sched_head(s);
+    if (head < 0 || s->duty_permille == 0) return 0;
+
+    uint32_t airtime = lora_time_on_air_us(&s->radio, s->slots[head].size);
+    if (airtime <= s->tokens_us) return 0;
+    return (airtime - s->tokens_us + s->duty_permille - 1) / s->duty_permille;
+}
+
+/**
+ * @brief Número de pacotes na fila
+ */
+uint8_t cosmic_sched_pending(const CosmicScheduler* s) {
+    uint8_t n = 0;
+    for (int i = 0; i < COSMIC_TXQ_SLOTS; i++) {
+        if (s->slots[i].size) n++;
+    }
+    return n;
+}
+
+#endif // COSMIC_SCHEDULER_H
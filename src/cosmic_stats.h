@@ -0,0 +1,82 @@
+#ifndef COSMIC_STATS_H
+#define COSMIC_STATS_H
+
+#include <stdint.h>
+#include "cosmic_config.h"
+
+// =================================================================================
+// INSTRUMENTAÇÃO (opcional)
+// =================================================================================
+//
+// Com -DCOSMIC_STATS a biblioteca conta pacotes, bytes, fallbacks e erros e
+// mede o tempo de cada estágio (quantização, LZ, entropia, imagem, cifra).
+// Sem a flag todas as macros viram nada e não há RAM nem ciclos extras.
+//
+// O relógio padrão é micros(); para contar ciclos de CPU defina
+// COSMIC_CYCLES() antes de incluir a biblioteca, por exemplo
+// ESP.getCycleCount() no ESP32 ou DWT->CYCCNT no Cortex-M3/M4.
+// Exportação: cosmic_status.h (pacote STATUS e texto Prometheus).
+//
+// Os contadores seguem COSMIC_THREAD_LOCAL como os buffers de trabalho: no
+// gateway com vários threads cada um conta os próprios pacotes, e
+// cosmic_stats_snapshot/cosmic_stats_reset agem sobre o thread chamador.
+
+#define COSMIC_STAGE_QUANT   0
+#define COSMIC_STAGE_LZ      1
+#define COSMIC_STAGE_ENTROPY 2
+#define COSMIC_STAGE_IMAGE   3
+#define COSMIC_STAGE_CIPHER  4
+#define COSMIC_STAGE_COUNT   5
+
+struct CosmicStageStats {
+    uint32_t calls;
+    uint32_t ticks;                        // Soma (unidade de COSMIC_CYCLES)
+    uint32_t max_ticks;
+};
+
+struct CosmicStats {
+    uint32_t packets_tx;
+    uint32_t packets_rx;
+    uint32_t bytes_in;                     // Entrada dos codificadores (floats, inteiros, pixels)
+    uint32_t bytes_out;                    // Pacotes gerados (cabeçalho + payload)
+    uint32_t fallbacks;                    // LZ/Huffman sem ganho -> modo cru
+    uint32_t decode_errors;
+    uint32_t mode_count[16];               // Pacotes gerados por COMPRESS_*
+    CosmicStageStats stage[COSMIC_STAGE_COUNT];
+};
+
+#ifdef COSMIC_STATS
+
+#ifndef COSMIC_CYCLES
+#define COSMIC_CYCLES() ((uint32_t)micros())
+#endif
+
+static COSMIC_THREAD_LOCAL CosmicStats _cosmic_stats;
+
+static inline void _cosmic_stage_add(uint8_t stage, uint32_t ticks) {
+    CosmicStageStats* s = &_cosmic_stats.stage[stage];
+    s->calls++;
+    s->ticks += ticks;
+    if (ticks > s->max_ticks) s->max_ticks = ticks;
+}
+
+#define COSMIC_STAT_INC(field)        (_cosmic_stats.field++)
+#define COSMIC_STAT_ADD(field, v)     (_cosmic_stats.field += (v))
+#define COSMIC_TIMER_START(t)         uint32_t t = COSMIC_CYCLES()
+#define COSMIC_TIMER_STOP(stage, t)   _cosmic_stage_add((stage), COSMIC_CYCLES() - (t))
+// Montagens de teste (ppkg_auto): guarda e restaura os contadores em volta
+#define COSMIC_STATS_SAVE(s)          CosmicStats s = _cosmic_stats
+#define COSMIC_STATS_RESTORE(s)       (_cosmic_stats = (s))
+
+#else
+
+#define COSMIC_STAT_INC(field)        ((void)0)
+#define COSMIC_STAT_ADD(field, v)     ((void)0)
+#define COSMIC_TIMER_START(t)         ((void)0)
+#define COSMIC_TIMER_STOP(stage, t)   ((void)0)
+#define COSMIC_STATS_SAVE(s)          ((void)0)
+#define COSMIC_STATS_RESTORE(s)       ((void)0)
+
+#endif // COSMIC_STATS
+
+#endif // COSMIC_STATS_H
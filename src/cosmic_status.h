@@ -0,0 +1,243 @@
+#ifndef COSMIC_STATUS_H
+#define COSMIC_STATUS_H
+
+#include <stdio.h>
+#include "cosmic_payload.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+//
+// Exportação dos contadores de cosmic_stats.h:
+//   nó      -> ppkg_status(): pacote PKG_TYPE_STATUS compacto (varints)
+//   gateway -> uppkg_status() + cosmic_stats_prometheus(): texto no formato
+//              de exposição do Prometheus, um bloco por dispositivo
+//
+// Payload de PKG_TYPE_STATUS (COMPRESS_NONE), logo após o cabeçalho:
+//   [0] versão (COSMIC_STATUS_VERSION)
+//   varints: uptime_s, packets_tx, packets_rx, bytes_in, bytes_out,
+//            fallbacks, decode_errors,
+//            por estágio (COSMIC_STAGE_*): calls, ticks, max_ticks,
+//            máscara de modos usados, contagem de cada modo da máscara
+// Todos os contadores são acumulados desde o boot (ou cosmic_stats_reset);
+// o gateway calcula taxas pela diferença entre dois relatórios. Se o MTU
+// não comporta tudo, o pacote termina no último campo que coube e os
+// campos ausentes são lidos como zero.
+
+#define COSMIC_STATUS_VERSION 1
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+/**
+ * @brief Relatório de status de um dispositivo
+ */
+struct CosmicStatusReport {
+    uint16_t dev_id;
+    uint32_t uptime_s;
+    CosmicStats stats;
+};
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+static const char* const _cosmic_stage_names[COSMIC_STAGE_COUNT] = {
+    "quant", "lz", "entropy", "image", "cipher"
+};
+
+/**
+ * @brief Sequência de campos do payload (mesma ordem na escrita e na leitura)
+ * @return Número de ponteiros escritos em fields
+ */
+static int _status_fields(CosmicStatusReport* report, uint32_t** fields) {
+    CosmicStats* s = &report->stats;
+    int n = 0;
+    fields[n++] = &report->uptime_s;
+    fields[n++] = &s->packets_tx;
+    fields[n++] = &s->packets_rx;
+    fields[n++] = &s->bytes_in;
+    fields[n++] = &s->bytes_out;
+    fields[n++] = &s->fallbacks;
+    fields[n++] = &s->decode_errors;
+    for (int i = 0; i < COSMIC_STAGE_COUNT; i++) {
+        fields[n++] = &s->stage[i].calls;
+        fields[n++] = &s->stage[i].ticks;
+        fields[n++] = &s->stage[i].max_ticks;
+    }
+    return n;
+}
+
+#define COSMIC_STATUS_FIELDS (7 + 3 * COSMIC_STAGE_COUNT)
+
+// =================================================================================
+// API PÚBLICA
+// =================================================================================
+
+/**
+ * @brief Zera os contadores (sem efeito se compilado sem COSMIC_STATS)
+ */
+void cosmic_stats_reset() {
+#ifdef COSMIC_STATS
+    memset(&_cosmic_stats, 0, sizeof(_cosmic_stats));
+#endif
+}
+
+/**
+ * @brief Copia os contadores atuais deste dispositivo
+ * @param report Relatório (saída; tudo zero, exceto uptime, sem COSMIC_STATS)
+ * @param dev_id Device ID a registrar no relatório
+ */
+void cosmic_stats_snapshot(CosmicStatusReport* report, uint16_t dev_id) {
+    memset(report, 0, sizeof(*report));
+    report->dev_id = dev_id;
+    report->uptime_s = millis() / 1000;
+#ifdef COSMIC_STATS
+    report->stats = _cosmic_stats;
+#endif
+}
+
+/**
+ * @brief ppkg_status - Empacota os contadores deste nó em um pacote STATUS
+ * @param nid Network ID
+ * @param did Device ID
+ * @return Pacote PKG_TYPE_STATUS (COMPRESS_NONE), cifrado como os demais
+ */
+CosmicPacket ppkg_status(uint8_t nid, uint16_t did) {
+    CosmicStatusReport report;
+    cosmic_stats_snapshot(&report, did);
+
+    uint8_t hlen = _prepare_header(nid, did, PKG_TYPE_STATUS, COMPRESS_NONE);
+    uint8_t* out = _c_buffer + hlen;
+    int room = COSMIC_MAX_PACKET - hlen;
+    int pos = 0;
+    out[pos++] = COSMIC_STATUS_VERSION;
+
+    uint32_t* fields[COSMIC_STATUS_FIELDS];
+    int count = _status_fields(&report, fields);
+
+    // Campos de trás ficam de fora se não couberem (varint ocupa até 5 bytes)
+    int i = 0;
+    for (; i < count && pos + 5 <= room; i++) {
+        pos += _put_varint(out + pos, *fields[i]);
+    }
+
+    if (i == count) {
+        uint16_t mask = 0;
+        for (uint8_t m = 0; m < 16; m++) {
+            if (report.stats.mode_count[m]) mask |= (uint16_t)1 << m;
+        }
+        if (pos + 3 <= room) {
+            pos += _put_varint(out + pos, mask);
+            for (uint8_t m = 0; m < 16 && pos + 5 <= room; m++) {
+                if (mask & ((uint16_t)1 << m)) pos += _put_varint(out + pos, report.stats.mode_count[m]);
+            }
+        }
+    }
+
+    return _finish_packet(nid, PKG_TYPE_STATUS, COMPRESS_NONE, hlen + pos);
+}
+
+/**
+ * @brief uppkg_status - Lê um pacote STATUS
+ * @param packet Pacote recebido (já descriptografado)
+ * @param packet_size Tamanho do pacote
+ * @param report Relatório (saída; campos ausentes ficam zero)
+ * @return 1 se sucesso, 0 se não é um pacote STATUS válido
+ */
+int uppkg_status(const uint8_t* packet, uint8_t packet_size, CosmicStatusReport* report) {
+    CosmicHeader hdr;
+    uint8_t hlen = cosmic_parse_header(packet, packet_size, &hdr);
+    if (hlen == 0 || hdr.type != PKG_TYPE_STATUS || hdr.mode != COMPRESS_NONE ||
+        packet_size < hlen + 1 || packet[hlen] != COSMIC_STATUS_VERSION) {
+        return 0;
+    }
+
+    memset(report, 0, sizeof(*report));
+    report->dev_id = hdr.dev_id;
+
+    const uint8_t* in = packet + hlen + 1;
+    int avail = packet_size - hlen - 1;
+    int pos = 0;
+
+    uint32_t* fields[COSMIC_STATUS_FIELDS];
+    int count = _status_fields(report, fields);
+    for (int i = 0; i < count && pos < avail; i++) {
+        int used = _get_varint(in + pos, avail - pos, fields[i]);
+        if (used == 0) return 0;
+        pos += used;
+    }
+
+    uint32_t mask;
+    if (pos < avail) {
+        int used = _get_varint(in + pos, avail - pos, &mask);
+        if (used == 0 || mask > 0xFFFF) return 0;
+        pos += used;
+        for (uint8_t m = 0; m < 16 && pos < avail; m++) {
+            if (!(mask & (1UL << m))) continue;
+            used = _get_varint(in + pos, avail - pos, &report->stats.mode_count[m]);
+            if (used == 0) return 0;
+            pos += used;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief cosmic_stats_prometheus - Formata um relatório no formato de exposição do Prometheus
+ *
+ * Gera só as amostras (sem linhas # TYPE), com o rótulo dev, para que os
+ * blocos de vários dispositivos possam ser concatenados na mesma resposta.
+ * Contadores terminam em _total; max_ticks e uptime são gauges.
+ *
+ * @param report Relatório (de uppkg_status ou cosmic_stats_snapshot)
+ * @param out Texto de saída (terminado em '\0')
+ * @param max Tamanho de out
+ * @return Bytes escritos (sem o '\0'), ou -1 se out é pequeno demais
+ */
+int cosmic_stats_prometheus(const CosmicStatusReport* report, char* out, int max) {
+    const CosmicStats* s = &report->stats;
+    unsigned dev = report->dev_id;
+    int pos = 0;
+    int n;
+
+#define _COSMIC_PROM(...)                                               \
+    do {                                                                \
+        n = snprintf(out + pos, max - pos, __VA_ARGS__);                \
+        if (n < 0 || n >= max - pos) return -1;                         \
+        pos += n;                                                       \
+    } while (0)
+
+    if (!out || max <= 0) return -1;
+    _COSMIC_PROM("cosmic_uptime_seconds{dev=\"%u\"} %lu\n", dev, (unsigned long)report->uptime_s);
+    _COSMIC_PROM("cosmic_packets_tx_total{dev=\"%u\"} %lu\n", dev, (unsigned long)s->packets_tx);
+    _COSMIC_PROM("cosmic_packets_rx_total{dev=\"%u\"} %lu\n", dev, (unsigned long)s->packets_rx);
+    _COSMIC_PROM("cosmic_bytes_in_total{dev=\"%u\"} %lu\n", dev, (unsigned long)s->bytes_in);
+    _COSMIC_PROM("cosmic_bytes_out_total{dev=\"%u\"} %lu\n", dev, (unsigned long)s->bytes_out);
+    _COSMIC_PROM("cosmic_fallbacks_total{dev=\"%u\"} %lu\n", dev, (unsigned long)s->fallbacks);
+    _COSMIC_PROM("cosmic_decode_errors_total{dev=\"%u\"} %lu\n", dev, (unsigned long)s->decode_errors);
+
+    for (uint8_t m = 0; m < 16; m++) {
+        if (!s->mode_count[m]) continue;
+        _COSMIC_PROM("cosmic_packets_by_mode_total{dev=\"%u\",mode=\"%u\"} %lu\n",
+                     dev, (unsigned)m, (unsigned long)s->mode_count[m]);
+    }
+
+    for (uint8_t i = 0; i < COSMIC_STAGE_COUNT; i++) {
+        const CosmicStageStats* st = &s->stage[i];
+        if (!st->calls) continue;
+        const char* name = _cosmic_stage_names[i];
+        _COSMIC_PROM("cosmic_stage_calls_total{dev=\"%u\",stage=\"%s\"} %lu\n",
+                     dev, name, (unsigned long)st->calls);
+        _COSMIC_PROM("cosmic_stage_ticks_total{dev=\"%u\",stage=\"%s\"} %lu\n",
+                     dev, name, (unsigned long)st->ticks);
+        _COSMIC_PROM("cosmic_stage_max_ticks{dev=\"%u\",stage=\"%s\"} %lu\n",
+                     dev, name, (unsigned long)st->max_ticks);
+    }
+
+#undef _COSMIC_PROM
+    return pos;
+}
+
+#endif // COSMIC_STATUS_H
@@ -0,0 +1,258 @@
+#ifndef COSMIC_STREAM_H
+#define COSMIC_STREAM_H
+
+#include "cosmic_payload.h"
+
+// =================================================================================
+// CONFIGURAÇÕES
+// =================================================================================
+
+#define COSMIC_STREAM_MAX_CHANNELS   16    // Máx canais por quadro (limite do estado por dispositivo)
+#define COSMIC_STREAM_KEYFRAME_EVERY 32    // Intervalo padrão entre quadros-chave
+
+// Payload do modo COMPRESS_STREAM (logo após o cabeçalho):
+//   [0] bit7 = quadro-chave, bits 0-6 = número de canais
+//   [1] seq (número de sequência do quadro)
+//   Quadro-chave: n varints zigzag (delta intra-quadro, igual ao COSMIC)
+//   Quadro delta: [2] seq de referência | máscara de canais alterados | varints zigzag
+#define STREAM_FLAG_KEYFRAME  0x80
+#define STREAM_CHANNEL_MASK   0x7F
+
+// Códigos de retorno de uppkg_stream
+#define COSMIC_STREAM_NEED_KEYFRAME -2     // Referência ausente/diferente: pedir quadro-chave
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+/**
+ * @brief Estado de referência de um fluxo de telemetria
+ *
+ * A mesma estrutura é usada no nó (codificador) e no gateway (decodificador,
+ * uma instância por dispositivo). Com ack_mode habilitado a referência só
+ * avança quando cosmic_stream_ack() é chamado dos dois lados (até o primeiro
+ * ack todos os quadros saem como quadro-chave); caso contrário cada quadro
+ * enviado/recebido vira a referência do próximo.
+ */
+struct CosmicStreamCtx {
+    int16_t ref[COSMIC_STREAM_MAX_CHANNELS];     // Valores quantizados de referência
+    int16_t pend[COSMIC_STREAM_MAX_CHANNELS];    // Último quadro ainda não confirmado
+    uint8_t ref_n;                               // Canais na referência (0 = sem referência)
+    uint8_t pend_n;                              // Canais no quadro pendente
+    uint8_t ref_seq;                             // Seq da referência
+    uint8_t pend_seq;                            // Seq do quadro pendente
+    uint8_t seq;                                 // Próximo seq a enviar
+    uint8_t since_keyframe;                      // Quadros desde o último quadro-chave
+    uint8_t keyframe_every;                      // Intervalo entre quadros-chave
+    bool ack_mode;                               // Referência = último confirmado
+};
+
+// =================================================================================
+// API PÚBLICA
+// =================================================================================
+
+/**
+ * @brief Inicializa o estado do fluxo
+ * @param ctx Estado a inicializar
+ * @param keyframe_every Quadros entre quadros-chave (0 = COSMIC_STREAM_KEYFRAME_EVERY)
+ * @param ack_mode true para referenciar o último quadro confirmado
+ */
+void cosmic_stream_init(CosmicStreamCtx* ctx, uint8_t keyframe_every, bool ack_mode) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->keyframe_every = keyframe_every ? keyframe_every : COSMIC_STREAM_KEYFRAME_EVERY;
+    ctx->ack_mode = ack_mode;
+}
+
+/**
+ * @brief Força quadro-chave no próximo envio (ex: gateway pediu ressincronização)
+ */
+void cosmic_stream_force_keyframe(CosmicStreamCtx* ctx) {
+    ctx->ref_n = 0;
+}
+
+/**
+ * @brief Confirma um quadro, tornando-o a nova referência (apenas em ack_mode)
+ * @param ctx Estado do fluxo (nó ou gateway)
+ * @param seq Seq confirmado
+ * @return 1 se a referência avançou, 0 se seq não corresponde ao quadro pendente
+ */
+int cosmic_stream_ack(CosmicStreamCtx* ctx, uint8_t seq) {
+    if (!ctx->ack_mode || seq != ctx->pend_seq) return 0;
+    memcpy(ctx->ref, ctx->pend, sizeof(ctx->ref));
+    ctx->ref_n = ctx->pend_n;
+    ctx->ref_seq = seq;
+    return 1;
+}
+
+/**
+ * @brief Codifica um quadro já quantizado contra a referência do fluxo
+ */
+static CosmicPacket _stream_encode(CosmicStreamCtx* ctx, uint8_t nid, uint16_t did, const int16_t* q, int n) {
+    uint8_t hlen = _prepare_header(nid, did, PKG_TYPE_TELEMETRY, COMPRESS_STREAM);
+
+    bool keyframe = (ctx->ref_n != n) || (ctx->since_keyframe >= ctx->keyframe_every);
+    uint8_t* out = _c_buffer + hlen;
+    int pos = 0;
+
+    out[pos++] = (keyframe ? STREAM_FLAG_KEYFRAME : 0) | (uint8_t)n;
+    out[pos++] = ctx->seq;
+
+    if (keyframe) {
+        int16_t prev = 0;
+        for (int i = 0; i < n; i++) {
+            pos += _put_varint(out + pos, _zigzag_encode((int32_t)q[i] - prev));
+            prev = q[i];
+        }
+        ctx->since_keyframe = 0;
+    } else {
+        out[pos++] = ctx->ref_seq;
+
+        // Máscara de canais alterados seguida apenas dos resíduos não nulos
+        int mask_bytes = (n + 7) / 8;
+        uint8_t* mask = out + pos;
+        memset(mask, 0, mask_bytes);
+        pos += mask_bytes;
+
+        for (int i = 0; i < n; i++) {
+            int32_t r = (int32_t)q[i] - ctx->ref[i];
+            if (r != 0) {
+                mask[i >> 3] |= (uint8_t)(1 << (i & 7));
+                pos += _put_varint(out + pos, _zigzag_encode(r));
+            }
+        }
+        ctx->since_keyframe++;
+    }
+
+    // Atualiza referência: imediata, ou pendente até confirmação
+    memcpy(ctx->pend, q, n * sizeof(int16_t));
+    ctx->pend_n = n;
+    ctx->pend_seq = ctx->seq;
+    if (!ctx->ack_mode) {
+        memcpy(ctx->ref, q, n * sizeof(int16_t));
+        ctx->ref_n = n;
+        ctx->ref_seq = ctx->seq;
+    }
+    ctx->seq++;
+
+    return _finish_packet(nid, PKG_TYPE_TELEMETRY, COMPRESS_STREAM, hlen + pos);
+}
+
+/**
+ * @brief ppkg_stream - Empacota telemetria com delta temporal contra a referência
+ * @param ctx Estado do fluxo do nó
+ * @param nid Network ID
+ * @param did Device ID
+ * @param pack Array de floats
+ * @param n Número de floats (máx COSMIC_STREAM_MAX_CHANNELS)
+ * @return Pacote pronto para transmissão (modo COMPRESS_STREAM)
+ */
+CosmicPacket ppkg_stream(CosmicStreamCtx* ctx, uint8_t nid, uint16_t did, float* pack, int n) {
+    if (n > COSMIC_STREAM_MAX_CHANNELS) n = COSMIC_STREAM_MAX_CHANNELS;
+    if (n < 0) n = 0;
+
+    int16_t q[COSMIC_STREAM_MAX_CHANNELS];
+    for (int i = 0; i < n; i++) {
+        q[i] = _quantize(pack[i]);
+    }
+    return _stream_encode(ctx, nid, did, q, n);
+}
+
+/**
+ * @brief ppkg_stream_i16 - Versão inteira de ppkg_stream para contagens de ADC
+ * @param ctx Estado do fluxo do nó
+ * @param nid Network ID
+ * @param did Device ID
+ * @param raw Contagens cruas
+ * @param n Número de contagens (máx COSMIC_STREAM_MAX_CHANNELS)
+ * @param mul Multiplicador Q(shift) para centésimos (usar COSMIC_FIXED_MUL)
+ * @param shift Bits fracionários de mul
+ * @return Pacote pronto para transmissão (modo COMPRESS_STREAM)
+ */
+CosmicPacket ppkg_stream_i16(CosmicStreamCtx* ctx, uint8_t nid, uint16_t did, const int16_t* raw, int n,
+                             int32_t mul, uint8_t shift) {
+    if (n > COSMIC_STREAM_MAX_CHANNELS) n = COSMIC_STREAM_MAX_CHANNELS;
+    if (n < 0) n = 0;
+
+    int16_t q[COSMIC_STREAM_MAX_CHANNELS];
+    for (int i = 0; i < n; i++) {
+        q[i] = _quantize_fixed16(raw[i], mul, shift);
+    }
+    return _stream_encode(ctx, nid, did, q, n);
+}
+
+/**
+ * @brief uppkg_stream - Reconstrói telemetria a partir do estado do dispositivo
+ * @param ctx Estado do fluxo mantido pelo gateway para este dispositivo
+ * @param packet Pacote recebido (já descriptografado se necessário)
+ * @param packet_size Tamanho do pacote
+ * @param output Buffer para floats desempacotados
+ * @param max_output Número máximo de floats no buffer
+ * @return Número de floats, -1 em caso de erro, ou COSMIC_STREAM_NEED_KEYFRAME
+ */
+int uppkg_stream(CosmicStreamCtx* ctx, const uint8_t* packet, uint8_t packet_size,
+                 float* output, int max_output) {
+    CosmicHeader hdr;
+    uint8_t hlen = cosmic_parse_header(packet, packet_size, &hdr);
+    if (hlen == 0 || packet_size < hlen + 2) return -1;
+    if (hdr.type != PKG_TYPE_TELEMETRY || hdr.mode != COMPRESS_STREAM) return -1;
+
+    const uint8_t* in = packet + hlen;
+    int avail = packet_size - hlen;
+    int pos = 0;
+
+    bool keyframe = (in[pos] & STREAM_FLAG_KEYFRAME) != 0;
+    int n = in[pos++] & STREAM_CHANNEL_MASK;
+    uint8_t seq = in[pos++];
+    if (n > COSMIC_STREAM_MAX_CHANNELS) return -1;
+
+    int16_t q[COSMIC_STREAM_MAX_CHANNELS];
+    uint32_t v;
+
+    if (keyframe) {
+        int16_t prev = 0;
+        for (int i = 0; i < n; i++) {
+            int used = _get_varint(in + pos, avail - pos, &v);
+            if (!used) return -1;
+            pos += used;
+            q[i] = (int16_t)(prev + _zigzag_decode(v));
+            prev = q[i];
+        }
+    } else {
+        if (pos >= avail) return -1;
+        uint8_t base_seq = in[pos++];
+        if (ctx->ref_n != n || base_seq != ctx->ref_seq) return COSMIC_STREAM_NEED_KEYFRAME;
+
+        int mask_bytes = (n + 7) / 8;
+        if (pos + mask_bytes > avail) return -1;
+        const uint8_t* mask = in + pos;
+        pos += mask_bytes;
+
+        for (int i = 0; i < n; i++) {
+            q[i] = ctx->ref[i];
+            if (mask[i >> 3] & (1 << (i & 7))) {
+                int used = _get_varint(in + pos, avail - pos, &v);
+                if (!used) return -1;
+                pos += used;
+                q[i] = (int16_t)(q[i] + _zigzag_decode(v));
+            }
+        }
+    }
+
+    // Mesma regra de referência do codificador
+    memcpy(ctx->pend, q, n * sizeof(int16_t));
+    ctx->pend_n = n;
+    ctx->pend_seq = seq;
+    if (!ctx->ack_mode) {
+        memcpy(ctx->ref, q, n * sizeof(int16_t));
+        ctx->ref_n = n;
+        ctx->ref_seq = seq;
+    }
+
+    int out_n = n < max_output ? n : max_output;
+    for (int i = 0; i < out_n; i++) {
+        output[i] = q[i] / (float)COSMIC_QUANT_SCALE;
+    }
+    return out_n;
+}
+
+#endif // COSMIC_STREAM_H
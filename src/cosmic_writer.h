@@ -0,0 +1,137 @@
+#ifndef COSMIC_WRITER_H
+#define COSMIC_WRITER_H
+
+#include "cosmic_payload.h"
+
+// =================================================================================
+// ESCRITA INCREMENTAL DE TELEMETRIA
+// =================================================================================
+//
+// CosmicStreamWriter monta um pacote COMPRESS_COSMIC_VARINT leitura a
+// leitura: cada valor é quantizado, vira delta do anterior e é anexado como
+// varint zigzag. O tamanho final é conhecido exatamente a cada passo, então
+// o nó sabe antes de amostrar se a próxima leitura ainda cabe no MTU e
+// nada é recomprimido no envio. Decodifica com uppkg().
+//
+// O tamanho do cabeçalho é calculado em cosmic_writer_init(); mudanças em
+// setCosmicHeaderFormat/setCosmicRelayTtl valem a partir do próximo init.
+
+// =================================================================================
+// ESTRUTURAS DE DADOS
+// =================================================================================
+
+struct CosmicStreamWriter {
+    uint8_t data[MAX_COSMIC_BUFFER];       // Payload em construção
+    uint8_t size;                          // Bytes usados em data
+    uint8_t capacity;                      // MTU - cabeçalho
+    uint8_t count;                         // Leituras no pacote
+    int16_t prev;                          // Último valor quantizado (referência do delta)
+    uint8_t nid;
+    uint16_t did;
+    uint8_t type;
+};
+
+// =================================================================================
+// FUNÇÕES INTERNAS
+// =================================================================================
+
+/**
+ * @brief Bytes do varint zigzag para o delta entre q e a referência
+ */
+static inline uint8_t _writer_residual_size(const CosmicStreamWriter* w, int16_t q, uint32_t* zz) {
+    *zz = _zigzag_encode((int16_t)(q - w->prev));
+    return *zz < 0x80 ? 1 : (*zz < 0x4000 ? 2 : 3);
+}
+
+// =================================================================================
+// API PÚBLICA
+// =================================================================================
+
+/**
+ * @brief Inicializa o escritor para um dispositivo
+ * @param w Escritor
+ * @param nid Network ID
+ * @param did Device ID
+ * @param type Tipo do pacote (normalmente PKG_TYPE_TELEMETRY)
+ * @param mtu Tamanho máximo do pacote no ar (0 ou acima de COSMIC_MAX_PACKET = COSMIC_MAX_PACKET)
+ */
+void cosmic_writer_init(CosmicStreamWriter* w, uint8_t nid, uint16_t did, uint8_t type, uint8_t mtu) {
+    int limit = (mtu && mtu < COSMIC_MAX_PACKET) ? mtu : COSMIC_MAX_PACKET;
+    limit -= _header_length(did);
+    if (limit > COSMIC_MAX_PACKET - HEADER_MAX_SIZE) limit = COSMIC_MAX_PACKET - HEADER_MAX_SIZE;
+
+    w->size = 0;
+    w->count = 0;
+    w->prev = 0;
+    w->capacity = limit > 0 ? (uint8_t)limit : 0;
+    w->nid = nid;
+    w->did = did;
+    w->type = type;
+}
+
+/**
+ * @brief Indica se um valor já quantizado (centésimos) ainda cabe no pacote
+ */
+bool cosmic_writer_fits_q(const CosmicStreamWriter* w, int16_t q) {
+    uint32_t zz;
+    return w->count < 255 && w->size + _writer_residual_size(w, q, &zz) <= w->capacity;
+}
+
+/**
+ * @brief Indica se a leitura ainda cabe no pacote (transmitir antes se não couber)
+ */
+bool cosmic_writer_fits(const CosmicStreamWriter* w, float value) {
+    return cosmic_writer_fits_q(w, _quantize(value));
+}
+
+/**
+ * @brief cosmic_writer_add_q - Anexa valor já quantizado (centésimos), O(1)
+ * @return 1 se anexado, 0 se o pacote está cheio
+ */
+int cosmic_writer_add_q(CosmicStreamWriter* w, int16_t q) {
+    uint32_t zz;
+    uint8_t len = _writer_residual_size(w, q, &zz);
+    if (w->count == 255 || w->size + len > w->capacity) return 0;
+
+    _put_varint(w->data + w->size, zz);
+    w->size += len;
+    w->prev = q;
+    w->count++;
+    return 1;
+}
+
+/**
+ * @brief cosmic_writer_add - Anexa uma leitura em ponto flutuante
+ * @return 1 se anexada, 0 se o pacote está cheio
+ */
+int cosmic_writer_add(CosmicStreamWriter* w, float value) {
+    return cosmic_writer_add_q(w, _quantize(value));
+}
+
+/**
+ * @brief cosmic_writer_add_fixed - Anexa contagem inteira (ADC etc.) sem ponto flutuante
+ * @param mul Multiplicador Q(shift) para centésimos (usar COSMIC_FIXED_MUL)
+ * @param shift Bits fracionários de mul
+ * @return 1 se anexada, 0 se o pacote está cheio
+ */
+int cosmic_writer_add_fixed(CosmicStreamWriter* w, int32_t raw, int32_t mul, uint8_t shift) {
+    return cosmic_writer_add_q(w, _quantize_fixed32(raw, mul, shift));
+}
+
+/**
+ * @brief ppkg_writer - Fecha o pacote com as leituras acumuladas e reinicia o escritor
+ * @param w Escritor
+ * @return Pacote pronto para transmissão (só cabeçalho se não havia leituras)
+ */
+CosmicPacket ppkg_writer(CosmicStreamWriter* w) {
+    uint8_t hlen = _prepare_header(w->nid, w->did, w->type, COMPRESS_COSMIC_VARINT);
+    memcpy(_c_buffer + hlen, w->data, w->size);
+    int total = hlen + w->size;
+
+    w->size = 0;
+    w->count = 0;
+    w->prev = 0;
+    return _finish_packet(w->nid, w->type, COMPRESS_COSMIC_VARINT, total);
+}
+
+#endif // COSMIC_WRITER_H
@@ -1,4 +1,7 @@
 #include "fastlz.h"
+#include "cosmic_config.h"
+
+#include <string.h>
 
 #define FASTLZ_SAFE_DECOMPRESS
 
@@ -42,164 +45,177 @@ static FASTLZ_INLINE flz_uint32 FASTLZ_READU32(const void* p) {
 }
 #endif
 
-#define HASH_LOG  13
+#define HASH_LOG  COSMIC_LZ_HASH_LOG   /* Definido pelo perfil de memória */
 #define HASH_SIZE (1 << HASH_LOG)
 #define HASH_MASK (HASH_SIZE - 1)
-#define HASH_FUNC(v, p)    (((v) * 2654435761UL) >> (32 - HASH_LOG))
+#define HASH_FUNC(v, p)    ((flz_uint32)((v) * 2654435761U) >> (32 - HASH_LOG))
 
 static flz_uint32 fastlz_hash(flz_uint32 v) {
   return HASH_FUNC(v, 0);
 }
 
 #define FASTLZ_VERSION1    0x00
-#define FLZ_LITERAL    0x00
-#define FLZ_COPY1    0x01
-#define FLZ_COPY2    0x00
-#define FLZ_FLAG_MASK    0x01
-#define FLZ_LEN_MASK    0x07
+#define FLZ_MIN_MATCH    4
 #define FLZ_LEN_SHIFT    5
 #define FLZ_OFFSET_MASK    0x1F
-#define FLZ_OFFSET_SHIFT  0x00
-#define FLZ1_MAX_LEN    (MAX_LEN - 2)
+#define FLZ1_MAX_LEN    MAX_LEN
 #define FLZ1_MAX_DISTANCE  MAX_DISTANCE
-#define FLZ1_MAX_REF    (FLZ1_MAX_DISTANCE - 1)
-#define FLZ1_GET_LEN(p)    ((*(p) >> FLZ_LEN_SHIFT) + 1)
-#define FLZ1_GET_OFFSET(p)  (((*(p) & FLZ_OFFSET_MASK) << 8) | (*((p) + 1)) + 1)
-#define FLZ1_SET_LITERAL(p, c)  (*(p) = (c))
-#define FLZ1_SET_COPY(p, o, l)  (*(p) = (flz_uint8)(((l)-1) << FLZ_LEN_SHIFT) | (FLZ_COPY1 << 4) | (((o)-1) >> 8), \
-                *((p)+1) = (flz_uint8)(((o)-1) & 0xff))
 
+/*
+  Formato (nível 1):
+    ctrl < 32  -> ctrl+1 literais em seguida
+    ctrl >= 32 -> cópia: len = ctrl >> 5 (7 = lê byte extra), comprimento = len + 2,
+                  distância = ((ctrl & 0x1F) << 8 | próximo byte) + 1
+*/
+
+/* Posições relativas ao início da entrada: metade da RAM de ponteiros em 32 bits */
+static flz_uint16 htab[HASH_SIZE];
+
+static FASTLZ_INLINE flz_uint8* flz_literals(const flz_uint8* anchor, flz_uint32 runs, flz_uint8* op) {
+  while (runs >= MAX_COPY) {
+    *op++ = MAX_COPY - 1;
+    memcpy(op, anchor, MAX_COPY);
+    op += MAX_COPY;
+    anchor += MAX_COPY;
+    runs -= MAX_COPY;
+  }
+  if (runs > 0) {
+    *op++ = (flz_uint8)(runs - 1);
+    memcpy(op, anchor, runs);
+    op += runs;
+  }
+  return op;
+}
 
-static const flz_uint8* htab[HASH_SIZE];
+static FASTLZ_INLINE flz_uint8* flz_match(flz_uint32 len, flz_uint32 distance, flz_uint8* op) {
+  flz_uint32 code = len - 2;
+  flz_uint32 ofs = distance - 1;
+  if (code < 7) {
+    *op++ = (flz_uint8)((code << FLZ_LEN_SHIFT) + (ofs >> 8));
+  } else {
+    *op++ = (flz_uint8)((7 << FLZ_LEN_SHIFT) + (ofs >> 8));
+    *op++ = (flz_uint8)(code - 7);
+  }
+  *op++ = (flz_uint8)(ofs & 0xff);
+  return op;
+}
 
-int fastlz_compress(const void* input, int length, void* output) {
-  const flz_uint8* ip = (const flz_uint8*)input;
-  const flz_uint8* ip_bound = ip + length - 2;
-  const flz_uint8* ip_limit = ip + length - 12;
+static int fastlz1_compress(const void* input, int prefix, int length, void* output) {
+  const flz_uint8* ip_start = (const flz_uint8*)input;
+  const flz_uint8* ip = ip_start + prefix;
+  const flz_uint8* ip_end = ip_start + length;
+  const flz_uint8* ip_limit = ip_end - FLZ_MIN_MATCH;
+  const flz_uint8* anchor = ip;
   flz_uint8* op = (flz_uint8*)output;
+  flz_uint16* hslot;
+
+  memset(htab, 0, sizeof(htab));
 
-  //const flz_uint8* htab[HASH_SIZE];
-  const flz_uint8** hslot;
-  flz_uint32 hval;
-  flz_uint32 copy;
-  
-  for (hslot = htab; hslot < htab + HASH_SIZE; hslot++) {
-    *hslot = ip;
+  /* Dicionário: posições do prefixo entram na tabela antes dos dados */
+  if (prefix >= FLZ_MIN_MATCH) {
+    const flz_uint8* p = ip_start;
+    for (; p <= ip - FLZ_MIN_MATCH; p++) {
+      htab[fastlz_hash(FASTLZ_READU32(p))] = (flz_uint16)(p - ip_start);
+    }
   }
-  
-  op[0] = FASTLZ_VERSION1;
-  op++;
-  
-  hval = fastlz_hash(FASTLZ_READU32(ip));
-  hslot = htab + hval;
-  *hslot = ip;
-  ip += 2;
-  hval = fastlz_hash(FASTLZ_READU32(ip));
-  hslot = htab + hval;
-  *hslot = ip;
-  ip++;
 
-  while (FASTLZ_EXPECT_CONDITIONAL_A(ip < ip_limit, 1)) {
+  *op++ = FASTLZ_VERSION1;
+
+  while (FASTLZ_EXPECT_CONDITIONAL_A(ip <= ip_limit, 1)) {
+    flz_uint32 seq = FASTLZ_READU32(ip);
     const flz_uint8* ref;
     flz_uint32 distance;
-    
-    hval = fastlz_hash(FASTLZ_READU32(ip));
-    hslot = htab + hval;
-    ref = *hslot;
-    *hslot = ip;
-    
-    distance = ip - ref;
-    
-    if (distance > 0 && distance <= FLZ1_MAX_REF && FASTLZ_READU32(ref) == FASTLZ_READU32(ip)) {
-      flz_uint32 len = 2;
-      const flz_uint8* max_len = ip_bound;
-      
-      if (max_len > ip + FLZ1_MAX_LEN) {
-        max_len = ip + FLZ1_MAX_LEN;
-      }
-      
-      while (ip + len < max_len && ref[len] == ip[len]) {
-        len++;
-      }
-      
-      FLZ1_SET_COPY(op, distance, len);
-      op += 2;
-      ip += len;
-      
-      if (len > 2) {
-        flz_uint32 i = 1;
-        for (; i < len; ++i) {
-          hval = fastlz_hash(FASTLZ_READU32(ip - i));
-          hslot = htab + hval;
-          *hslot = ip - i;
-        }
-      }
+
+    hslot = htab + fastlz_hash(seq);
+    ref = ip_start + *hslot;
+    *hslot = (flz_uint16)(ip - ip_start);
+    distance = (flz_uint32)(ip - ref);
+
+    if (distance == 0 || distance > FLZ1_MAX_DISTANCE || FASTLZ_READU32(ref) != seq) {
+      ip++;
       continue;
     }
-    
-    FLZ1_SET_LITERAL(op, *ip);
-    op++;
-    ip++;
-  }
-  
-  while (ip < ip_bound + 2) {
-    FLZ1_SET_LITERAL(op, *ip);
-    op++;
-    ip++;
+
+    flz_uint32 len = FLZ_MIN_MATCH;
+    while (ip + len < ip_end && len < FLZ1_MAX_LEN && ref[len] == ip[len]) {
+      len++;
+    }
+
+    op = flz_literals(anchor, (flz_uint32)(ip - anchor), op);
+    op = flz_match(len, distance, op);
+    ip += len;
+    anchor = ip;
+
+    if (ip <= ip_limit) {
+      htab[fastlz_hash(FASTLZ_READU32(ip - 1))] = (flz_uint16)(ip - 1 - ip_start);
+    }
   }
 
+  op = flz_literals(anchor, (flz_uint32)(ip_end - anchor), op);
   return (int)(op - (flz_uint8*)output);
 }
 
-int fastlz_decompress(const void* input, int length, void* output, int maxout) {
+static int fastlz1_decompress(const void* input, int length, void* output, int prefix, int maxout) {
   const flz_uint8* ip = (const flz_uint8*)input;
   const flz_uint8* ip_limit = ip + length;
-  flz_uint8* op = (flz_uint8*)output;
+  flz_uint8* op_start = (flz_uint8*)output;
+  flz_uint8* op = op_start + prefix;
   flz_uint8* op_limit = op + maxout;
-  
-  if (*ip != FASTLZ_VERSION1) {
+
+  if (length < 1 || *ip != FASTLZ_VERSION1) {
     return 0;
   }
   ip++;
 
   while (FASTLZ_EXPECT_CONDITIONAL_B(ip < ip_limit, 1)) {
-    unsigned int ctrl = *ip;
-    
-    if (!(ctrl & FLZ_FLAG_MASK)) {
-      *op = ctrl;
-      op++;
-      ip++;
-      
-      if (FASTLZ_UNEXPECT_CONDITIONAL(op > op_limit)) {
+    flz_uint32 ctrl = *ip++;
+
+    if (ctrl < 32) {
+      flz_uint32 runs = ctrl + 1;
+      if (FASTLZ_UNEXPECT_CONDITIONAL(ip + runs > ip_limit || op + runs > op_limit)) {
         return 0;
       }
-      
+      memcpy(op, ip, runs);
+      op += runs;
+      ip += runs;
       continue;
     }
-    
-    flz_uint32 len = FLZ1_GET_LEN(&ctrl);
-    flz_uint32 offset = FLZ1_GET_OFFSET(&ctrl);
-    const flz_uint8* ref = op - offset;
-    
-    if (ref < (flz_uint8*)output) {
+
+    flz_uint32 len = ctrl >> FLZ_LEN_SHIFT;
+    if (len == 7) {
+      if (FASTLZ_UNEXPECT_CONDITIONAL(ip >= ip_limit)) {
+        return 0;
+      }
+      len += *ip++;
+    }
+    len += 2;
+
+    if (FASTLZ_UNEXPECT_CONDITIONAL(ip >= ip_limit)) {
       return 0;
     }
-    
-    ip += 2;
-    
-    if (FASTLZ_UNEXPECT_CONDITIONAL(op + len > op_limit)) {
+    flz_uint32 ofs = ((ctrl & FLZ_OFFSET_MASK) << 8) | *ip++;
+    const flz_uint8* ref = op - ofs - 1;
+
+    if (FASTLZ_UNEXPECT_CONDITIONAL(ref < op_start || op + len > op_limit)) {
       return 0;
     }
-    
+
+    /* Cópia byte a byte: a referência pode sobrepor a saída */
     flz_uint32 i = 0;
     for (; i < len; ++i) {
-      *op = *ref;
-      op++;
-      ref++;
+      *op++ = *ref++;
     }
   }
 
-  return (int)(op - (flz_uint8*)output);
+  return (int)(op - op_start - prefix);
+}
+
+int fastlz_compress(const void* input, int length, void* output) {
+  return fastlz1_compress(input, 0, length, output);
+}
+
+int fastlz_decompress(const void* input, int length, void* output, int maxout) {
+  return fastlz1_decompress(input, length, output, 0, maxout);
 }
 
 int fastlz_compress_level(int level, const void* input, int length, void* output) {
@@ -207,4 +223,12 @@ int fastlz_compress_level(int level, const void* input, int length, void* output
     /* Level 2 não está implementado, usa level 1 */
   }
   return fastlz_compress(input, length, output);
+}
+
+int fastlz_compress_prefix(const void* input, int prefix, int length, void* output) {
+  return fastlz1_compress(input, prefix, length, output);
+}
+
+int fastlz_decompress_prefix(const void* input, int length, void* output, int prefix, int maxout) {
+  return fastlz1_decompress(input, length, output, prefix, maxout);
 }
\ No newline at end of file
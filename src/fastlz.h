@@ -27,7 +27,8 @@ extern "C" {
   @return size of compressed data.
   
   If compression fails (e.g. input data is uncompressible or output buffer
-  is too small), the function will return 0.
+  is too small), the function will return 0. Input is limited to 65535
+  bytes (the hash table stores 16-bit positions).
 */
 FASTLZ_API int fastlz_compress(const void* input, int length, void* output);
 
@@ -54,6 +55,31 @@ FASTLZ_API int fastlz_decompress(const void* input, int length, void* output, in
 */
 FASTLZ_API int fastlz_compress_level(int level, const void* input, int length, void* output);
 
+/**
+  Compress a block of data using a preset dictionary (prefix).
+  @param input pointer to prefix bytes immediately followed by the data
+  @param prefix size of the dictionary prefix in bytes (not emitted)
+  @param length total size of prefix + data in bytes
+  @param output pointer to destination buffer
+  @return size of compressed data.
+
+  Matches may reference the prefix, so small blocks can be encoded as
+  back-references into the dictionary. The output buffer must hold at least
+  (length - prefix) * 33 / 32 + 1 bytes.
+*/
+FASTLZ_API int fastlz_compress_prefix(const void* input, int prefix, int length, void* output);
+
+/**
+  Decompress a block compressed with fastlz_compress_prefix.
+  @param input pointer to the block of data to decompress
+  @param length size of the block of data in bytes
+  @param output destination buffer; its first prefix bytes must hold the dictionary
+  @param prefix size of the dictionary prefix in bytes
+  @param maxout space available after the prefix
+  @return size of decompressed data (excluding the prefix), or 0 on error.
+*/
+FASTLZ_API int fastlz_decompress_prefix(const void* input, int length, void* output, int prefix, int maxout);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <string.h>
+#include "cosmic_arena.h"
 
 // =================================================================================
 // DEFINIÇÕES
@@ -17,6 +18,23 @@ typedef enum {
     IMG_COMPRESS_DICT = 4       // Compressão por dicionário (palette)
 } ImgCompressMode;
 
+// Caminho vetorial do BLOCK4 (SSE2 ou NEON AArch64); -DCOSMIC_IMG_SIMD=0 força o escalar
+#ifndef COSMIC_IMG_SIMD
+#if defined(__SSE2__) || (defined(__ARM_NEON) && defined(__aarch64__))
+#define COSMIC_IMG_SIMD 1
+#else
+#define COSMIC_IMG_SIMD 0
+#endif
+#endif
+
+#if COSMIC_IMG_SIMD && defined(__SSE2__)
+#include <emmintrin.h>
+#define _IMG_BLOCK4_SSE2
+#elif COSMIC_IMG_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define _IMG_BLOCK4_NEON
+#endif
+
 // Estrutura para imagem comprimida
 typedef struct {
     uint8_t* data;
@@ -30,9 +48,8 @@ typedef struct {
 // IMPLEMENTAÇÃO COMPLETA INLINE
 // =================================================================================
 
-// Buffers estáticos com nomes ÚNICOS para evitar conflitos
-static uint8_t _img_compress_buffer[1024];      // Buffer para imagem comprimida
-static uint8_t _img_temp_buffer[1024];          // Buffer temporário
+// Buffers de trabalho: _img_compress_buffer e _img_temp_buffer são regiões
+// da arena compartilhada (cosmic_arena.h), dimensionadas pelo perfil
 
 // ---------------------------------------------------------------------------------
 // Funções internas
@@ -86,95 +103,193 @@ static inline uint16_t _img_decompress_rle(const uint8_t* input, uint16_t length
 }
 
 /**
- * @brief Compressão por blocos 4x4 (versão simplificada)
+ * @brief BLOCK4 escalar: um bloco de bw x bh (até 4x4) numa única leitura
+ *
+ * Blocos com range <= 32 guardam média, range e um nível de 2 bits por
+ * pixel, floor(3 * (v - min) / range), calculado por comparação com
+ * limiares inteiros. É o mesmo valor de (uint8_t)((float)(v - min) / range * 3)
+ * para todo range <= 32, sem FPU nem divisão por pixel. Os demais guardam
+ * min, max e os cantos que existem.
+ *
+ * @return Bytes gravados em output
+ */
+static inline uint8_t _img_block4_scalar(const uint8_t* p, uint8_t width, uint8_t bw, uint8_t bh, uint8_t* output) {
+    uint8_t px[16];
+    uint8_t n = 0;
+    uint8_t min_val = 255;
+    uint8_t max_val = 0;
+    uint16_t sum = 0;
+
+    for (uint8_t dy = 0; dy < bh; dy++) {
+        const uint8_t* row = p + dy * width;
+        for (uint8_t dx = 0; dx < bw; dx++) {
+            uint8_t val = row[dx];
+            px[n++] = val;
+            sum += val;
+            if (val < min_val) min_val = val;
+            if (val > max_val) max_val = val;
+        }
+    }
+
+    uint8_t range = max_val - min_val;
+    if (range > 32) {
+        // Bloco complexo: min, max e cantos (direita/baixo só em bloco completo nesse eixo)
+        uint8_t k = 2;
+        output[0] = min_val;
+        output[1] = max_val;
+        output[k++] = px[0];
+        if (bw == 4) output[k++] = px[3];
+        if (bh == 4) output[k++] = px[3 * bw];
+        if (bw == 4 && bh == 4) output[k++] = px[15];
+        return k;
+    }
+
+    output[0] = (uint8_t)(sum / n);
+    output[1] = range;
+    uint8_t k = 2;
+    if (range == 0) {
+        for (uint8_t i = 0; i < n; i += 4) output[k++] = 0;
+        return k;
+    }
+    uint8_t t1 = range, t2 = 2 * range, t3 = 3 * range;   // <= 96
+    for (uint8_t i = 0; i < n; i += 4) {
+        uint8_t packed = 0;
+        for (uint8_t j = 0; j < 4 && i + j < n; j++) {
+            uint8_t t = (uint8_t)((px[i + j] - min_val) * 3);
+            packed |= ((t >= t1) + (t >= t2) + (t >= t3)) << (2 * j);
+        }
+        output[k++] = packed;
+    }
+    return k;
+}
+
+#if defined(_IMG_BLOCK4_SSE2)
+/**
+ * @brief BLOCK4 SSE2: bloco 4x4 completo num registrador (mesma saída do escalar)
+ */
+static inline uint8_t _img_block4_simd(const uint8_t* p, uint8_t width, uint8_t* output) {
+    uint8_t px[16];
+    for (uint8_t dy = 0; dy < 4; dy++) memcpy(px + 4 * dy, p + dy * width, 4);
+    __m128i v = _mm_loadu_si128((const __m128i*)px);
+
+    __m128i lo = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+    __m128i hi = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+    lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 4));
+    hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 4));
+    lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 2));
+    hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 2));
+    lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 1));
+    hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 1));
+    uint8_t min_val = (uint8_t)_mm_cvtsi128_si32(lo);
+    uint8_t max_val = (uint8_t)_mm_cvtsi128_si32(hi);
+    uint8_t range = max_val - min_val;
+
+    if (range > 32) {
+        output[0] = min_val;
+        output[1] = max_val;
+        output[2] = px[0];
+        output[3] = px[3];
+        output[4] = px[12];
+        output[5] = px[15];
+        return 6;
+    }
+
+    __m128i sad = _mm_sad_epu8(v, _mm_setzero_si128());
+    uint16_t sum = (uint16_t)(_mm_cvtsi128_si32(sad) + _mm_cvtsi128_si32(_mm_srli_si128(sad, 8)));
+    output[0] = (uint8_t)(sum >> 4);
+    output[1] = range;
+    if (range == 0) {
+        memset(output + 2, 0, 4);
+        return 6;
+    }
+
+    // Nível = quantos limiares (range, 2 range, 3 range) 3 * d alcança; cada máscara vale -1
+    __m128i d = _mm_subs_epu8(v, _mm_set1_epi8((char)min_val));
+    __m128i t = _mm_adds_epu8(_mm_adds_epu8(d, d), d);
+    __m128i level = _mm_setzero_si128();
+    for (uint8_t k = 1; k <= 3; k++) {
+        __m128i th = _mm_set1_epi8((char)(k * range));
+        level = _mm_sub_epi8(level, _mm_cmpeq_epi8(_mm_max_epu8(t, th), t));
+    }
+
+    // 4 níveis por linha, LSB primeiro: l0 | l1 << 2 | l2 << 4 | l3 << 6
+    level = _mm_and_si128(_mm_or_si128(level, _mm_srli_epi16(level, 6)), _mm_set1_epi32(0x000F000F));
+    level = _mm_and_si128(_mm_or_si128(level, _mm_srli_epi32(level, 12)), _mm_set1_epi32(0xFF));
+    level = _mm_packus_epi16(_mm_packs_epi32(level, level), level);
+    uint32_t packed = (uint32_t)_mm_cvtsi128_si32(level);
+    memcpy(output + 2, &packed, 4);
+    return 6;
+}
+#elif defined(_IMG_BLOCK4_NEON)
+/**
+ * @brief BLOCK4 NEON (AArch64): bloco 4x4 completo num registrador (mesma saída do escalar)
+ */
+static inline uint8_t _img_block4_simd(const uint8_t* p, uint8_t width, uint8_t* output) {
+    static const int8_t shifts[16] = { 0, 2, 4, 6, 0, 2, 4, 6, 0, 2, 4, 6, 0, 2, 4, 6 };
+    uint8_t px[16];
+    for (uint8_t dy = 0; dy < 4; dy++) memcpy(px + 4 * dy, p + dy * width, 4);
+    uint8x16_t v = vld1q_u8(px);
+
+    uint8_t min_val = vminvq_u8(v);
+    uint8_t max_val = vmaxvq_u8(v);
+    uint8_t range = max_val - min_val;
+
+    if (range > 32) {
+        output[0] = min_val;
+        output[1] = max_val;
+        output[2] = px[0];
+        output[3] = px[3];
+        output[4] = px[12];
+        output[5] = px[15];
+        return 6;
+    }
+
+    output[0] = (uint8_t)(vaddlvq_u8(v) >> 4);
+    output[1] = range;
+    if (range == 0) {
+        memset(output + 2, 0, 4);
+        return 6;
+    }
+
+    uint8x16_t d = vqsubq_u8(v, vdupq_n_u8(min_val));
+    uint8x16_t t = vaddq_u8(vaddq_u8(d, d), d);
+    uint8x16_t level = vdupq_n_u8(0);
+    for (uint8_t k = 1; k <= 3; k++) level = vsubq_u8(level, vcgeq_u8(t, vdupq_n_u8((uint8_t)(k * range))));
+
+    // Desloca cada nível para sua posição e soma os 4 de cada linha
+    level = vshlq_u8(level, vld1q_s8(shifts));
+    uint32x4_t rows = vpaddlq_u16(vpaddlq_u8(level));
+    uint8_t packed[8];
+    vst1_u8(packed, vmovn_u16(vcombine_u16(vmovn_u32(rows), vdup_n_u16(0))));
+    memcpy(output + 2, packed, 4);
+    return 6;
+}
+#endif
+
+/**
+ * @brief Compressão por blocos 4x4
+ *
+ * Blocos completos usam _img_block4_simd quando há SSE2/NEON e
+ * COSMIC_IMG_SIMD está ativo; blocos de borda (e tudo, sem SIMD) usam _img_block4_scalar.
  */
 static inline uint16_t _img_compress_block4(const uint8_t* pixels, uint8_t width, uint8_t height, uint8_t* output) {
     uint16_t out_idx = 0;
-    
-    // Cada bloco 4x4 = 16 pixels -> compactação simplificada
+
     for (uint8_t y = 0; y < height; y += 4) {
+        uint8_t bh = height - y < 4 ? height - y : 4;
         for (uint8_t x = 0; x < width; x += 4) {
-            uint8_t min_val = 255;
-            uint8_t max_val = 0;
-            uint16_t sum = 0;
-            uint8_t count = 0;
-            
-            // Encontra min, max e média do bloco
-            for (uint8_t dy = 0; dy < 4 && y + dy < height; dy++) {
-                for (uint8_t dx = 0; dx < 4 && x + dx < width; dx++) {
-                    uint8_t val = pixels[(y + dy) * width + (x + dx)];
-                    sum += val;
-                    count++;
-                    if (val < min_val) min_val = val;
-                    if (val > max_val) max_val = val;
-                }
-            }
-            
-            uint8_t avg = count > 0 ? sum / count : 0;
-            uint8_t range = max_val - min_val;
-            
-            // Se bloco uniforme (baixa variação)
-            if (range <= 32) {
-                // Armazena média e range
-                output[out_idx++] = avg;
-                output[out_idx++] = range;
-                
-                // Para cada pixel, armazena delta de 2 bits (4 níveis)
-                uint8_t delta_byte = 0;
-                uint8_t bit_pos = 0;
-                
-                for (uint8_t dy = 0; dy < 4 && y + dy < height; dy++) {
-                    for (uint8_t dx = 0; dx < 4 && x + dx < width; dx++) {
-                        uint8_t val = pixels[(y + dy) * width + (x + dx)];
-                        uint8_t delta_level = 0;
-                        
-                        if (range > 0) {
-                            float norm = (float)(val - min_val) / range;
-                            delta_level = (uint8_t)(norm * 3); // 0-3
-                        }
-                        
-                        if (bit_pos == 0) {
-                            delta_byte = delta_level;
-                            bit_pos = 2;
-                        } else if (bit_pos == 2) {
-                            delta_byte |= delta_level << 2;
-                            bit_pos = 4;
-                        } else if (bit_pos == 4) {
-                            delta_byte |= delta_level << 4;
-                            bit_pos = 6;
-                        } else {
-                            delta_byte |= delta_level << 6;
-                            output[out_idx++] = delta_byte;
-                            bit_pos = 0;
-                        }
-                    }
-                }
-                
-                // Se sobrou bits não escritos
-                if (bit_pos != 0) {
-                    output[out_idx++] = delta_byte;
-                }
-            } else {
-                // Bloco complexo - armazena 4 pixels representativos
-                output[out_idx++] = min_val;
-                output[out_idx++] = max_val;
-                
-                // Canto superior esquerdo
-                if (y < height && x < width) 
-                    output[out_idx++] = pixels[y * width + x];
-                // Canto superior direito
-                if (y < height && x + 3 < width) 
-                    output[out_idx++] = pixels[y * width + (x + 3)];
-                // Canto inferior esquerdo
-                if (y + 3 < height && x < width) 
-                    output[out_idx++] = pixels[(y + 3) * width + x];
-                // Canto inferior direito
-                if (y + 3 < height && x + 3 < width) 
-                    output[out_idx++] = pixels[(y + 3) * width + (x + 3)];
+            uint8_t bw = width - x < 4 ? width - x : 4;
+            const uint8_t* p = pixels + y * width + x;
+#if defined(_IMG_BLOCK4_SSE2) || defined(_IMG_BLOCK4_NEON)
+            if (bw == 4 && bh == 4) {
+                out_idx += _img_block4_simd(p, width, output + out_idx);
+                continue;
             }
+#endif
+            out_idx += _img_block4_scalar(p, width, bw, bh, output + out_idx);
         }
     }
-    
+
     return out_idx;
 }
 